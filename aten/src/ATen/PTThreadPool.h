@@ -2,6 +2,11 @@
 
 #include <ATen/Parallel.h>
 #include <c10/core/thread_pool.h>
+#include <c10/core/work_stealing_thread_pool.h>
+#include <c10/util/numa.h>
+
+#include <memory>
+#include <vector>
 
 namespace at {
 
@@ -10,10 +15,58 @@ public:
   explicit PTThreadPool(
       int pool_size,
       int numa_node_id = -1)
-    : c10::ThreadPool(pool_size, numa_node_id, [](){
+    : c10::ThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        c10::setThreadName("PTThreadPool");
+        c10::NUMABind(numa_node_id);
+        at::init_num_threads();
+      }) {}
+};
+
+class TORCH_API PTWorkStealingThreadPool : public c10::WorkStealingThreadPool {
+public:
+  explicit PTWorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1)
+    : c10::WorkStealingThreadPool(pool_size, numa_node_id, [numa_node_id](){
         c10::setThreadName("PTThreadPool");
+        c10::NUMABind(numa_node_id);
         at::init_num_threads();
       }) {}
 };
 
+// Intra-op pool of the NUMA-aware mode of the native backend: one pool per
+// NUMA node, with its threads bound to the node. The pools are
+// PTWorkStealingThreadPools if `work_stealing` is set and PTThreadPools
+// otherwise. Tasks submitted through run() go to the pool of the calling
+// thread's node.
+class TORCH_API PTNUMAThreadPool : public c10::TaskThreadPoolBase {
+public:
+  PTNUMAThreadPool(int pool_size, int num_nodes, bool work_stealing);
+
+  size_t size() const override;
+  size_t numAvailable() const override;
+  bool inThreadPool() const override;
+  void run(std::function<void()> func) override;
+
+  int num_nodes() const {
+    return pools_.size();
+  }
+
+  size_t node_size(int node) const {
+    return pools_[node]->size();
+  }
+
+  // Falls back to the largest pool if `node` has no threads
+  void run_on_node(int node, std::function<void()> func);
+
+private:
+  std::vector<std::unique_ptr<c10::TaskThreadPoolBase>> pools_;
+};
+
+namespace internal {
+// Whether TORCH_THREAD_POOL=work_stealing selects PTWorkStealingThreadPool
+// for the thread pools.
+TORCH_API bool use_work_stealing_pool();
+} // namespace internal
+
 } // namespace at
@@ -36,6 +36,28 @@ inline TORCH_API void lazy_init_num_threads() {
   }
 }
 
+// Tells the native backend in NUMA-aware mode (TORCH_NUMA_AWARE_PARALLEL=1)
+// that the parallel primitives called on this thread while the guard is alive
+// walk the memory [data, data + nbytes) linearly from begin to end, so that
+// each chunk can be run by a thread of the NUMA node owning its pages.
+// Has no effect otherwise.
+class TORCH_API NUMADataHintGuard {
+ public:
+  NUMADataHintGuard(const void* data, size_t nbytes);
+  ~NUMADataHintGuard();
+
+  NUMADataHintGuard(const NUMADataHintGuard&) = delete;
+  NUMADataHintGuard& operator=(const NUMADataHintGuard&) = delete;
+
+  // Hint of the innermost guard of the current thread, nullptr/0 if none
+  static const void* data();
+  static size_t nbytes();
+
+ private:
+  const void* prev_data_;
+  size_t prev_nbytes_;
+};
+
 }
 
 /*
@@ -40,8 +40,34 @@ size_t get_env_num_threads(const char* var_name, size_t def_value = 0) {
   return def_value;
 }
 
+thread_local const void* numa_hint_data = nullptr;
+thread_local size_t numa_hint_nbytes = 0;
+
 } // namespace
 
+namespace internal {
+
+NUMADataHintGuard::NUMADataHintGuard(const void* data, size_t nbytes)
+    : prev_data_(numa_hint_data), prev_nbytes_(numa_hint_nbytes) {
+  numa_hint_data = data;
+  numa_hint_nbytes = nbytes;
+}
+
+NUMADataHintGuard::~NUMADataHintGuard() {
+  numa_hint_data = prev_data_;
+  numa_hint_nbytes = prev_nbytes_;
+}
+
+const void* NUMADataHintGuard::data() {
+  return numa_hint_data;
+}
+
+size_t NUMADataHintGuard::nbytes() {
+  return numa_hint_nbytes;
+}
+
+} // namespace internal
+
 std::string get_parallel_info() {
   std::ostringstream ss;
 
@@ -70,6 +96,10 @@ std::string get_parallel_info() {
      << get_env_var("OMP_NUM_THREADS", "[not set]") << std::endl;
   ss << "\tMKL_NUM_THREADS : "
      << get_env_var("MKL_NUM_THREADS", "[not set]") << std::endl;
+  ss << "\tTORCH_THREAD_POOL : "
+     << get_env_var("TORCH_THREAD_POOL", "[not set]") << std::endl;
+  ss << "\tTORCH_NUMA_AWARE_PARALLEL : "
+     << get_env_var("TORCH_NUMA_AWARE_PARALLEL", "[not set]") << std::endl;
 
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
@@ -9,7 +9,12 @@
 #include <caffe2/utils/threadpool/pthreadpool-cpp.h>
 #endif // C10_MOBILE
 
+#include <c10/util/numa.h>
+
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <cstring>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -65,22 +70,101 @@ int _num_pool_threads(int nthreads) {
   return nthreads - 1;
 }
 
+// NUMA-aware mode, enabled with TORCH_NUMA_AWARE_PARALLEL=1 on hosts with
+// several NUMA nodes when NUMA support is enabled (--caffe2_cpu_numa_enabled).
+// The intra-op threads are split into one pool per node (see PTNUMAThreadPool)
+// and parallel_for runs each chunk on the node owning its data (see
+// internal::NUMADataHintGuard).
+bool _numa_aware() {
+  static const bool enabled = []() {
+    const char* value = std::getenv("TORCH_NUMA_AWARE_PARALLEL");
+    return value && std::strcmp(value, "1") == 0 && c10::IsNUMAEnabled() &&
+        c10::GetNumNUMANodes() > 1;
+  }();
+  return enabled;
+}
+
+// Below this size looking up the nodes of the pages costs more than the
+// remote accesses it saves
+constexpr size_t kNUMAAwareMinBytes = 1 << 20;
+
 TaskThreadPoolBase& _get_intraop_pool() {
   static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
+      []() -> std::shared_ptr<TaskThreadPoolBase> {
+    const int pool_size =
+        _num_pool_threads(num_intraop_threads.exchange(CONSUMED));
+    if (_numa_aware()) {
+      return std::make_shared<PTNUMAThreadPool>(
+          pool_size,
+          c10::GetNumNUMANodes(),
+          internal::use_work_stealing_pool());
+    }
+    return ThreadPoolRegistry()->Create(
+        "C10",
+        /* device_id */ 0,
+        /* pool_size */ pool_size,
+        /* create_new */ true); // create a separate thread pool for intra-op
+  }();
   return *pool;
 }
 
+// Runs task i of `range` on the NUMA node owning the part of
+// [data, data + nbytes) the task works on, assuming the tasks split it evenly
+// in order. A node never gets more tasks than it has threads, counting the
+// calling thread for its own node; the extra tasks go to the node with the
+// most threads left.
+void _run_with_numa_pools(
+    const std::function<void(int, size_t)>& fn,
+    size_t range,
+    const char* data,
+    size_t nbytes) {
+  auto& pool = static_cast<PTNUMAThreadPool&>(_get_intraop_pool());
+  const int num_nodes = pool.num_nodes();
+  const int current_node = c10::GetCurrentNUMANode();
+
+  std::vector<int64_t> free_threads(num_nodes);
+  for (int node = 0; node < num_nodes; ++node) {
+    free_threads[node] = pool.node_size(node) + (node == current_node ? 1 : 0);
+  }
+  std::vector<int> task_nodes(range);
+  for (size_t i = 0; i < range; ++i) {
+    // node of the middle of the task's part
+    int node = c10::GetNUMANode(data + nbytes / (2 * range) * (2 * i + 1));
+    if (node < 0 || node >= num_nodes || free_threads[node] <= 0) {
+      node = std::max_element(free_threads.begin(), free_threads.end()) -
+          free_threads.begin();
+    }
+    --free_threads[node];
+    task_nodes[i] = node;
+  }
+
+  // The current thread runs the first task of its node, or the first task if
+  // there is none.
+  const auto it = std::find(task_nodes.begin(), task_nodes.end(), current_node);
+  const size_t inline_task =
+      it != task_nodes.end() ? it - task_nodes.begin() : 0;
+  for (size_t i = 0; i < range; ++i) {
+    if (i != inline_task) {
+      pool.run_on_node(task_nodes[i], [fn, i]() { fn((int)i, i); });
+    }
+  }
+  fn(0, inline_task);
+}
+
 #endif // C10_MOBILE
 
 // Run lambda function `fn` over `task_id` in [0, `range`) with threadpool.
 // `fn` will be called with params: (thread_pool_task_id, task_id).
 void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
 #ifndef C10_MOBILE
+  if (range > 1 && _numa_aware()) {
+    const void* data = internal::NUMADataHintGuard::data();
+    const size_t nbytes = internal::NUMADataHintGuard::nbytes();
+    if (data && nbytes >= kNUMAAwareMinBytes) {
+      _run_with_numa_pools(fn, range, static_cast<const char*>(data), nbytes);
+      return;
+    }
+  }
   for (size_t i = 1; i < range; ++i) {
     _get_intraop_pool().run([fn, i]() { fn((int)i, i); });
   }
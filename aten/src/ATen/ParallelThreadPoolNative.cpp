@@ -4,7 +4,10 @@
 #include <ATen/PTThreadPool.h>
 #include <ATen/ThreadLocalState.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <cstring>
 
 namespace at {
 
@@ -40,6 +43,9 @@ std::shared_ptr<TaskThreadPoolBase> create_c10_threadpool(
   TORCH_CHECK(device_id == 0);
   // Create new thread pool
   TORCH_CHECK(create_new);
+  if (internal::use_work_stealing_pool()) {
+    return std::make_shared<PTWorkStealingThreadPool>(pool_size);
+  }
   return std::make_shared<PTThreadPool>(pool_size);
 }
 
@@ -68,7 +74,72 @@ int get_num_interop_threads() {
   }
 }
 
+PTNUMAThreadPool::PTNUMAThreadPool(
+    int pool_size,
+    int num_nodes,
+    bool work_stealing) {
+  for (int node = 0; node < num_nodes; ++node) {
+    const int node_size =
+        pool_size / num_nodes + (node < pool_size % num_nodes ? 1 : 0);
+    if (work_stealing) {
+      pools_.push_back(
+          std::make_unique<PTWorkStealingThreadPool>(node_size, node));
+    } else {
+      pools_.push_back(std::make_unique<PTThreadPool>(node_size, node));
+    }
+  }
+}
+
+size_t PTNUMAThreadPool::size() const {
+  size_t size = 0;
+  for (const auto& pool : pools_) {
+    size += pool->size();
+  }
+  return size;
+}
+
+size_t PTNUMAThreadPool::numAvailable() const {
+  size_t available = 0;
+  for (const auto& pool : pools_) {
+    available += pool->numAvailable();
+  }
+  return available;
+}
+
+bool PTNUMAThreadPool::inThreadPool() const {
+  return std::any_of(pools_.begin(), pools_.end(), [](const auto& pool) {
+    return pool->inThreadPool();
+  });
+}
+
+void PTNUMAThreadPool::run(std::function<void()> func) {
+  run_on_node(c10::GetCurrentNUMANode(), std::move(func));
+}
+
+void PTNUMAThreadPool::run_on_node(int node, std::function<void()> func) {
+  if (node < 0 || node >= num_nodes() || pools_[node]->size() == 0) {
+    node = std::max_element(
+               pools_.begin(),
+               pools_.end(),
+               [](const auto& a, const auto& b) {
+                 return a->size() < b->size();
+               }) -
+        pools_.begin();
+  }
+  pools_[node]->run(std::move(func));
+}
+
 namespace internal {
+// TORCH_THREAD_POOL=work_stealing switches both the inter-op pool and the
+// intra-op pools of the native backend to c10::WorkStealingThreadPool
+bool use_work_stealing_pool() {
+  static const bool use = []() {
+    const char* value = std::getenv("TORCH_THREAD_POOL");
+    return value && std::strcmp(value, "work_stealing") == 0;
+  }();
+  return use;
+}
+
 void launch_no_thread_state(std::function<void()> fn) {
 #if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
   intraop_launch(std::move(fn));
@@ -685,6 +685,9 @@ void TensorIteratorBase::for_each(loop2d_t loop, int64_t grain_size) {
   } else if (numel < internal::GRAIN_SIZE || at::get_num_threads() == 1) {
     return serial_for_each(loop, {0, numel});
   } else {
+    // chunks are placed by the pages of the first operand, usually the output
+    internal::NUMADataHintGuard numa_hint(
+        data_ptr(0), numel * element_size(0));
     at::parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
       serial_for_each(loop, {begin, end});
     });
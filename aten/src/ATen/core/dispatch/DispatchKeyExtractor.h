@@ -143,6 +143,12 @@ public:
     return dispatchKeySetToDispatchKey_(eligibleKeys, ks);
   }
 
+  // The key for a call whose dispatch arguments have the combined key set
+  // `ks`, given the current thread local dispatch key state.
+  DispatchKey getDispatchKeyForKeySet(DispatchKeySet ks) const {
+    return dispatchKeySetToDispatchKey_(DispatchKeySet::FULL, ks);
+  }
+
   void setOperatorHasFallthroughForKey(DispatchKey k, bool has_fallthrough);
 
   std::string dumpState() const;
@@ -323,6 +323,12 @@ public:
     c10::Dispatcher::singleton().callBoxed(*this, stack);
   }
 
+  // Returns the dispatch key a call is currently dispatched to if the
+  // tensors among its arguments have the combined key set `ks`.
+  DispatchKey dispatchKeyForKeySet(DispatchKeySet ks) const {
+    return operatorIterator_->op.dispatchKeyExtractor().getDispatchKeyForKeySet(ks);
+  }
+
 private:
   explicit OperatorHandle(std::list<Dispatcher::OperatorDef>::iterator operatorIterator)
   : operatorIterator_(std::move(operatorIterator)) {}
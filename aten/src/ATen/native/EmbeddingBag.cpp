@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/EmbeddingBag.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -425,7 +426,8 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
 
 // Assumes all input tensors except for `weight` are contiguous.
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
-std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
+std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl_out(
+    Tensor& output,
     const Tensor& weight,
     const Tensor& indices,
     const Tensor& offsets,
@@ -478,10 +480,9 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
         "include_last_offset: number of offset should be at least 1");
   }
 
-  auto output = at::empty(
+  output.resize_(
       {include_last_offset ? offsets.size(0) - 1 : offsets.size(0),
-       weight.size(1)},
-      weight.options());
+       weight.size(1)});
 
   // To save compute, if we are going to go down the fast path case for the 'sum'
   // mode, we skip calculating offset2bag, since it is not going to be used.
@@ -545,6 +546,28 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
   }
 }
 
+// Assumes all input tensors except for `weight` are contiguous.
+// See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
+std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const int64_t mode,
+    const Tensor& per_sample_weights,
+    bool include_last_offset,
+    bool requires_grad) {
+  auto output = at::empty({0}, weight.options());
+  return _embedding_bag_cpu_impl_out(
+      output,
+      weight,
+      indices,
+      offsets,
+      mode,
+      per_sample_weights,
+      include_last_offset,
+      requires_grad);
+}
+
 // embedding_bag wrapper to enforce contiguity in tensors other than `weight`.
 // This is created to save extra `.contiguous()` call in backward.
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
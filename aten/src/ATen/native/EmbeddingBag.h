@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// Same as _embedding_bag_forward_only_cpu and _embedding_bag_cpu, but writes
+// the bags into a preallocated output tensor, resizing it as needed.
+// Assumes all input tensors except for `weight` are contiguous.
+TORCH_API std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl_out(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const int64_t mode,
+    const Tensor& per_sample_weights,
+    bool include_last_offset,
+    bool requires_grad);
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,47 @@
+// Fused CPU kernels of the _foreach ops
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+enum class ForeachBinaryOp : uint8_t { ADD, SUB, MUL, DIV };
+enum class ForeachUnaryOp : uint8_t { SQRT, EXP };
+enum class ForeachPointwiseOp : uint8_t { ADDCMUL, ADDCDIV };
+
+// The kernels process the elements of all tensors of the lists in one
+// parallel loop. They require floating point tensors on the CPU for which
+// can_use_fast_route holds. `out` is `self` for the in-place variants.
+//
+// `scalars` holds either one scalar for all tensors or one per tensor.
+using foreach_binary_scalar_fn = void (*)(
+    ForeachBinaryOp op,
+    TensorList out,
+    TensorList self,
+    ArrayRef<double> scalars);
+// out = self op alpha * other for ADD and SUB, out = self op other otherwise.
+using foreach_binary_list_fn = void (*)(
+    ForeachBinaryOp op,
+    TensorList out,
+    TensorList self,
+    TensorList other,
+    double alpha);
+using foreach_unary_fn =
+    void (*)(ForeachUnaryOp op, TensorList out, TensorList self);
+using foreach_pointwise_fn = void (*)(
+    ForeachPointwiseOp op,
+    TensorList out,
+    TensorList self,
+    TensorList tensors1,
+    TensorList tensors2,
+    ArrayRef<double> scalars);
+
+DECLARE_DISPATCH(foreach_binary_scalar_fn, foreach_binary_scalar_stub);
+DECLARE_DISPATCH(foreach_binary_list_fn, foreach_binary_list_stub);
+DECLARE_DISPATCH(foreach_unary_fn, foreach_unary_stub);
+DECLARE_DISPATCH(foreach_pointwise_fn, foreach_pointwise_stub);
+
+} // namespace native
+} // namespace at
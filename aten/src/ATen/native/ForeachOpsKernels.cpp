@@ -1,4 +1,5 @@
 #include <ATen/ATen.h>
+#include <ATen/native/ForeachOps.h>
 #include <ATen/native/ForeachUtils.h>
 
 namespace at { namespace native {
@@ -222,4 +223,215 @@ void foreach_tensor_zero_slow_(TensorList tensors) {
   }
 }
 
+// The fused CPU kernels process all tensors of the lists in one parallel
+// loop instead of calling the single tensor op for each of them. They handle
+// float and double tensors, for which the ops don't promote the result to
+// another dtype unless a scalar is complex.
+
+DEFINE_DISPATCH(foreach_binary_scalar_stub);
+DEFINE_DISPATCH(foreach_binary_list_stub);
+DEFINE_DISPATCH(foreach_unary_stub);
+DEFINE_DISPATCH(foreach_pointwise_stub);
+
+namespace {
+
+bool has_fused_cpu_dtype(std::initializer_list<TensorList> tensor_lists) {
+  for (const auto& tensors : tensor_lists) {
+    for (const auto& t : tensors) {
+      if (t.scalar_type() != kFloat && t.scalar_type() != kDouble) {
+        return false;
+      }
+      if (t.scalar_type() != tensor_lists.begin()->front().scalar_type()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<Tensor> empty_like_tensors(TensorList tensors) {
+  std::vector<Tensor> result;
+  result.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    result.emplace_back(at::native::empty_like(t));
+  }
+  return result;
+}
+
+} // namespace
+
+#define FOREACH_BINARY_OP_SCALAR_CPU(NAME, OP)                                                                     \
+void foreach_tensor_##NAME##_scalar_kernel_cpu_(TensorList tensors, Scalar scalar) {                               \
+  check_foreach_api_restrictions(tensors);                                                                         \
+  if (scalar.isComplex() || !has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors, scalar)) {             \
+    return foreach_tensor_##NAME##_scalar_kernel_slow_(tensors, scalar);                                           \
+  }                                                                                                                \
+                                                                                                                   \
+  foreach_binary_scalar_stub(kCPU, OP, tensors, tensors, scalar.to<double>());                                     \
+}                                                                                                                  \
+                                                                                                                   \
+std::vector<Tensor> foreach_tensor_##NAME##_scalar_kernel_cpu(TensorList tensors, Scalar scalar) {                 \
+  check_foreach_api_restrictions(tensors);                                                                         \
+  if (scalar.isComplex() || !has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors, scalar)) {             \
+    return foreach_tensor_##NAME##_scalar_kernel_slow(tensors, scalar);                                            \
+  }                                                                                                                \
+                                                                                                                   \
+  auto result = empty_like_tensors(tensors);                                                                       \
+  foreach_binary_scalar_stub(kCPU, OP, result, tensors, scalar.to<double>());                                      \
+  return result;                                                                                                   \
+}
+
+#define FOREACH_BINARY_OP_SCALARLIST_CPU(NAME, OP)                                                                 \
+void foreach_tensor_##NAME##_scalarlist_kernel_cpu_(TensorList tensors, at::ArrayRef<double> scalars) {            \
+  check_foreach_api_restrictions(tensors, scalars);                                                                \
+  if (!has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors, scalars)) {                                  \
+    return foreach_tensor_##NAME##_scalarlist_kernel_slow_(tensors, scalars);                                      \
+  }                                                                                                                \
+                                                                                                                   \
+  foreach_binary_scalar_stub(kCPU, OP, tensors, tensors, scalars);                                                 \
+}                                                                                                                  \
+                                                                                                                   \
+std::vector<Tensor> foreach_tensor_##NAME##_scalarlist_kernel_cpu(TensorList tensors, at::ArrayRef<double> scalars) { \
+  check_foreach_api_restrictions(tensors, scalars);                                                                \
+  if (!has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors, scalars)) {                                  \
+    return foreach_tensor_##NAME##_scalarlist_kernel_slow(tensors, scalars);                                       \
+  }                                                                                                                \
+                                                                                                                   \
+  auto result = empty_like_tensors(tensors);                                                                       \
+  foreach_binary_scalar_stub(kCPU, OP, result, tensors, scalars);                                                  \
+  return result;                                                                                                   \
+}
+
+#define FOREACH_BINARY_OP_LIST_CPU(NAME, OP)                                                                       \
+std::vector<Tensor> foreach_tensor_##NAME##_list_kernel_cpu(TensorList tensors1, TensorList tensors2) {            \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                              \
+  if (!has_fused_cpu_dtype({tensors1, tensors2}) || !can_use_fast_route(tensors1, tensors2)) {                     \
+    return foreach_tensor_##NAME##_list_kernel_slow(tensors1, tensors2);                                           \
+  }                                                                                                                \
+                                                                                                                   \
+  auto result = empty_like_tensors(tensors1);                                                                      \
+  foreach_binary_list_stub(kCPU, OP, result, tensors1, tensors2, 1.0);                                             \
+  return result;                                                                                                   \
+}                                                                                                                  \
+                                                                                                                   \
+void foreach_tensor_##NAME##_list_kernel_cpu_(TensorList tensors1, TensorList tensors2) {                          \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                              \
+  if (!has_fused_cpu_dtype({tensors1, tensors2}) || !can_use_fast_route(tensors1, tensors2)) {                     \
+    return foreach_tensor_##NAME##_list_kernel_slow_(tensors1, tensors2);                                          \
+  }                                                                                                                \
+                                                                                                                   \
+  foreach_binary_list_stub(kCPU, OP, tensors1, tensors1, tensors2, 1.0);                                           \
+}
+
+#define FOREACH_BINARY_OP_LIST_ALPHA_CPU(NAME, OP)                                                                 \
+std::vector<Tensor> foreach_tensor_##NAME##_list_kernel_cpu(TensorList tensors1, TensorList tensors2, Scalar alpha) { \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                              \
+  if (alpha.isComplex() || !has_fused_cpu_dtype({tensors1, tensors2}) || !can_use_fast_route(tensors1, tensors2)) { \
+    return foreach_tensor_##NAME##_list_kernel_slow(tensors1, tensors2, alpha);                                    \
+  }                                                                                                                \
+                                                                                                                   \
+  auto result = empty_like_tensors(tensors1);                                                                      \
+  foreach_binary_list_stub(kCPU, OP, result, tensors1, tensors2, alpha.to<double>());                              \
+  return result;                                                                                                   \
+}                                                                                                                  \
+                                                                                                                   \
+void foreach_tensor_##NAME##_list_kernel_cpu_(TensorList tensors1, TensorList tensors2, Scalar alpha) {            \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                              \
+  if (alpha.isComplex() || !has_fused_cpu_dtype({tensors1, tensors2}) || !can_use_fast_route(tensors1, tensors2)) { \
+    return foreach_tensor_##NAME##_list_kernel_slow_(tensors1, tensors2, alpha);                                   \
+  }                                                                                                                \
+                                                                                                                   \
+  foreach_binary_list_stub(kCPU, OP, tensors1, tensors1, tensors2, alpha.to<double>());                            \
+}
+
+#define FOREACH_UNARY_OP_CPU(NAME, OP)                                                                             \
+std::vector<Tensor> foreach_tensor_##NAME##_cpu(TensorList tensors) {                                              \
+  check_foreach_api_restrictions(tensors);                                                                         \
+  if (!has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors)) {                                           \
+    return foreach_tensor_##NAME##_slow(tensors);                                                                  \
+  }                                                                                                                \
+                                                                                                                   \
+  auto result = empty_like_tensors(tensors);                                                                       \
+  foreach_unary_stub(kCPU, OP, result, tensors);                                                                   \
+  return result;                                                                                                   \
+}                                                                                                                  \
+                                                                                                                   \
+void foreach_tensor_##NAME##_cpu_(TensorList tensors) {                                                            \
+  check_foreach_api_restrictions(tensors);                                                                         \
+  if (!has_fused_cpu_dtype({tensors}) || !can_use_fast_route(tensors)) {                                           \
+    return foreach_tensor_##NAME##_slow_(tensors);                                                                 \
+  }                                                                                                                \
+                                                                                                                   \
+  foreach_unary_stub(kCPU, OP, tensors, tensors);                                                                  \
+}
+
+#define FOREACH_POINTWISE_OP_SCALAR_CPU(NAME, OP)                                                                                  \
+std::vector<Tensor> foreach_tensor_##NAME##_scalar_cpu(TensorList input, TensorList tensors1, TensorList tensors2, Scalar scalar) { \
+  check_foreach_api_restrictions(input, tensors1, tensors2);                                                                       \
+  if (scalar.isComplex() || !has_fused_cpu_dtype({input, tensors1, tensors2}) ||                                                   \
+      !can_use_fast_route(input, tensors1, tensors2, scalar)) {                                                                    \
+    return foreach_tensor_##NAME##_scalar_slow(input, tensors1, tensors2, scalar);                                                 \
+  }                                                                                                                                \
+                                                                                                                                   \
+  auto result = empty_like_tensors(input);                                                                                         \
+  foreach_pointwise_stub(kCPU, OP, result, input, tensors1, tensors2, scalar.to<double>());                                        \
+  return result;                                                                                                                   \
+}                                                                                                                                  \
+                                                                                                                                   \
+void foreach_tensor_##NAME##_scalar_cpu_(TensorList input, TensorList tensors1, TensorList tensors2, Scalar scalar) {              \
+  check_foreach_api_restrictions(input, tensors1, tensors2);                                                                       \
+  if (scalar.isComplex() || !has_fused_cpu_dtype({input, tensors1, tensors2}) ||                                                   \
+      !can_use_fast_route(input, tensors1, tensors2, scalar)) {                                                                    \
+    return foreach_tensor_##NAME##_scalar_slow_(input, tensors1, tensors2, scalar);                                                \
+  }                                                                                                                                \
+                                                                                                                                   \
+  foreach_pointwise_stub(kCPU, OP, input, input, tensors1, tensors2, scalar.to<double>());                                         \
+}
+
+#define FOREACH_POINTWISE_OP_SCALARLIST_CPU(NAME, OP)                                                                                                \
+std::vector<Tensor> foreach_tensor_##NAME##_scalarlist_cpu(TensorList input, TensorList tensors1, TensorList tensors2, at::ArrayRef<double> scalars) { \
+  check_foreach_api_restrictions(input, tensors1, tensors2, scalars);                                                                                \
+  if (!has_fused_cpu_dtype({input, tensors1, tensors2}) || !can_use_fast_route(input, tensors1, tensors2, scalars)) {                                \
+    return foreach_tensor_##NAME##_scalarlist_slow(input, tensors1, tensors2, scalars);                                                              \
+  }                                                                                                                                                  \
+                                                                                                                                                     \
+  auto result = empty_like_tensors(input);                                                                                                           \
+  foreach_pointwise_stub(kCPU, OP, result, input, tensors1, tensors2, scalars);                                                                      \
+  return result;                                                                                                                                     \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+void foreach_tensor_##NAME##_scalarlist_cpu_(TensorList input, TensorList tensors1, TensorList tensors2, at::ArrayRef<double> scalars) {              \
+  check_foreach_api_restrictions(input, tensors1, tensors2, scalars);                                                                                \
+  if (!has_fused_cpu_dtype({input, tensors1, tensors2}) || !can_use_fast_route(input, tensors1, tensors2, scalars)) {                                \
+    return foreach_tensor_##NAME##_scalarlist_slow_(input, tensors1, tensors2, scalars);                                                             \
+  }                                                                                                                                                  \
+                                                                                                                                                     \
+  foreach_pointwise_stub(kCPU, OP, input, input, tensors1, tensors2, scalars);                                                                       \
+}
+
+FOREACH_BINARY_OP_SCALAR_CPU(add, ForeachBinaryOp::ADD);
+FOREACH_BINARY_OP_SCALAR_CPU(sub, ForeachBinaryOp::SUB);
+FOREACH_BINARY_OP_SCALAR_CPU(mul, ForeachBinaryOp::MUL);
+FOREACH_BINARY_OP_SCALAR_CPU(div, ForeachBinaryOp::DIV);
+
+FOREACH_BINARY_OP_SCALARLIST_CPU(add, ForeachBinaryOp::ADD);
+FOREACH_BINARY_OP_SCALARLIST_CPU(sub, ForeachBinaryOp::SUB);
+FOREACH_BINARY_OP_SCALARLIST_CPU(mul, ForeachBinaryOp::MUL);
+FOREACH_BINARY_OP_SCALARLIST_CPU(div, ForeachBinaryOp::DIV);
+
+FOREACH_BINARY_OP_LIST_ALPHA_CPU(add, ForeachBinaryOp::ADD);
+FOREACH_BINARY_OP_LIST_ALPHA_CPU(sub, ForeachBinaryOp::SUB);
+
+FOREACH_BINARY_OP_LIST_CPU(mul, ForeachBinaryOp::MUL);
+FOREACH_BINARY_OP_LIST_CPU(div, ForeachBinaryOp::DIV);
+
+FOREACH_UNARY_OP_CPU(sqrt, ForeachUnaryOp::SQRT);
+FOREACH_UNARY_OP_CPU(exp, ForeachUnaryOp::EXP);
+
+FOREACH_POINTWISE_OP_SCALAR_CPU(addcmul, ForeachPointwiseOp::ADDCMUL);
+FOREACH_POINTWISE_OP_SCALAR_CPU(addcdiv, ForeachPointwiseOp::ADDCDIV);
+
+FOREACH_POINTWISE_OP_SCALARLIST_CPU(addcmul, ForeachPointwiseOp::ADDCMUL);
+FOREACH_POINTWISE_OP_SCALARLIST_CPU(addcdiv, ForeachPointwiseOp::ADDCDIV);
+
 }} // namespace at::native
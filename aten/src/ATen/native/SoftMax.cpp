@@ -4,6 +4,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/WrapDimUtils.h>
+#include <ATen/native/SoftMax.h>
 #include <ATen/native/cpu/SoftmaxKernel.h>
 #include <ATen/NamedTensorUtils.h>
 
@@ -117,10 +118,10 @@ void host_softmax_backward(
 }
 } // namespace
 
-Tensor softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_float) {
+Tensor& softmax_cpu_out(Tensor& output, const Tensor& input_, const int64_t dim_, const bool half_to_float) {
   AT_ASSERTM(!half_to_float, "softmax with half to float conversion is not supported on CPU");
   auto input = input_.contiguous();
-  Tensor output = at::native::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  output.resize_(input.sizes());
   int64_t dim = maybe_wrap_dim(dim_, input.dim());
 
   if (input.numel() == 0) {
@@ -141,10 +142,15 @@ Tensor softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_
   return output;
 }
 
-Tensor log_softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_float) {
+Tensor softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_float) {
+  Tensor output = at::native::empty_like(input_, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  return softmax_cpu_out(output, input_, dim_, half_to_float);
+}
+
+Tensor& log_softmax_cpu_out(Tensor& output, const Tensor& input_, const int64_t dim_, const bool half_to_float) {
   AT_ASSERTM(!half_to_float, "softmax with half to float conversion is not supported on CPU");
   auto input = input_.contiguous();
-  Tensor output = at::native::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  output.resize_(input.sizes());
   int64_t dim = maybe_wrap_dim(dim_, input.dim());
 
   if (input.numel() == 0) {
@@ -165,6 +171,11 @@ Tensor log_softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half
   return output;
 }
 
+Tensor log_softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_float) {
+  Tensor output = at::native::empty_like(input_, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  return log_softmax_cpu_out(output, input_, dim_, half_to_float);
+}
+
 Tensor softmax_backward_cpu(
     const Tensor& grad_,
     const Tensor& output_,
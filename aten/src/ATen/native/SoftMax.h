@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// Out variants of softmax_cpu and log_softmax_cpu, used by the JIT Static
+// Runtime to write into preallocated outputs
+TORCH_API Tensor& softmax_cpu_out(
+    Tensor& output,
+    const Tensor& input,
+    const int64_t dim,
+    const bool half_to_float);
+TORCH_API Tensor& log_softmax_cpu_out(
+    Tensor& output,
+    const Tensor& input,
+    const int64_t dim,
+    const bool half_to_float);
+
+} // namespace native
+} // namespace at
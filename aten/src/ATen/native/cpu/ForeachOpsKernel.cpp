@@ -0,0 +1,275 @@
+// Fused CPU kernels of the _foreach ops
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/ForeachOps.h>
+
+#include <array>
+
+namespace at {
+namespace native {
+namespace {
+
+using namespace vec256;
+
+// Number of elements processed by one iteration of the parallel loop.
+constexpr int64_t kChunkSize = internal::GRAIN_SIZE;
+
+// A range of elements of the tensors at index `tensor` of the lists.
+struct TensorPiece {
+  int64_t tensor;
+  int64_t begin;
+  int64_t size;
+};
+
+// Calls `fn(data, size, tensor)` for ranges of the tensors at index `tensor`
+// of all `lists`, where `data[i]` points to the first of `size` elements in
+// the tensor of `lists[i]`. The tensors at the same index must be
+// non-overlapping and dense with the same strides, so that their elements are
+// in the same memory order.
+//
+// Large tensors are split and small ones are grouped into chunks of about
+// kChunkSize elements, which are processed in one parallel loop regardless of
+// the number of tensors.
+template <typename scalar_t, size_t depth, typename func_t>
+void multi_tensor_apply(
+    const std::array<TensorList, depth>& lists,
+    const func_t& fn) {
+  const int64_t num_tensors = lists[0].size();
+  std::vector<std::array<scalar_t*, depth>> data(num_tensors);
+  std::vector<TensorPiece> pieces;
+  // Chunk c consists of the pieces in [chunk_begins[c], chunk_begins[c + 1]).
+  std::vector<int64_t> chunk_begins{0};
+  int64_t chunk_size = 0;
+  for (int64_t t = 0; t < num_tensors; t++) {
+    for (size_t i = 0; i < depth; i++) {
+      data[t][i] = lists[i][t].template data_ptr<scalar_t>();
+    }
+    const int64_t numel = lists[0][t].numel();
+    int64_t begin = 0;
+    while (begin < numel) {
+      const int64_t size = std::min(kChunkSize - chunk_size, numel - begin);
+      pieces.push_back({t, begin, size});
+      begin += size;
+      chunk_size += size;
+      if (chunk_size == kChunkSize) {
+        chunk_begins.push_back(pieces.size());
+        chunk_size = 0;
+      }
+    }
+  }
+  if (chunk_size > 0) {
+    chunk_begins.push_back(pieces.size());
+  }
+
+  const int64_t num_chunks = chunk_begins.size() - 1;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    std::array<scalar_t*, depth> piece_data;
+    for (int64_t p = chunk_begins[begin]; p < chunk_begins[end]; p++) {
+      const auto& piece = pieces[p];
+      for (size_t i = 0; i < depth; i++) {
+        piece_data[i] = data[piece.tensor][i] + piece.begin;
+      }
+      fn(piece_data, piece.size, piece.tensor);
+    }
+  });
+}
+
+template <typename scalar_t>
+scalar_t scalar_for_tensor(ArrayRef<double> scalars, int64_t tensor) {
+  return static_cast<scalar_t>(
+      scalars.size() == 1 ? scalars[0] : scalars[tensor]);
+}
+
+template <typename scalar_t, typename vec_op_t>
+void binary_scalar_op(
+    TensorList out,
+    TensorList self,
+    ArrayRef<double> scalars,
+    const vec_op_t& vec_op) {
+  using Vec = Vec256<scalar_t>;
+  multi_tensor_apply<scalar_t, 2>(
+      {{out, self}},
+      [&](const std::array<scalar_t*, 2>& data, int64_t size, int64_t t) {
+        const Vec b(scalar_for_tensor<scalar_t>(scalars, t));
+        map([&](Vec a) { return vec_op(a, b); }, data[0], data[1], size);
+      });
+}
+
+template <typename scalar_t, typename vec_op_t>
+void binary_list_op(
+    TensorList out,
+    TensorList self,
+    TensorList other,
+    const vec_op_t& vec_op) {
+  multi_tensor_apply<scalar_t, 3>(
+      {{out, self, other}},
+      [&](const std::array<scalar_t*, 3>& data, int64_t size, int64_t) {
+        map2(vec_op, data[0], data[1], data[2], size);
+      });
+}
+
+template <typename scalar_t, typename vec_op_t>
+void unary_op(TensorList out, TensorList self, const vec_op_t& vec_op) {
+  multi_tensor_apply<scalar_t, 2>(
+      {{out, self}},
+      [&](const std::array<scalar_t*, 2>& data, int64_t size, int64_t) {
+        map(vec_op, data[0], data[1], size);
+      });
+}
+
+template <typename scalar_t, typename vec_op_t>
+void pointwise_op(
+    TensorList out,
+    TensorList self,
+    TensorList tensors1,
+    TensorList tensors2,
+    ArrayRef<double> scalars,
+    const vec_op_t& vec_op) {
+  using Vec = Vec256<scalar_t>;
+  multi_tensor_apply<scalar_t, 4>(
+      {{out, self, tensors1, tensors2}},
+      [&](const std::array<scalar_t*, 4>& data, int64_t size, int64_t t) {
+        const Vec value(scalar_for_tensor<scalar_t>(scalars, t));
+        map3(
+            [&](Vec self_vec, Vec t1_vec, Vec t2_vec) {
+              return vec_op(self_vec, t1_vec, t2_vec, value);
+            },
+            data[0],
+            data[1],
+            data[2],
+            data[3],
+            size);
+      });
+}
+
+static void foreach_binary_scalar_kernel(
+    ForeachBinaryOp op,
+    TensorList out,
+    TensorList self,
+    ArrayRef<double> scalars) {
+  AT_DISPATCH_FLOATING_TYPES(
+      self[0].scalar_type(), "foreach_binary_op_scalar_cpu", [&] {
+        using Vec = Vec256<scalar_t>;
+        switch (op) {
+          case ForeachBinaryOp::ADD:
+            binary_scalar_op<scalar_t>(
+                out, self, scalars, [](Vec a, Vec b) { return a + b; });
+            break;
+          case ForeachBinaryOp::SUB:
+            binary_scalar_op<scalar_t>(
+                out, self, scalars, [](Vec a, Vec b) { return a - b; });
+            break;
+          case ForeachBinaryOp::MUL:
+            binary_scalar_op<scalar_t>(
+                out, self, scalars, [](Vec a, Vec b) { return a * b; });
+            break;
+          case ForeachBinaryOp::DIV:
+            binary_scalar_op<scalar_t>(
+                out, self, scalars, [](Vec a, Vec b) { return a / b; });
+            break;
+        }
+      });
+}
+
+static void foreach_binary_list_kernel(
+    ForeachBinaryOp op,
+    TensorList out,
+    TensorList self,
+    TensorList other,
+    double alpha) {
+  AT_DISPATCH_FLOATING_TYPES(
+      self[0].scalar_type(), "foreach_binary_op_list_cpu", [&] {
+        using Vec = Vec256<scalar_t>;
+        const Vec alpha_vec(static_cast<scalar_t>(alpha));
+        switch (op) {
+          case ForeachBinaryOp::ADD:
+            binary_list_op<scalar_t>(out, self, other, [=](Vec a, Vec b) {
+              return a + alpha_vec * b;
+            });
+            break;
+          case ForeachBinaryOp::SUB:
+            binary_list_op<scalar_t>(out, self, other, [=](Vec a, Vec b) {
+              return a - alpha_vec * b;
+            });
+            break;
+          case ForeachBinaryOp::MUL:
+            binary_list_op<scalar_t>(
+                out, self, other, [](Vec a, Vec b) { return a * b; });
+            break;
+          case ForeachBinaryOp::DIV:
+            binary_list_op<scalar_t>(
+                out, self, other, [](Vec a, Vec b) { return a / b; });
+            break;
+        }
+      });
+}
+
+static void foreach_unary_kernel(
+    ForeachUnaryOp op,
+    TensorList out,
+    TensorList self) {
+  AT_DISPATCH_FLOATING_TYPES(
+      self[0].scalar_type(), "foreach_unary_op_cpu", [&] {
+        using Vec = Vec256<scalar_t>;
+        switch (op) {
+          case ForeachUnaryOp::SQRT:
+            unary_op<scalar_t>(out, self, [](Vec a) { return a.sqrt(); });
+            break;
+          case ForeachUnaryOp::EXP:
+            unary_op<scalar_t>(out, self, [](Vec a) { return a.exp(); });
+            break;
+        }
+      });
+}
+
+static void foreach_pointwise_kernel(
+    ForeachPointwiseOp op,
+    TensorList out,
+    TensorList self,
+    TensorList tensors1,
+    TensorList tensors2,
+    ArrayRef<double> scalars) {
+  AT_DISPATCH_FLOATING_TYPES(
+      self[0].scalar_type(), "foreach_pointwise_op_cpu", [&] {
+        using Vec = Vec256<scalar_t>;
+        // Same order of operations as addcmul and addcdiv.
+        switch (op) {
+          case ForeachPointwiseOp::ADDCMUL:
+            pointwise_op<scalar_t>(
+                out,
+                self,
+                tensors1,
+                tensors2,
+                scalars,
+                [](Vec self_vec, Vec t1_vec, Vec t2_vec, Vec value) {
+                  return self_vec + value * t1_vec * t2_vec;
+                });
+            break;
+          case ForeachPointwiseOp::ADDCDIV:
+            pointwise_op<scalar_t>(
+                out,
+                self,
+                tensors1,
+                tensors2,
+                scalars,
+                [](Vec self_vec, Vec t1_vec, Vec t2_vec, Vec value) {
+                  return self_vec + value * t1_vec / t2_vec;
+                });
+            break;
+        }
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(foreach_binary_scalar_stub, &foreach_binary_scalar_kernel);
+REGISTER_DISPATCH(foreach_binary_list_stub, &foreach_binary_list_kernel);
+REGISTER_DISPATCH(foreach_unary_stub, &foreach_unary_kernel);
+REGISTER_DISPATCH(foreach_pointwise_stub, &foreach_pointwise_kernel);
+
+} // namespace native
+} // namespace at
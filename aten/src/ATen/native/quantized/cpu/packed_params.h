@@ -2,6 +2,8 @@
 
 #include <ATen/core/ivalue.h>
 
+#include <cstring>
+
 struct LinearPackedParamsBase : public torch::jit::CustomClassHolder {
   virtual at::Tensor apply(
       at::Tensor input,
@@ -12,6 +14,28 @@ struct LinearPackedParamsBase : public torch::jit::CustomClassHolder {
       double output_scale,
       int64_t output_zero_point) = 0;
 
+  // Same as apply(), but writes into a preallocated quantized output with the
+  // given scale and zero point, resizing it as needed. The default
+  // implementation computes apply() and copies the result over.
+  virtual at::Tensor& apply_out(
+      const at::Tensor& input,
+      double output_scale,
+      int64_t output_zero_point,
+      at::Tensor& output) {
+    TORCH_CHECK(
+        output.is_quantized() && output.q_scale() == output_scale &&
+            output.q_zero_point() == output_zero_point,
+        "apply_out expects a quantized output with scale ",
+        output_scale,
+        " and zero point ",
+        output_zero_point);
+    at::Tensor result = apply(input, output_scale, output_zero_point);
+    TORCH_CHECK(result.scalar_type() == output.scalar_type());
+    output.resize_(result.sizes());
+    std::memcpy(output.data_ptr(), result.data_ptr(), result.nbytes());
+    return output;
+  }
+
   virtual at::Tensor apply_dynamic(at::Tensor input, bool reduce_range=false) = 0;
   virtual at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range=false) = 0;
 
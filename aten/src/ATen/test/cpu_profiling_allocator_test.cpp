@@ -158,9 +158,106 @@ TEST(CPUAllocationPlanTest, with_profiling_alloc) {
   ASSERT_TRUE(ref_output.equal(output));
 
   // When control flow conditions are different between profiling and evaluation
-  // profiling allocator should throw.
-  ASSERT_THROW(validate_allocation_plan(true, false, false), c10::Error);
-  ASSERT_THROW(validate_allocation_plan(false, true, false), c10::Error);
+  // the allocations that do not fit the plan fall back to the default
+  // allocator.
+  ASSERT_NO_THROW(validate_allocation_plan(true, false, false));
+  ASSERT_NO_THROW(validate_allocation_plan(false, true, false));
+}
+
+TEST(CPUAllocationPlanTest, with_shape_buckets) {
+  at::Tensor conv_weight = at::rand({16, 16, 3, 3});
+  at::Tensor linear_weight = at::rand({32, 3136});
+  std::vector<void*> pointers;
+
+  auto signature = [](const at::Tensor& input) {
+    return c10::AllocationPlanCache::ShapeSignature{input.sizes().vec()};
+  };
+
+  c10::AllocationPlanCache plans;
+  c10::CPUProfilingAllocator profiling_allocator;
+  {
+    at::Tensor input = at::rand({16, 16, 16, 16});
+    ASSERT_EQ(plans.find(signature(input)), nullptr);
+    c10::WithProfileAllocationsGuard profile_guard(
+        plans.plan_to_record(signature(input)));
+    run_with_control_flow(input, conv_weight, linear_weight, true, pointers);
+  }
+  // Smaller batches are served by the plan recorded for batch size 16
+  for (int64_t batch_size : {16, 9, 3, 1}) {
+    at::Tensor input = at::rand({batch_size, 16, 16, 16});
+    const c10::AllocationPlan* plan = plans.find(signature(input));
+    ASSERT_NE(plan, nullptr);
+    at::Tensor ref_output =
+        run_with_control_flow(input, conv_weight, linear_weight, true, pointers);
+    at::Tensor output;
+    {
+      c10::WithProfilingAllocatorGuard allocator_guard(
+          &profiling_allocator, plan);
+      output = run_with_control_flow(
+          input, conv_weight, linear_weight, true, pointers);
+      ASSERT_EQ(profiling_allocator.num_fallbacks(), 0u);
+    }
+    ASSERT_TRUE(ref_output.equal(output));
+  }
+
+  // Larger ones are not, until profiled into their own bucket
+  at::Tensor input = at::rand({23, 16, 16, 16});
+  ASSERT_EQ(plans.find(signature(input)), nullptr);
+  {
+    c10::WithProfileAllocationsGuard profile_guard(
+        plans.plan_to_record(signature(input)));
+    run_with_control_flow(input, conv_weight, linear_weight, true, pointers);
+  }
+  ASSERT_EQ(plans.size(), 2u);
+  ASSERT_NE(plans.find(signature(input)), nullptr);
+  ASSERT_NE(
+      plans.find(signature(input)),
+      plans.find(signature(at::rand({16, 16, 16, 16}))));
+  ASSERT_TRUE(c10::AllocationPlanCache::bucket({{23, 16, 3}}) ==
+      c10::AllocationPlanCache::ShapeSignature({{32, 16, 4}}));
+
+  // Allocations larger than planned fall back one by one
+  at::Tensor larger = at::rand({24, 16, 16, 16});
+  at::Tensor ref_output =
+      run_with_control_flow(larger, conv_weight, linear_weight, true, pointers);
+  at::Tensor output;
+  {
+    c10::WithProfilingAllocatorGuard allocator_guard(
+        &profiling_allocator, plans.find(signature(input)));
+    output = run_with_control_flow(
+        larger, conv_weight, linear_weight, true, pointers);
+    ASSERT_GT(profiling_allocator.num_fallbacks(), 0u);
+  }
+  ASSERT_TRUE(ref_output.equal(output));
+}
+
+TEST(CPUAllocationPlanTest, with_zero_size_allocation) {
+  // Three 64 byte allocations, each freed before the next one, so that the
+  // plan places all of them at the same offset.
+  int keys[3];
+  c10::AllocationPlan plan;
+  c10::AllocationPlanner planner(&plan);
+  for (auto& key : keys) {
+    planner.record_allocation(64, &key);
+    planner.record_free(&key);
+  }
+  planner.formulate_plan();
+
+  c10::CPUProfilingAllocator profiling_allocator;
+  profiling_allocator.set_plan(&plan);
+  void* live = profiling_allocator.allocate(64);
+  // An empty allocation must not take over the offset of the live block...
+  void* empty = profiling_allocator.allocate(0);
+  ASSERT_NE(empty, live);
+  profiling_allocator.free(empty);
+  // ...so that freeing it keeps the block live, and the next allocation
+  // planned at its offset falls back.
+  void* next = profiling_allocator.allocate(64);
+  ASSERT_NE(next, live);
+  ASSERT_EQ(profiling_allocator.num_fallbacks(), 1u);
+  profiling_allocator.free(next);
+  profiling_allocator.free(live);
+  profiling_allocator.unset_plan();
 }
 
 int main(int argc, char* argv[]) {
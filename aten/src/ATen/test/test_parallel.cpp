@@ -3,10 +3,14 @@
 #include <ATen/ATen.h>
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
+#include <ATen/PTThreadPool.h>
 
+#include <atomic>
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace at;
 
@@ -69,3 +73,67 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, NUMADataHint) {
+  std::vector<float> data(1 << 20);
+  ASSERT_EQ(at::internal::NUMADataHintGuard::data(), nullptr);
+  {
+    at::internal::NUMADataHintGuard outer(data.data(), data.size() * 4);
+    {
+      at::internal::NUMADataHintGuard inner(data.data() + 1, 4);
+      ASSERT_EQ(at::internal::NUMADataHintGuard::data(), data.data() + 1);
+      ASSERT_EQ(at::internal::NUMADataHintGuard::nbytes(), 4u);
+    }
+    ASSERT_EQ(at::internal::NUMADataHintGuard::data(), data.data());
+
+    // chunks cover the range exactly once whichever node runs them
+    std::vector<std::atomic<int>> visits(data.size());
+    at::parallel_for(0, data.size(), 1024, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        visits[i]++;
+      }
+    });
+    for (const auto& v : visits) {
+      ASSERT_EQ(v.load(), 1);
+    }
+  }
+  ASSERT_EQ(at::internal::NUMADataHintGuard::nbytes(), 0u);
+}
+
+TEST(TestParallel, NUMAThreadPool) {
+  // Binding threads to a node has no effect unless NUMA is enabled, so the
+  // nodes don't need to exist.
+  for (bool work_stealing : {false, true}) {
+    at::PTNUMAThreadPool pool(5, 3, work_stealing);
+    ASSERT_EQ(pool.num_nodes(), 3);
+    ASSERT_EQ(pool.node_size(0), 2u);
+    ASSERT_EQ(pool.node_size(1), 2u);
+    ASSERT_EQ(pool.node_size(2), 1u);
+    ASSERT_EQ(pool.size(), 5u);
+    ASSERT_FALSE(pool.inThreadPool());
+
+    // Tasks for unknown nodes go to the largest pool
+    constexpr int kNumTasks = 100;
+    std::atomic<int> num_done{0};
+    std::atomic<int> num_in_pool{0};
+    for (int i = 0; i < kNumTasks; ++i) {
+      pool.run_on_node(i % 5 - 1, [&]() {
+        num_in_pool += pool.inThreadPool();
+        num_done++;
+      });
+    }
+    while (num_done.load() < kNumTasks) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(num_in_pool.load(), kNumTasks);
+  }
+
+  // Nodes without threads
+  at::PTNUMAThreadPool pool(1, 2, /*work_stealing=*/false);
+  ASSERT_EQ(pool.node_size(1), 0u);
+  std::atomic<bool> done{false};
+  pool.run_on_node(1, [&]() { done = true; });
+  while (!done.load()) {
+    std::this_thread::yield();
+  }
+}
@@ -0,0 +1,32 @@
+import torch
+from utils import NUM_LOOP_ITERS
+
+def add_mul(x, y, alpha: float, beta: float):
+    return torch.mul(torch.add(x, y, alpha=alpha), beta)
+
+class Scale(torch.nn.Module):
+    def __init__(self):
+        super(Scale, self).__init__()
+        self.alpha = 0.5
+        self.beta = 0.25
+
+class Config(torch.nn.Module):
+    def __init__(self):
+        super(Config, self).__init__()
+        self.scale = Scale()
+
+class InterpreterOverheadModule(torch.nn.Module):
+    """ Runs cheap ops on their operands in a scripted loop and reads their
+    scalar arguments through a chain of submodule attributes, so that most of
+    the time is spent in the TorchScript interpreter rather than in the ops.
+    """
+    def __init__(self, op):
+        super(InterpreterOverheadModule, self).__init__()
+        self.op = op
+        self.config = Config()
+
+    def forward(self, x, y):
+        z = x
+        for _ in range(NUM_LOOP_ITERS):
+            z = self.op(z, y, self.config.scale.alpha, self.config.scale.beta)
+        return z
@@ -1,15 +1,21 @@
+import torch
 from utils import ms_to_us, benchmark_module, BenchmarkConfig, ModuleConfig
 import argparse
 from C2Module import C2SimpleNet
 
 from SimpleAddModule import SimpleAddModule, add_tensors_loop
+from InterpreterOverheadModule import InterpreterOverheadModule, add_mul
 from pt_wrapper_module import WrapperModule
 
 """ Framework overhead benchmark script.
 Benchmark framework overhead.
-Currently supported ops: add.
+Currently supported ops: add, interpreter, lite_interpreter.
 As of now runs only forward pass.
 Supports both graph mode and eager mode. In graph mode the module is traced via JIT tracing.
+The interpreter op is scripted instead and measures the overhead of the TorchScript
+interpreter on a loop of cheap ops, with and without interpreter superinstructions.
+The lite_interpreter op runs the same module in the lite interpreter, with bytecode
+exported with and without register operands.
 Debug option prints the traced graph is graph_mode is enabled.
 Graph can be saved via save option. Saved in the directory where benchmark is run.
 Example build/run:
@@ -18,12 +24,16 @@ buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_ben
  --add_op --graph_mode --eager_mode (Runs both graph mode and eager mode)
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --graph_mode (Runs only graph mode)
+buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
+ --op interpreter_op (Runs graph mode with superinstructions enabled and disabled)
+buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
+ --op lite_interpreter_op (Runs the lite interpreter with register operands enabled and disabled)
 To run C2 benchmark:
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --benchmark_c2_net
 """
 
-SUPPORTED_OPS = {"add_op"}
+SUPPORTED_OPS = {"add_op", "interpreter_op", "lite_interpreter_op"}
 
 def parse_op_args(op):
     op_list = ops.split(",")
@@ -61,6 +71,41 @@ def benchmark_simple_fn(args, config, module_config, module_type, result):
         latency_per_iter_ms = benchmark_module(config, module, args.use_throughput_benchmark)
         result[result_key] = latency_per_iter_ms
 
+def benchmark_interpreter(args, config, module_config, result):
+    """ Benchmarks InterpreterOverheadModule in graph mode, once with interpreter
+    superinstructions enabled and once with them disabled. The flag is read when the
+    interpreter code for a graph is created, so it is set before the module is first run.
+    """
+    for superinstructions in [True, False]:
+        old_flag = torch._C._jit_set_interpreter_superinstructions_enabled(superinstructions)
+        try:
+            f_name = module_config.pt_fn.__name__ + ":Num Operands=" + str(module_config.num_params)
+            superinstructions_str = "Superinstructions" + ":" + str(superinstructions)
+            result_key = ','.join((f_name, superinstructions_str))
+            module = WrapperModule(InterpreterOverheadModule, module_config, args.debug, args.save, script=True)
+            latency_per_iter_ms = benchmark_module(config, module, args.use_throughput_benchmark)
+            result[result_key] = latency_per_iter_ms
+        finally:
+            torch._C._jit_set_interpreter_superinstructions_enabled(old_flag)
+
+def benchmark_lite_interpreter(args, config, module_config, result):
+    """ Benchmarks InterpreterOverheadModule in the lite interpreter, once with bytecode
+    that uses register operands and once with the stack based bytecode. The flag is read
+    when the module is exported for the lite interpreter.
+    """
+    for register_operands in [True, False]:
+        old_flag = torch._C._jit_set_mobile_register_operands_enabled(register_operands)
+        try:
+            f_name = module_config.pt_fn.__name__ + ":Num Operands=" + str(module_config.num_params)
+            register_operands_str = "Register operands" + ":" + str(register_operands)
+            result_key = ','.join((f_name, register_operands_str))
+            module = WrapperModule(InterpreterOverheadModule, module_config, args.debug, args.save,
+                                   script=True, lite=True)
+        finally:
+            torch._C._jit_set_mobile_register_operands_enabled(old_flag)
+        latency_per_iter_ms = benchmark_module(config, module)
+        result[result_key] = latency_per_iter_ms
+
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument("--op", default="add_op", dest="op", type=str)
@@ -93,6 +138,16 @@ def main():
         else:
             module_config = ModuleConfig(add_tensors_loop, None, num_params, graph_mode)
         benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+    elif args.op == "interpreter_op":
+        assert not args.benchmark_c2_net and graph_mode, \
+            "The interpreter op is only benchmarked in graph mode"
+        module_config = ModuleConfig(add_mul, None, 2, graph_mode)
+        benchmark_interpreter(args, config, module_config, result)
+    elif args.op == "lite_interpreter_op":
+        assert not args.benchmark_c2_net and not args.use_throughput_benchmark and graph_mode, \
+            "The lite interpreter op is only benchmarked in graph mode"
+        module_config = ModuleConfig(add_mul, None, 2, graph_mode)
+        benchmark_lite_interpreter(args, config, module_config, result)
     print_results(result)
 
 if __name__ == "__main__":
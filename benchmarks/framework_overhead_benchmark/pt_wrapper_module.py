@@ -1,4 +1,6 @@
+import io
 import torch
+from torch.jit.mobile import _load_for_lite_interpreter
 
 class WrapperModule(object):
     """ Wraps the instance of wrapped_type.
@@ -18,8 +20,12 @@ class WrapperModule(object):
             - Whether debug mode is enabled.
         save:
             - In graph mode, whether graph is to be saved.
+        script:
+            - In graph mode, script the instance instead of tracing it.
+        lite:
+            - In graph mode, run the scripted or traced module in the lite interpreter.
     """
-    def __init__(self, wrapped_type, module_config, debug, save=False):
+    def __init__(self, wrapped_type, module_config, debug, save=False, script=False, lite=False):
         pt_fn = module_config.pt_fn
         self.module = wrapped_type(pt_fn)
         self.tensor_inputs = []
@@ -27,7 +33,10 @@ class WrapperModule(object):
         for _ in range(module_config.num_params):
             self.tensor_inputs.append(torch.randn(1))
         if module_config.graph_mode:
-            self.module = torch.jit.trace(self.module, self.tensor_inputs)
+            if script:
+                self.module = torch.jit.script(self.module)
+            else:
+                self.module = torch.jit.trace(self.module, self.tensor_inputs)
             if save:
                 file_name = self.module_name + "_" + pt_fn.__name__ + ".pt"
                 torch.jit.save(self.module, file_name)
@@ -36,6 +45,9 @@ class WrapperModule(object):
         if (debug and isinstance(self.module, torch.jit.ScriptModule)):
             print(self.module.graph)
             print(self.module.code)
+        if module_config.graph_mode and lite:
+            buffer = io.BytesIO(self.module._save_to_buffer_for_lite_interpreter())
+            self.module = _load_for_lite_interpreter(buffer)
 
     def forward(self, niters):
         with torch.no_grad():
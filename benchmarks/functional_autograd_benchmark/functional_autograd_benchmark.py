@@ -46,6 +46,7 @@ class ModelDef(NamedTuple):
 MODELS = [
     ModelDef("resnet18", vision_models.get_resnet18, FAST_TASKS, []),
     ModelDef("fcn_resnet", vision_models.get_fcn_resnet, FAST_TASKS, []),
+    ModelDef("multi_branch", vision_models.get_multi_branch, FAST_TASKS_NO_DOUBLE_BACK, []),
     ModelDef("detr", vision_models.get_detr, FAST_TASKS, []),
     ModelDef("ppl_simple_reg", ppl_models.get_simple_regression, ALL_TASKS, []),
     ModelDef("ppl_robust_reg", ppl_models.get_robust_regression, ALL_TASKS, []),
@@ -116,12 +117,15 @@ def main():
     parser.add_argument("--task-filter", type=str, default="", help="Only run the tasks in this filter")
     parser.add_argument("--num-threads", type=int, default=10,
                         help="Number of concurrent threads to use when running on cpu")
+    parser.add_argument("--autograd-cpu-threads", type=int, default=1,
+                        help="Number of threads running independent branches of the backward on cpu")
     parser.add_argument("--seed", type=int, default=0, help="The random seed to use.")
     args = parser.parse_args()
 
     results: TimingResultType = defaultdict(defaultdict)
     torch.set_num_threads(args.num_threads)
     torch.set_num_interop_threads(args.num_threads)
+    torch._C._autograd._set_num_cpu_threads(args.autograd_cpu_threads)
 
     # This automatically seed cuda if it is available
     torch.manual_seed(args.seed)
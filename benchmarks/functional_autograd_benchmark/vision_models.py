@@ -95,3 +95,45 @@ def get_detr(device: torch.device) -> GetterReturnType:
         return final_loss
 
     return forward, params
+
+def get_multi_branch(device: torch.device) -> GetterReturnType:
+    # Independent convolution towers over the same input, as in inception-like
+    # blocks. Their backward can run concurrently with --autograd-cpu-threads.
+    N = 8
+    num_branches = 8
+    criterion = torch.nn.CrossEntropyLoss()
+
+    class MultiBranch(torch.nn.Module):
+        def __init__(self):
+            super().__init__()
+            self.branches = torch.nn.ModuleList([
+                torch.nn.Sequential(
+                    torch.nn.Conv2d(3, 16, 3, padding=1),
+                    torch.nn.ReLU(),
+                    torch.nn.Conv2d(16, 16, 3, padding=1),
+                    torch.nn.ReLU(),
+                    torch.nn.Conv2d(16, 16, 3, padding=1),
+                    torch.nn.ReLU(),
+                    torch.nn.AdaptiveAvgPool2d(1),
+                ) for _ in range(num_branches)
+            ])
+            self.fc = torch.nn.Linear(16 * num_branches, 10)
+
+        def forward(self, x: Tensor) -> Tensor:
+            out = torch.cat([branch(x) for branch in self.branches], dim=1)
+            return self.fc(out.flatten(1))
+
+    model = MultiBranch().to(device)
+    params, names = extract_weights(model)
+
+    inputs = torch.rand([N, 3, 64, 64], device=device)
+    labels = torch.rand(N, device=device).mul(10).long()
+
+    def forward(*new_params: Tensor) -> Tensor:
+        load_weights(model, names, new_params)
+        out = model(inputs)
+
+        loss = criterion(out, labels)
+        return loss
+
+    return forward, params
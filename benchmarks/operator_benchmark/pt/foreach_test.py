@@ -0,0 +1,114 @@
+import operator_benchmark as op_bench
+import torch
+from typing import List
+
+
+"""Microbenchmarks for the _foreach ops, against a loop over the single tensor ops."""
+
+
+# Optimizers of models with many small parameters call the _foreach ops on
+# long lists of small tensors.
+foreach_configs_short = op_bench.config_list(
+    attr_names=['num_tensors', 'numel'],
+    attrs=[
+        [1000, 100],
+        [100, 10000],
+    ],
+    cross_product_configs={
+        'device': ['cpu', 'cuda'],
+    },
+    tags=['short']
+)
+
+# Many small tensors or a few large ones, not both, to keep the three input
+# lists within a few hundred MB.
+foreach_configs_long = op_bench.config_list(
+    attr_names=['num_tensors', 'numel'],
+    attrs=[
+        [5000, 64],
+        [5000, 1000],
+        [10, 1000000],
+        [50, 100000],
+    ],
+    cross_product_configs={
+        'device': ['cpu', 'cuda'],
+    },
+    tags=['long']
+)
+
+
+class ForeachBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, num_tensors, numel, device, op_func):
+        def make_tensors():
+            return [torch.rand(numel, device=device) + 1 for _ in range(num_tensors)]
+
+        self.inputs = {
+            "tensors1": make_tensors(),
+            "tensors2": make_tensors(),
+            "tensors3": make_tensors(),
+            "scalars": [1.0 + 1.0 / (i + 1) for i in range(num_tensors)]
+        }
+        self.op_func = op_func
+
+    def forward(self, tensors1: List[torch.Tensor], tensors2: List[torch.Tensor],
+                tensors3: List[torch.Tensor], scalars: List[float]):
+        return self.op_func(tensors1, tensors2, tensors3, scalars)
+
+
+def add_(tensors1, tensors2, tensors3, scalars):
+    torch._foreach_add_(tensors1, tensors2, alpha=0.01)
+
+def add_loop_(tensors1, tensors2, tensors3, scalars):
+    for t1, t2 in zip(tensors1, tensors2):
+        t1.add_(t2, alpha=0.01)
+
+def add_scalar(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_add(tensors1, 1.0)
+
+def mul_scalarlist(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_mul(tensors1, scalars)
+
+def mul_list(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_mul(tensors1, tensors2)
+
+def sqrt(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_sqrt(tensors1)
+
+def exp(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_exp(tensors1)
+
+def addcmul_(tensors1, tensors2, tensors3, scalars):
+    torch._foreach_addcmul_(tensors1, tensors2, tensors3, 0.01)
+
+def addcmul_loop_(tensors1, tensors2, tensors3, scalars):
+    for t1, t2, t3 in zip(tensors1, tensors2, tensors3):
+        t1.addcmul_(t2, t3, value=0.01)
+
+def addcdiv_scalarlist(tensors1, tensors2, tensors3, scalars):
+    return torch._foreach_addcdiv(tensors1, tensors2, tensors3, scalars)
+
+
+foreach_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['add_', add_],
+        ['add_loop_', add_loop_],
+        ['add_scalar', add_scalar],
+        ['mul_scalarlist', mul_scalarlist],
+        ['mul_list', mul_list],
+        ['sqrt', sqrt],
+        ['exp', exp],
+        ['addcmul_', addcmul_],
+        ['addcmul_loop_', addcmul_loop_],
+        ['addcdiv_scalarlist', addcdiv_scalarlist],
+    ],
+)
+
+
+op_bench.generate_pt_tests_from_op_list(foreach_ops_list,
+                                        foreach_configs_short + foreach_configs_long,
+                                        ForeachBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -24,3 +24,130 @@ const auto add_script = R"JIT(
   def forward(self, a, b):
       return a + b
 )JIT";
+
+const auto layer_norm_script = R"JIT(
+  def forward(self, a: Tensor, weight: Tensor, bias: Tensor):
+      return torch.layer_norm(a, [a.size(-1)], weight, bias, 1e-5)
+)JIT";
+
+const auto softmax_script = R"JIT(
+  def forward(self, a: Tensor, dim: int):
+      return torch.softmax(a, dim)
+)JIT";
+
+const auto log_softmax_script = R"JIT(
+  def forward(self, a: Tensor, dim: int):
+      return torch.log_softmax(a, dim)
+)JIT";
+
+const auto sigmoid_script = R"JIT(
+  def forward(self, a: Tensor):
+      return torch.sigmoid(a)
+)JIT";
+
+const auto gelu_script = R"JIT(
+  def forward(self, a: Tensor):
+      return torch.nn.functional.gelu(a)
+)JIT";
+
+const auto embedding_bag_script = R"JIT(
+  def forward(self, weight: Tensor, indices: Tensor, offsets: Tensor, mode: int):
+      return torch.embedding_bag(weight, indices, offsets, False, mode, False, None, False)[0]
+)JIT";
+
+const auto linear_script = R"JIT(
+  def forward(self, a: Tensor, weight: Tensor, bias: Tensor):
+      return torch.nn.functional.linear(a, weight, bias)
+)JIT";
+
+const auto matmul_script = R"JIT(
+  def forward(self, a: Tensor, b: Tensor):
+      return torch.matmul(a, b)
+)JIT";
+
+const auto quantized_linear_script = R"JIT(
+  def forward(self, a: Tensor, weight: Tensor, bias: Tensor):
+      qa = torch.quantize_per_tensor(a, 0.05, 128, torch.quint8)
+      qweight = torch.quantize_per_tensor(weight, 0.02, 0, torch.qint8)
+      packed = torch.ops.quantized.linear_prepack(qweight, bias)
+      return torch.ops.quantized.linear(qa, packed, 0.1, 64).dequantize()
+)JIT";
+
+const auto sum_script = R"JIT(
+  def forward(self, a: Tensor):
+      return torch.sum(a)
+)JIT";
+
+const auto sum_dim_script = R"JIT(
+  def forward(self, a: Tensor, dim: List[int], keepdim: bool):
+      return torch.sum(a, dim, keepdim)
+)JIT";
+
+const auto mean_dim_script = R"JIT(
+  def forward(self, a: Tensor, dim: List[int], keepdim: bool):
+      return torch.mean(a, dim, keepdim)
+)JIT";
+
+const auto to_dtype_script = R"JIT(
+  def forward(self, a: Tensor, dtype: int):
+      return a.to(dtype) * 2
+)JIT";
+
+const auto index_select_script = R"JIT(
+  def forward(self, a: Tensor, dim: int, index: Tensor):
+      return torch.index_select(a, dim, index)
+)JIT";
+
+const auto gather_script = R"JIT(
+  def forward(self, a: Tensor, dim: int, index: Tensor):
+      return torch.gather(a, dim, index)
+)JIT";
+
+const auto where_script = R"JIT(
+  def forward(self, cond: Tensor, a: Tensor, b: Tensor):
+      return torch.where(cond, a, b)
+)JIT";
+
+const auto transpose_contiguous_script = R"JIT(
+  def forward(self, a: Tensor):
+      return a.transpose(0, 1).contiguous() + 1
+)JIT";
+
+const auto if_script = R"JIT(
+  def forward(self, a: Tensor, b: Tensor, flag: bool):
+      c = a * b
+      if flag:
+          d = torch.relu(c) + a
+      else:
+          d = torch.sigmoid(c) - b
+      return d * 2
+)JIT";
+
+const auto loop_script = R"JIT(
+  def forward(self, a: Tensor, b: Tensor, n: int):
+      c = a
+      for i in range(n):
+          c = torch.relu(c * b) + a
+      return c
+)JIT";
+
+const auto while_loop_script = R"JIT(
+  def forward(self, a: Tensor, b: Tensor):
+      c = a
+      i = 0
+      while i < 10 and bool(c.sum() < 100.0):
+          c = c + b
+          i += 1
+      return c
+)JIT";
+
+const auto loop_if_script = R"JIT(
+  def forward(self, a: Tensor, b: Tensor, n: int):
+      c = a
+      for i in range(n):
+          if i % 2 == 0:
+              c = c * b
+          else:
+              c = c + a
+      return torch.tanh(c)
+)JIT";
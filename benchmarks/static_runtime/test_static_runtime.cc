@@ -1,9 +1,17 @@
 #include <gtest/gtest.h>
+#include <ATen/Parallel.h>
+#include <torch/csrc/autograd/profiler_legacy.h>
+#include <torch/csrc/jit/ir/irparser.h>
 #include <torch/csrc/jit/runtime/static/fusion.h>
 #include <torch/csrc/jit/runtime/static/impl.h>
 #include "deep_wide_pt.h"
 #include "test_scripts.h"
 
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <unordered_set>
+
 using namespace caffe2;
 using namespace torch;
 using namespace torch::jit;
@@ -51,11 +59,26 @@ void compareTensorLists(
   }
 }
 
+void compareResults(const IValue& expect, const IValue& actual) {
+  if (expect.isTuple()) {
+    compareTensorLists(
+        expect.toTuple()->elements(), actual.toTuple()->elements());
+  } else if (expect.isList()) {
+    compareTensorLists(
+        expect.toTensorVector(), actual.toTensorVector());
+  } else {
+    EXPECT_TRUE(expect.toTensor().equal(actual.toTensor()));
+  }
+}
+
 // Given a model/function in jit script, run the model/function
-// with the jit interpreter and static runtime, and compare the results
+// with the jit interpreter and static runtime, and compare the results.
+// If args2 is given, run both again with args2 to check that the outputs
+// of out variants are correctly reused across runs.
 void testStaticRuntime(
     const std::string& jit_script,
-    const std::vector<IValue>& args) {
+    const std::vector<IValue>& args,
+    const std::vector<IValue>& args2 = {}) {
   script::Module module("module");
   module.define(jit_script);
 
@@ -63,15 +86,12 @@ void testStaticRuntime(
 
   StaticRuntime runtime(module);
   auto actual = runtime.run(args, {});
+  compareResults(expect, actual);
 
-  if (expect.isTuple()) {
-    compareTensorLists(
-        expect.toTuple()->elements(), actual.toTuple()->elements());
-  } else if (expect.isList()) {
-    compareTensorLists(
-        expect.toTensorVector(), actual.toTensorVector());
-  } else {
-    EXPECT_TRUE(expect.toTensor().equal(actual.toTensor()));
+  if (!args2.empty()) {
+    expect = module.forward(args2);
+    actual = runtime.run(args2, {});
+    compareResults(expect, actual);
   }
 }
 } // namespace
@@ -88,6 +108,168 @@ TEST(StaticRuntime, IndividualOps_Binary) {
   testStaticRuntime(tuple_construct_script, args);
 }
 
+TEST(StaticRuntime, IndividualOps_Norm) {
+  auto a = at::randn({2, 3, 4});
+  auto weight = at::randn({4});
+  auto bias = at::randn({4});
+  auto b = at::randn({3, 5, 6});
+  auto weight2 = at::randn({6});
+  auto bias2 = at::randn({6});
+  testStaticRuntime(
+      layer_norm_script, {a, weight, bias}, {b, weight2, bias2});
+}
+
+TEST(StaticRuntime, IndividualOps_Activations) {
+  auto a = at::randn({2, 3, 4});
+  auto b = at::randn({4, 5, 3});
+  for (int64_t dim : {0, -1}) {
+    testStaticRuntime(softmax_script, {a, dim}, {b, dim});
+    testStaticRuntime(log_softmax_script, {a, dim}, {b, dim});
+  }
+  testStaticRuntime(sigmoid_script, {a}, {b});
+  testStaticRuntime(gelu_script, {a}, {b});
+}
+
+TEST(StaticRuntime, IndividualOps_EmbeddingBag) {
+  auto weight = at::randn({10, 4});
+  auto indices = at::tensor({1, 2, 4, 5, 4, 3, 2, 9}, at::kLong);
+  auto offsets = at::tensor({0, 3, 5}, at::kLong);
+  auto indices2 = at::tensor({0, 7, 8}, at::kLong);
+  auto offsets2 = at::tensor({0, 1}, at::kLong);
+  for (int64_t mode : {0, 1, 2}) {
+    testStaticRuntime(
+        embedding_bag_script,
+        {weight, indices, offsets, mode},
+        {weight, indices2, offsets2, mode});
+  }
+}
+
+TEST(StaticRuntime, IndividualOps_Linear) {
+  auto weight = at::randn({5, 4});
+  auto bias = at::randn({5});
+  testStaticRuntime(
+      linear_script,
+      {at::randn({3, 4}), weight, bias},
+      {at::randn({2, 3, 4}), weight, bias});
+  testStaticRuntime(
+      matmul_script,
+      {at::randn({3, 4}), at::randn({4, 5})},
+      {at::randn({2, 3, 4}), at::randn({4, 6})});
+}
+
+TEST(StaticRuntime, IndividualOps_QuantizedLinear) {
+  // The out variant writes into the output with FBGEMM's packed weights.
+  const auto& qengines = at::globalContext().supportedQEngines();
+  if (std::find(qengines.begin(), qengines.end(), at::kFBGEMM) ==
+      qengines.end()) {
+    return;
+  }
+  auto weight = at::randn({5, 4});
+  auto bias = at::randn({5});
+  testStaticRuntime(
+      quantized_linear_script,
+      {at::randn({3, 4}), weight, bias},
+      {at::randn({2, 3, 4}), weight, bias});
+}
+
+TEST(StaticRuntime, IndividualOps_Reductions) {
+  auto a = at::randn({2, 3, 4});
+  auto b = at::randn({4, 3, 2});
+  testStaticRuntime(sum_script, {a}, {b});
+  testStaticRuntime(sum_script, {a.to(at::kInt)}, {b.to(at::kInt)});
+  for (bool keepdim : {false, true}) {
+    std::vector<int64_t> dim{1};
+    testStaticRuntime(sum_dim_script, {a, dim, keepdim}, {b, dim, keepdim});
+    testStaticRuntime(mean_dim_script, {a, dim, keepdim}, {b, dim, keepdim});
+  }
+}
+
+TEST(StaticRuntime, IndividualOps_Indexing) {
+  auto a = at::randn({4, 5});
+  auto b = at::randn({6, 3});
+  auto index = at::tensor({0, 2, 2}, at::kLong);
+  testStaticRuntime(
+      index_select_script, {a, 0, index}, {b, 1, index});
+  auto gather_index = at::randint(0, 4, {4, 5}, at::kLong);
+  auto gather_index2 = at::randint(0, 3, {6, 3}, at::kLong);
+  testStaticRuntime(
+      gather_script, {a, 1, gather_index}, {b, 1, gather_index2});
+  testStaticRuntime(
+      where_script,
+      {a > 0, a, at::zeros({5})},
+      {b > 0, b, at::ones({6, 1})});
+}
+
+TEST(StaticRuntime, IndividualOps_Copies) {
+  auto a = at::randn({3, 4});
+  auto b = at::randn({5, 2, 3});
+  testStaticRuntime(
+      to_dtype_script,
+      {a, static_cast<int64_t>(at::kDouble)},
+      {b, static_cast<int64_t>(at::kDouble)});
+  testStaticRuntime(transpose_contiguous_script, {a}, {b});
+}
+
+TEST(StaticRuntime, IndividualOps_ToSameDtype) {
+  // aten::to returns self when the dtype does not change, which is cheaper
+  // than copying into a managed output.
+  const auto to_ir = R"IR(
+    graph(%a : Float(*, *)):
+      %none : NoneType = prim::Constant()
+      %false : bool = prim::Constant[value=0]()
+      %float : int = prim::Constant[value=6]()
+      %double : int = prim::Constant[value=7]()
+      %b : Tensor = aten::to(%a, %float, %false, %false, %none)
+      %c : Tensor = aten::to(%a, %double, %false, %false, %none)
+      %d : Tensor = aten::mul(%c, %c)
+      %e : (Tensor, Tensor) = prim::TupleConstruct(%b, %d)
+      return (%e)
+  )IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(to_ir, graph.get());
+  StaticRuntime runtime(PrepareForStaticRuntime(graph));
+  for (const ProcessedNode& pnode : runtime.get_nodes()) {
+    if (pnode.get_node()->kind() == c10::aten::to) {
+      const bool converts =
+          pnode.get_node()->input(1)->node()->i(c10::attr::value) ==
+          static_cast<int64_t>(at::kDouble);
+      EXPECT_EQ(pnode.has_out_variant(), converts);
+    }
+  }
+
+  auto a = at::randn({3, 4});
+  auto outputs = runtime.run({a}, {}).toTuple()->elements();
+  EXPECT_TRUE(outputs[0].toTensor().is_same(a));
+  auto c = a.to(at::kDouble);
+  EXPECT_TRUE(outputs[1].toTensor().equal(c * c));
+}
+
+TEST(StaticRuntime, ControlFlow) {
+  auto a = at::randn({2, 3});
+  auto b = at::randn({2, 3});
+  auto c = at::randn({4, 5});
+  auto d = at::randn({4, 5});
+
+  testStaticRuntime(if_script, {a, b, true}, {c, d, false});
+  testStaticRuntime(loop_script, {a, b, 3}, {c, d, 0});
+  testStaticRuntime(while_loop_script, {a, b}, {c, d});
+  testStaticRuntime(loop_if_script, {a, b, 5}, {c, d, 2});
+}
+
+TEST(StaticRuntime, OutputsNotReused) {
+  script::Module module("module");
+  module.define(add_script);
+  StaticRuntime runtime(module);
+
+  auto a = at::randn({2, 3});
+  auto b = at::randn({2, 3});
+  auto output_1 = runtime.run({a, b}, {}).toTensor();
+  auto expect = output_1.clone();
+  // the next run must not write into the tensor returned by the first one
+  runtime.run({a * 2, b}, {});
+  EXPECT_TRUE(output_1.equal(expect));
+}
+
 TEST(StaticRuntime, LongModel) {
   torch::jit::Module mod = getLongScriptModel();
   auto a = torch::randn({2, 2});
@@ -251,6 +433,255 @@ TEST(StaticRuntime, CleanUpMemory) {
   }
 }
 
+// Number of allocations made by the nodes whose outputs are all managed by the
+// memory planner, i.e. nodes with out variants that don't produce the model
+// outputs, in the runs sampled since the last reset_metrics().
+static uint64_t numManagedNodeAllocations(
+    torch::jit::StaticRuntime& runtime) {
+  const auto& graph = runtime.get_inference_module()->graph;
+  std::unordered_set<const torch::jit::Value*> model_outputs;
+  for (const torch::jit::Value* output : graph->outputs()) {
+    model_outputs.insert(output);
+    if (output->node()->kind() == c10::prim::TupleConstruct ||
+        output->node()->kind() == c10::prim::ListConstruct) {
+      for (const torch::jit::Value* input : output->node()->inputs()) {
+        model_outputs.insert(input);
+      }
+    }
+  }
+
+  auto metrics = runtime.get_metrics();
+  const auto& nodes = runtime.get_nodes();
+  EXPECT_EQ(metrics.nodes.size(), nodes.size());
+  uint64_t num_allocations = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (!nodes[i].has_out_variant()) {
+      continue;
+    }
+    const auto& outputs = nodes[i].get_node()->outputs();
+    auto is_model_output = [&](const torch::jit::Value* v) {
+      return model_outputs.count(v) > 0;
+    };
+    if (std::none_of(outputs.begin(), outputs.end(), is_model_output)) {
+      num_allocations += metrics.nodes[i].num_allocations;
+    }
+  }
+  return num_allocations;
+}
+
+TEST(StaticRuntime, AheadOfTimeMemoryPlan) {
+  const int embedding_size = 32;
+  const int num_features = 50;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+  auto g = torch::jit::PrepareForStaticRuntime(mod);
+  torch::jit::StaticRuntimeOptions opts;
+  opts.metrics_sampling_period = 1;
+  torch::jit::StaticRuntime runtime(g, opts);
+  torch::jit::StaticRuntime profiled_runtime(g, opts);
+
+  std::vector<std::vector<IValue>> buckets;
+  for (int batch_size : {1, 8, 32}) {
+    buckets.push_back({torch::empty({batch_size, 1, embedding_size}),
+                       torch::empty({batch_size, 1, embedding_size}),
+                       torch::empty({batch_size, num_features})});
+  }
+  runtime.plan_memory(buckets);
+
+  size_t managed_bytes = 0;
+  bool first_run = true;
+  for (int batch_size : {32, 8, 1}) {
+    for (int i = 0; i < 2; ++i) {
+      auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+      auto user_emb = torch::randn({batch_size, 1, embedding_size});
+      auto wide = torch::randn({batch_size, num_features});
+
+      // run jit graph executor
+      std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+      auto output_1 = getTensor(mod.forward(inputs));
+
+      // run static runtime
+      std::vector<at::Tensor> input_tensors({ad_emb_packed, user_emb, wide});
+      runtime.reset_metrics();
+      at::Tensor output_2 = runtime.run(input_tensors)[0];
+      EXPECT_TRUE(output_1.equal(output_2));
+
+      // The managed tensors live in the planned arena from the first run on,
+      // and the arena is big enough for every bucket.
+      EXPECT_EQ(numManagedNodeAllocations(runtime), 0);
+      auto metrics = runtime.get_metrics();
+      EXPECT_GT(metrics.managed_bytes, 0);
+      if (first_run) {
+        managed_bytes = metrics.managed_bytes;
+      }
+      EXPECT_EQ(metrics.managed_bytes, managed_bytes);
+
+      // Without a plan, the first run allocates the managed tensors one by
+      // one to profile their sizes.
+      profiled_runtime.reset_metrics();
+      at::Tensor output_3 = profiled_runtime.run(input_tensors)[0];
+      EXPECT_TRUE(output_1.equal(output_3));
+      if (first_run) {
+        EXPECT_GT(numManagedNodeAllocations(profiled_runtime), 0);
+      }
+      first_run = false;
+    }
+  }
+}
+
+TEST(StaticRuntime, InterOpParallelism) {
+  const int embedding_size = 32;
+  const int num_features = 50;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+  auto g = torch::jit::PrepareForStaticRuntime(mod);
+  torch::jit::StaticRuntimeOptions opts;
+  opts.enable_inter_op_parallelism = true;
+  torch::jit::StaticRuntime runtime(g, opts);
+
+  for (int batch_size : {1, 8, 32}) {
+    for (int i = 0; i < 2; ++i) {
+      auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+      auto user_emb = torch::randn({batch_size, 1, embedding_size});
+      auto wide = torch::randn({batch_size, num_features});
+
+      // run jit graph executor
+      std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+      auto output_1 = getTensor(mod.forward(inputs));
+
+      // run static runtime
+      std::vector<at::Tensor> input_tensors({ad_emb_packed, user_emb, wide});
+      at::Tensor output_2 = runtime.run(input_tensors)[0];
+      EXPECT_TRUE(output_1.equal(output_2));
+    }
+  }
+}
+
+TEST(StaticRuntime, InterOpParallelismFromInterOpPool) {
+  // Every thread of the inter-op pool runs the model, so the nodes queued on
+  // the pool can only be run by the threads calling run().
+  const int embedding_size = 32;
+  const int num_features = 50;
+  const int batch_size = 8;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+  auto g = torch::jit::PrepareForStaticRuntime(mod);
+  torch::jit::StaticRuntimeOptions opts;
+  opts.enable_inter_op_parallelism = true;
+
+  auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+  auto user_emb = torch::randn({batch_size, 1, embedding_size});
+  auto wide = torch::randn({batch_size, num_features});
+  std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+  auto expected = getTensor(mod.forward(inputs));
+
+  const int num_threads = at::get_num_interop_threads();
+  std::vector<std::unique_ptr<torch::jit::StaticRuntime>> runtimes;
+  std::vector<std::promise<at::Tensor>> outputs(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    runtimes.emplace_back(
+        std::make_unique<torch::jit::StaticRuntime>(g, opts));
+  }
+  std::atomic<int> num_started{0};
+  for (int i = 0; i < num_threads; ++i) {
+    at::launch([&, i]() {
+      num_started++;
+      while (num_started.load() < num_threads) {
+        std::this_thread::yield();
+      }
+      try {
+        outputs[i].set_value(
+            runtimes[i]->run({ad_emb_packed, user_emb, wide})[0]);
+      } catch (...) {
+        outputs[i].set_exception(std::current_exception());
+      }
+    });
+  }
+  for (auto& output : outputs) {
+    EXPECT_TRUE(expected.equal(output.get_future().get()));
+  }
+}
+
+TEST(StaticRuntime, LiveMetrics) {
+  torch::jit::LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0);
+  for (uint64_t nanos = 1; nanos <= 100; ++nanos) {
+    histogram.record(nanos * 1000);
+  }
+  EXPECT_EQ(histogram.count(), 100);
+  // percentiles are accurate to within one bucket
+  EXPECT_GE(histogram.percentile(50), 50000);
+  EXPECT_LE(histogram.percentile(50), 50000 * 1.25);
+  EXPECT_GE(histogram.percentile(99), 99000);
+  EXPECT_LE(histogram.percentile(99), 99000 * 1.25);
+
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+  torch::jit::StaticRuntimeOptions opts;
+  opts.metrics_sampling_period = 2;
+  torch::jit::StaticRuntime runtime(mod, opts);
+
+  auto ad_emb_packed = torch::randn({1, 1, 32});
+  auto user_emb = torch::randn({1, 1, 32});
+  auto wide = torch::randn({1, 50});
+  std::vector<at::Tensor> inputs({ad_emb_packed, user_emb, wide});
+  for (int i = 0; i < 10; ++i) {
+    runtime.run(inputs);
+  }
+
+  auto metrics = runtime.get_metrics();
+  EXPECT_EQ(metrics.num_runs, 10);
+  EXPECT_EQ(metrics.num_sampled_runs, 5);
+  EXPECT_GE(metrics.p99_ms, metrics.p50_ms);
+  EXPECT_GT(metrics.managed_bytes, 0);
+  EXPECT_EQ(metrics.nodes.size(), runtime.get_nodes().size());
+  size_t num_fallback_nodes = 0;
+  for (const auto& node : metrics.nodes) {
+    EXPECT_EQ(node.num_samples, 5);
+    EXPECT_GE(node.p99_ms, node.p50_ms);
+    num_fallback_nodes += node.is_fallback;
+  }
+  EXPECT_EQ(metrics.num_fallback_nodes, num_fallback_nodes);
+
+  runtime.reset_metrics();
+  EXPECT_EQ(runtime.get_metrics().num_sampled_runs, 0);
+}
+
+TEST(StaticRuntime, MetricsWithMemoryProfiler) {
+  // Allocations are counted for the metrics and reported to the profiler at
+  // the same time.
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+  torch::jit::StaticRuntimeOptions opts;
+  opts.metrics_sampling_period = 1;
+  torch::jit::StaticRuntime runtime(mod, opts);
+
+  auto ad_emb_packed = torch::randn({1, 1, 32});
+  auto user_emb = torch::randn({1, 1, 32});
+  auto wide = torch::randn({1, 50});
+  std::vector<at::Tensor> inputs({ad_emb_packed, user_emb, wide});
+
+  namespace profiler = torch::autograd::profiler;
+  profiler::enableProfilerLegacy(profiler::ProfilerConfig(
+      profiler::ProfilerState::CPU,
+      /*report_input_shapes=*/false,
+      /*profile_memory=*/true));
+  for (int i = 0; i < 3; ++i) {
+    runtime.run(inputs);
+  }
+  EXPECT_TRUE(profiler::profilerEnabled());
+  auto event_lists = profiler::disableProfilerLegacy();
+
+  size_t num_memory_events = 0;
+  for (const auto& events : event_lists) {
+    for (const auto& event : events) {
+      num_memory_events += event.kindStr() == "memory_alloc";
+    }
+  }
+  EXPECT_GT(num_memory_events, 0);
+
+  uint64_t num_allocations = 0;
+  for (const auto& node : runtime.get_metrics().nodes) {
+    num_allocations += node.num_allocations;
+  }
+  EXPECT_GT(num_allocations, 0);
+}
+
 TEST(StaticRuntime, FusionPass) {
   const int embedding_size = 32;
   const int num_features = 50;
@@ -5,6 +5,7 @@ import os
 from . import tensor_engine
 
 from . import attention      # noqa: F401
+from . import auto_schedule  # noqa: F401
 from . import broadcast      # noqa: F401
 # from . import conv           # noqa: F401
 from . import elementwise    # noqa: F401
@@ -0,0 +1,76 @@
+from . import benchmark
+import torch
+
+
+class AutoScheduleBench(benchmark.Benchmark):
+    '''
+    Compares the loop schedules picked for CPU kernels by the TensorExpr
+    AutoScheduler with the default ones. `schedule` is the auto schedule mode:
+    0 for the default schedule, 1 for the cost model and 2 for measured
+    autotuning.
+    '''
+    def __init__(self, mode, device, dtype, case, schedule, M, N):
+        super().__init__(mode, device, dtype)
+        self.case = case
+        self.schedule = schedule
+        self.M = M
+        self.N = N
+
+        x = self.randn([M, N], device=device, dtype=dtype, requires_grad=self.requires_grad)
+        if case == "transpose":
+            y = self.randn([N, M], device=device, dtype=dtype, requires_grad=self.requires_grad)
+            self.inputs = [x, y.t()]
+        elif case in ["rowsum", "colsum"]:
+            self.inputs = [x]
+        else:
+            raise ValueError("invalid case: %s" % case)
+
+    def forward(self, x, y=None):
+        if self.case == "transpose":
+            return self.mul(self.add(x, y), 2.0)
+        return self.sum(self.mul(x, 2.0), [1] if self.case == "rowsum" else [0])
+
+    def config(self):
+        return [self.case, self.schedule, self.M, self.N]
+
+    @staticmethod
+    def module():
+        return "auto_schedule"
+
+    def is_supported(self):
+        return self.mode == "fwd" and self.device == "cpu"
+
+    def memory_workload(self):
+        buffer_size = self.M * self.N
+        if self.case == "transpose":
+            count = 3
+        else:
+            count = 1
+        return {
+            "sol": buffer_size * count,
+            "algorithmic": buffer_size * count,
+        }
+
+    @staticmethod
+    def default_configs():
+        configs = []
+        for schedule in [0, 1, 2]:
+            configs += [
+                ["transpose", schedule, 2048, 2048],
+                ["rowsum", schedule, 4096, 1024],
+                ["colsum", schedule, 4096, 1024],
+            ]
+        return configs
+
+    def run(self, args):
+        old_mode = torch._C._jit_get_te_auto_schedule_mode()
+        old_reductions = torch._C._jit_set_texpr_reductions_enabled(True)
+        torch._C._jit_set_te_auto_schedule_mode(self.schedule)
+        try:
+            return super().run(args)
+        finally:
+            torch._C._jit_set_te_auto_schedule_mode(old_mode)
+            torch._C._jit_set_texpr_reductions_enabled(old_reductions)
+
+
+benchmark.register_benchmark_class(AutoScheduleBench)
@@ -0,0 +1,107 @@
+#include <c10/core/thread_pool.h>
+#include <c10/core/work_stealing_thread_pool.h>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+
+using c10::ThreadPool;
+using c10::WorkStealingThreadPool;
+
+namespace {
+
+void waitFor(const std::atomic<int64_t>& remaining) {
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+}
+
+// Tasks per second when submitting many small tasks from outside the pool.
+// Arguments: number of threads in the pool, number of tasks per iteration.
+template <typename Pool>
+static void BM_TaskThroughput(benchmark::State& state) {
+  Pool pool(state.range(0));
+  const int64_t num_tasks = state.range(1);
+  std::atomic<int64_t> remaining{0};
+  while (state.KeepRunning()) {
+    remaining.store(num_tasks, std::memory_order_relaxed);
+    for (int64_t i = 0; i < num_tasks; ++i) {
+      pool.run([&remaining]() {
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    waitFor(remaining);
+  }
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+BENCHMARK_TEMPLATE(BM_TaskThroughput, ThreadPool)
+    ->Args({4, 10000})
+    ->Args({16, 10000})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TaskThroughput, WorkStealingThreadPool)
+    ->Args({4, 10000})
+    ->Args({16, 10000})
+    ->UseRealTime();
+
+// Latency of one fork-join, as done by at::parallel_for: fork one task per
+// pool thread and wait for all of them.
+// Argument: number of threads in the pool.
+template <typename Pool>
+static void BM_ForkJoinLatency(benchmark::State& state) {
+  const int64_t num_threads = state.range(0);
+  Pool pool(num_threads);
+  std::atomic<int64_t> remaining{0};
+  while (state.KeepRunning()) {
+    remaining.store(num_threads, std::memory_order_relaxed);
+    for (int64_t i = 0; i < num_threads; ++i) {
+      pool.run([&remaining]() {
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    waitFor(remaining);
+  }
+}
+BENCHMARK_TEMPLATE(BM_ForkJoinLatency, ThreadPool)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ForkJoinLatency, WorkStealingThreadPool)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+// Recursive fork-join from inside the pool, e.g. nested parallel regions.
+// Argument: number of threads in the pool.
+template <typename Pool>
+static void BM_NestedTasks(benchmark::State& state) {
+  Pool pool(state.range(0));
+  constexpr int64_t kFanOut = 64;
+  std::atomic<int64_t> remaining{0};
+  while (state.KeepRunning()) {
+    remaining.store(kFanOut * (kFanOut + 1), std::memory_order_relaxed);
+    for (int64_t i = 0; i < kFanOut; ++i) {
+      pool.run([&pool, &remaining]() {
+        for (int64_t j = 0; j < kFanOut; ++j) {
+          pool.run([&remaining]() {
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+          });
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    waitFor(remaining);
+  }
+  state.SetItemsProcessed(state.iterations() * kFanOut * (kFanOut + 1));
+}
+BENCHMARK_TEMPLATE(BM_NestedTasks, ThreadPool)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_NestedTasks, WorkStealingThreadPool)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -232,6 +232,8 @@ struct C10_API MemoryReportingInfoBase : public c10::DebugInfoBase {
   virtual bool memoryProfilingEnabled() const = 0;
 };
 
+// Memory usage is reported to the profiler (DebugInfoKind::PROFILER_STATE),
+// and to the reporter in DebugInfoKind::MEMORY_REPORTER, if any
 C10_API bool memoryProfilingEnabled();
 C10_API void reportMemoryUsageToProfiler(void* ptr, int64_t alloc_size, Device device);
 
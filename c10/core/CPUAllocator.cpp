@@ -75,7 +75,11 @@ void* alloc_cpu(size_t nbytes) {
       " bytes. Buy new RAM!");
 
   // move data to a thread's NUMA node
-  NUMAMove(data, nbytes, GetCurrentNUMANode());
+  if (FLAGS_caffe2_cpu_numa_first_touch) {
+    NUMAFirstTouch(data, nbytes);
+  } else {
+    NUMAMove(data, nbytes, GetCurrentNUMANode());
+  }
   CHECK(
       !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
       !FLAGS_caffe2_cpu_allocator_do_junk_fill)
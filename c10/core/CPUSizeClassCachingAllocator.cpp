@@ -0,0 +1,430 @@
+#include <c10/core/CPUSizeClassCachingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/llvmMathExtras.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace c10 {
+namespace CPUSizeClassCachingAllocator {
+
+namespace {
+
+constexpr size_t kMinSizeClassShift = 6; // 64 bytes
+constexpr size_t kMaxSizeClassShift = 25; // 32MB
+constexpr size_t kNumSizeClasses = kMaxSizeClassShift - kMinSizeClassShift + 1;
+constexpr int kOversize = -1;
+
+// A thread caches at most this many bytes and blocks of every size class
+constexpr size_t kThreadCacheClassBytes = 2 << 20;
+constexpr size_t kMaxThreadCacheBlocks = 64;
+
+// Every block starts with a header, padded to gAlignment so that the data
+// stays aligned. It lets free find the size class from the data pointer
+// alone, which must also be the context of the DataPtr (see raw_allocate).
+struct BlockHeader {
+  size_t bytes;
+  int size_class;
+};
+static_assert(sizeof(BlockHeader) <= gAlignment, "BlockHeader too large");
+
+BlockHeader* header(void* data) {
+  return reinterpret_cast<BlockHeader*>(static_cast<char*>(data) - gAlignment);
+}
+
+int size_class(size_t nbytes) {
+  if (nbytes > (size_t(1) << kMaxSizeClassShift)) {
+    return kOversize;
+  }
+  if (nbytes <= (size_t(1) << kMinSizeClassShift)) {
+    return 0;
+  }
+  return llvm::Log2_64_Ceil(nbytes) - kMinSizeClassShift;
+}
+
+size_t class_bytes(int size_class) {
+  return size_t(1) << (size_class + kMinSizeClassShift);
+}
+
+size_t thread_cache_limit(int size_class) {
+  return std::max<size_t>(
+      1,
+      std::min(
+          kMaxThreadCacheBlocks,
+          kThreadCacheClassBytes / class_bytes(size_class)));
+}
+
+// Number of blocks moved at once between a thread cache and the central pool
+size_t batch_size(int size_class) {
+  return std::max<size_t>(1, thread_cache_limit(size_class) / 2);
+}
+
+// Counters of a thread. Only the owning thread writes them, so they are
+// updated with a plain load and store rather than a locked read-modify-write;
+// getStats() may read them from any thread.
+struct Counters {
+  std::atomic<int64_t> cache_hits{0};
+  std::atomic<int64_t> cache_misses{0};
+  std::atomic<int64_t> oversize_allocations{0};
+  std::atomic<int64_t> allocated_bytes{0};
+  std::atomic<int64_t> cached_bytes{0};
+};
+
+void bump(std::atomic<int64_t>& counter, int64_t delta) {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + delta,
+      std::memory_order_relaxed);
+}
+
+struct ThreadCache;
+
+struct CentralPool {
+  struct Bin {
+    std::mutex mutex;
+    std::vector<void*> blocks;
+  };
+  std::array<Bin, kNumSizeClasses> bins;
+  std::atomic<int64_t> cached_bytes{0};
+
+  std::atomic<int64_t> reserved_bytes{0};
+  std::atomic<int64_t> peak_reserved_bytes{0};
+
+  // Incremented by emptyCache(); a thread cache that sees a new value drops
+  // its blocks
+  std::atomic<uint64_t> trim_epoch{0};
+
+  // Live thread caches, and the counters of the threads that have exited or
+  // freed after their cache was destroyed
+  std::mutex threads_mutex;
+  std::vector<ThreadCache*> threads;
+  Stats retired;
+  // Subtracted from the counts by getStats(), see resetAccumulatedStats()
+  Stats baseline;
+};
+
+// Leaked, so that threads exiting during static destruction can still
+// return their blocks
+CentralPool& central() {
+  static CentralPool* pool = new CentralPool();
+  return *pool;
+}
+
+void* new_block(size_t bytes, int size_class) {
+  void* block = alloc_cpu(gAlignment + bytes);
+  auto* h = static_cast<BlockHeader*>(block);
+  h->bytes = bytes;
+  h->size_class = size_class;
+
+  CentralPool& pool = central();
+  const int64_t reserved =
+      pool.reserved_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64_t peak = pool.peak_reserved_bytes.load(std::memory_order_relaxed);
+  while (reserved > peak &&
+         !pool.peak_reserved_bytes.compare_exchange_weak(
+             peak, reserved, std::memory_order_relaxed)) {
+  }
+  return static_cast<char*>(block) + gAlignment;
+}
+
+void delete_block(void* data) {
+  BlockHeader* h = header(data);
+  central().reserved_bytes.fetch_sub(h->bytes, std::memory_order_relaxed);
+  free_cpu(h);
+}
+
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCache {
+  ThreadCache() {
+    CentralPool& pool = central();
+    trim_epoch = pool.trim_epoch.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(pool.threads_mutex);
+    pool.threads.push_back(this);
+  }
+
+  // Hands the cached blocks over to the central pool, where other threads
+  // can reuse them
+  ~ThreadCache() {
+    CentralPool& pool = central();
+    for (size_t c = 0; c < kNumSizeClasses; ++c) {
+      flush(c, bins[c].size());
+    }
+    std::lock_guard<std::mutex> guard(pool.threads_mutex);
+    pool.threads.erase(
+        std::find(pool.threads.begin(), pool.threads.end(), this));
+    pool.retired.cache_hits += counters.cache_hits.load();
+    pool.retired.cache_misses += counters.cache_misses.load();
+    pool.retired.oversize_allocations += counters.oversize_allocations.load();
+    pool.retired.allocated_bytes += counters.allocated_bytes.load();
+    tls_cache_destroyed = true;
+  }
+
+  void* allocate(int c) {
+    maybe_trim();
+    auto& bin = bins[c];
+    if (bin.empty()) {
+      refill(c);
+    }
+    const int64_t bytes = class_bytes(c);
+    bump(counters.allocated_bytes, bytes);
+    if (!bin.empty()) {
+      void* data = bin.back();
+      bin.pop_back();
+      bump(counters.cache_hits, 1);
+      bump(counters.cached_bytes, -bytes);
+      return data;
+    }
+    bump(counters.cache_misses, 1);
+    return new_block(bytes, c);
+  }
+
+  void free(void* data, int c) {
+    maybe_trim();
+    auto& bin = bins[c];
+    bin.push_back(data);
+    const int64_t bytes = class_bytes(c);
+    bump(counters.allocated_bytes, -bytes);
+    bump(counters.cached_bytes, bytes);
+    if (bin.size() > thread_cache_limit(c)) {
+      flush(c, batch_size(c));
+    }
+  }
+
+  // Moves up to a batch of blocks from the central pool
+  void refill(int c) {
+    CentralPool::Bin& central_bin = central().bins[c];
+    auto& bin = bins[c];
+    {
+      std::lock_guard<std::mutex> guard(central_bin.mutex);
+      const size_t n = std::min(batch_size(c), central_bin.blocks.size());
+      bin.insert(
+          bin.end(), central_bin.blocks.end() - n, central_bin.blocks.end());
+      central_bin.blocks.resize(central_bin.blocks.size() - n);
+    }
+    const int64_t bytes = bin.size() * class_bytes(c);
+    central().cached_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    bump(counters.cached_bytes, bytes);
+  }
+
+  // Moves the n least recently freed blocks to the central pool
+  void flush(int c, size_t n) {
+    if (n == 0) {
+      return;
+    }
+    CentralPool::Bin& central_bin = central().bins[c];
+    auto& bin = bins[c];
+    {
+      std::lock_guard<std::mutex> guard(central_bin.mutex);
+      central_bin.blocks.insert(
+          central_bin.blocks.end(), bin.begin(), bin.begin() + n);
+    }
+    bin.erase(bin.begin(), bin.begin() + n);
+    const int64_t bytes = n * class_bytes(c);
+    central().cached_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    bump(counters.cached_bytes, -bytes);
+  }
+
+  void trim() {
+    for (size_t c = 0; c < kNumSizeClasses; ++c) {
+      for (void* data : bins[c]) {
+        delete_block(data);
+      }
+      bump(counters.cached_bytes, -int64_t(bins[c].size() * class_bytes(c)));
+      bins[c].clear();
+    }
+    trim_epoch = central().trim_epoch.load(std::memory_order_relaxed);
+  }
+
+  void maybe_trim() {
+    if (C10_UNLIKELY(
+            central().trim_epoch.load(std::memory_order_relaxed) !=
+            trim_epoch)) {
+      trim();
+    }
+  }
+
+  std::array<std::vector<void*>, kNumSizeClasses> bins;
+  Counters counters;
+  uint64_t trim_epoch;
+};
+
+// nullptr once the cache of the calling thread has been destroyed, e.g. when
+// a tensor is freed by the destructor of another thread_local
+ThreadCache* thread_cache() {
+  if (C10_UNLIKELY(tls_cache_destroyed)) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void* allocate_block(size_t nbytes) {
+  const int c = size_class(nbytes);
+  ThreadCache* cache = thread_cache();
+  if (c != kOversize && cache) {
+    return cache->allocate(c);
+  }
+  const size_t bytes = c == kOversize ? nbytes : class_bytes(c);
+  if (cache) {
+    bump(cache->counters.oversize_allocations, 1);
+    bump(cache->counters.allocated_bytes, bytes);
+  } else {
+    CentralPool& pool = central();
+    std::lock_guard<std::mutex> guard(pool.threads_mutex);
+    (c == kOversize ? pool.retired.oversize_allocations
+                    : pool.retired.cache_misses) += 1;
+    pool.retired.allocated_bytes += bytes;
+  }
+  return new_block(bytes, c);
+}
+
+void free_block(void* data) {
+  BlockHeader* h = header(data);
+  const int c = h->size_class;
+  ThreadCache* cache = thread_cache();
+  if (c != kOversize && cache) {
+    cache->free(data, c);
+    return;
+  }
+  if (cache) {
+    bump(cache->counters.allocated_bytes, -int64_t(h->bytes));
+  } else {
+    CentralPool& pool = central();
+    std::lock_guard<std::mutex> guard(pool.threads_mutex);
+    pool.retired.allocated_bytes -= h->bytes;
+  }
+  if (c == kOversize) {
+    delete_block(data);
+    return;
+  }
+  CentralPool::Bin& central_bin = central().bins[c];
+  {
+    std::lock_guard<std::mutex> guard(central_bin.mutex);
+    central_bin.blocks.push_back(data);
+  }
+  central().cached_bytes.fetch_add(h->bytes, std::memory_order_relaxed);
+}
+
+struct SizeClassCachingCPUAllocator final : public Allocator {
+  DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &ReportAndDelete, Device(DeviceType::CPU)};
+    }
+    void* data = allocate_block(nbytes);
+    // alloc_cpu only fills new blocks
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      memset(data, 0, nbytes);
+    } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+      memset_junk(data, nbytes);
+    }
+    profiledCPUMemoryReporter().New(data, nbytes);
+    return {data, data, &ReportAndDelete, Device(DeviceType::CPU)};
+  }
+
+  static void ReportAndDelete(void* ptr) {
+    if (!ptr) {
+      return;
+    }
+    profiledCPUMemoryReporter().Delete(ptr);
+    free_block(ptr);
+  }
+
+  DeleterFnPtr raw_deleter() const override {
+    return &ReportAndDelete;
+  }
+};
+
+#ifndef C10_MOBILE
+// TORCH_CPU_CACHING_ALLOCATOR=1 installs the allocator at startup, with a
+// higher priority than the default CPU allocator
+struct EnvRegisterer {
+  EnvRegisterer() {
+    const char* value = std::getenv("TORCH_CPU_CACHING_ALLOCATOR");
+    if (value && std::strcmp(value, "1") == 0) {
+      SetAllocator(DeviceType::CPU, get(), /* priority */ 1);
+    }
+  }
+};
+static EnvRegisterer g_env_registerer;
+#endif // C10_MOBILE
+
+} // namespace
+
+Allocator* get() {
+  static SizeClassCachingCPUAllocator allocator;
+  return &allocator;
+}
+
+size_t sizeClassBytes(size_t nbytes) {
+  const int c = size_class(nbytes);
+  return c == kOversize ? 0 : class_bytes(c);
+}
+
+void emptyCache() {
+  CentralPool& pool = central();
+  pool.trim_epoch.fetch_add(1, std::memory_order_relaxed);
+  if (ThreadCache* cache = thread_cache()) {
+    cache->trim();
+  }
+  for (auto& bin : pool.bins) {
+    std::vector<void*> blocks;
+    {
+      std::lock_guard<std::mutex> guard(bin.mutex);
+      blocks.swap(bin.blocks);
+    }
+    for (void* data : blocks) {
+      pool.cached_bytes.fetch_sub(
+          header(data)->bytes, std::memory_order_relaxed);
+      delete_block(data);
+    }
+  }
+}
+
+Stats getStats() {
+  CentralPool& pool = central();
+  std::lock_guard<std::mutex> guard(pool.threads_mutex);
+  Stats stats = pool.retired;
+  for (const ThreadCache* cache : pool.threads) {
+    const Counters& counters = cache->counters;
+    stats.cache_hits += counters.cache_hits.load(std::memory_order_relaxed);
+    stats.cache_misses += counters.cache_misses.load(std::memory_order_relaxed);
+    stats.oversize_allocations +=
+        counters.oversize_allocations.load(std::memory_order_relaxed);
+    stats.allocated_bytes +=
+        counters.allocated_bytes.load(std::memory_order_relaxed);
+    stats.cached_bytes += counters.cached_bytes.load(std::memory_order_relaxed);
+  }
+  stats.cache_hits -= pool.baseline.cache_hits;
+  stats.cache_misses -= pool.baseline.cache_misses;
+  stats.oversize_allocations -= pool.baseline.oversize_allocations;
+  stats.cached_bytes += pool.cached_bytes.load(std::memory_order_relaxed);
+  stats.reserved_bytes = pool.reserved_bytes.load(std::memory_order_relaxed);
+  stats.peak_reserved_bytes =
+      pool.peak_reserved_bytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void resetAccumulatedStats() {
+  const Stats stats = getStats();
+  CentralPool& pool = central();
+  std::lock_guard<std::mutex> guard(pool.threads_mutex);
+  pool.baseline.cache_hits += stats.cache_hits;
+  pool.baseline.cache_misses += stats.cache_misses;
+  pool.baseline.oversize_allocations += stats.oversize_allocations;
+}
+
+void resetPeakStats() {
+  CentralPool& pool = central();
+  pool.peak_reserved_bytes.store(
+      pool.reserved_bytes.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+}
+
+} // namespace CPUSizeClassCachingAllocator
+} // namespace c10
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+
+/*
+ * CPU caching allocator for server builds.
+ *
+ * Requests are rounded up to a power of two size class between 64 bytes and
+ * 32MB; larger requests go straight to alloc_cpu/free_cpu. Freed blocks are
+ * kept in a cache of the freeing thread, which needs no locking. When a
+ * thread cache holds too many blocks of a class, half of them are moved to a
+ * central pool with one lock, and a thread that misses in its own cache
+ * refills it from the central pool the same way. Memory is only returned to
+ * the system by emptyCache().
+ *
+ * Usage:
+ *   c10::SetCPUAllocator(c10::CPUSizeClassCachingAllocator::get(), 1);
+ * or set TORCH_CPU_CACHING_ALLOCATOR=1 in the environment to install it at
+ * startup.
+ */
+
+namespace c10 {
+namespace CPUSizeClassCachingAllocator {
+
+// Struct containing the allocator summary statistics, summed over all
+// threads.
+struct Stats {
+  // COUNT: allocations served from a thread cache or the central pool
+  int64_t cache_hits = 0;
+  // COUNT: allocations that needed a new block from alloc_cpu
+  int64_t cache_misses = 0;
+  // COUNT: allocations larger than the largest size class, not cached
+  int64_t oversize_allocations = 0;
+
+  // SUM: bytes of the blocks in use, rounded up to their size class
+  int64_t allocated_bytes = 0;
+  // SUM: bytes of the free blocks held by the thread caches and central pool
+  int64_t cached_bytes = 0;
+  // SUM: bytes obtained from alloc_cpu and not yet returned
+  int64_t reserved_bytes = 0;
+  int64_t peak_reserved_bytes = 0;
+};
+
+C10_API Allocator* get();
+
+// Size of the blocks serving a request of nbytes, 0 if it is not cached
+C10_API size_t sizeClassBytes(size_t nbytes);
+
+// Returns the blocks cached by the central pool and the calling thread to the
+// system. Other threads drop their caches the next time they allocate or
+// free through this allocator.
+C10_API void emptyCache();
+
+C10_API Stats getStats();
+C10_API void resetAccumulatedStats();
+C10_API void resetPeakStats();
+
+} // namespace CPUSizeClassCachingAllocator
+} // namespace c10
@@ -0,0 +1,477 @@
+#include <c10/core/work_stealing_thread_pool.h>
+
+#include <c10/util/Logging.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#define C10_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define C10_CPU_RELAX() asm volatile("yield" ::: "memory")
+#else
+#define C10_CPU_RELAX()
+#endif
+
+namespace c10 {
+
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kInboxCapacity = 1024;
+constexpr int64_t kInitialDequeCapacity = 256;
+// Rounds of looking for a task before parking. Each round scans all the
+// workers, so this is in the order of tens of microseconds.
+constexpr int kSpinRounds = 256;
+// After this many rounds, spinning workers yield their core between rounds
+constexpr int kYieldAfterRounds = 64;
+
+// The pool and the index of the worker running on the current thread
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+// Chase-Lev work-stealing deque, following "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013). Only the
+// owner pushes and pops at the bottom; any thread may steal from the top.
+template <typename T>
+class ChaseLevDeque {
+ public:
+  ChaseLevDeque() {
+    arrays_.emplace_back(new Array(kInitialDequeCapacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  void push(T x) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = grow(a, b, t);
+    }
+    a->put(b, x);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  T pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T x = a->get(b);
+    if (t == b) {
+      // last element, race against the thieves
+      if (!top_.compare_exchange_strong(
+              t,
+              t + 1,
+              std::memory_order_seq_cst,
+              std::memory_order_relaxed)) {
+        x = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  // May spuriously return nullptr when racing with another thief
+  T steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    Array* a = array_.load(std::memory_order_acquire);
+    T x = a->get(t);
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return x;
+  }
+
+  bool empty() const {
+    int64_t t = top_.load(std::memory_order_relaxed);
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    return b <= t;
+  }
+
+ private:
+  struct Array {
+    explicit Array(int64_t capacity)
+        : capacity(capacity), buffer(new std::atomic<T>[capacity]) {}
+
+    T get(int64_t i) const {
+      return buffer[i & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, T x) {
+      buffer[i & (capacity - 1)].store(x, std::memory_order_relaxed);
+    }
+
+    const int64_t capacity;
+    std::unique_ptr<std::atomic<T>[]> buffer;
+  };
+
+  Array* grow(Array* a, int64_t b, int64_t t) {
+    auto* bigger = new Array(a->capacity * 2);
+    for (int64_t i = t; i < b; ++i) {
+      bigger->put(i, a->get(i));
+    }
+    // thieves may still be reading the old array, so it is only freed
+    // together with the deque
+    arrays_.emplace_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  std::atomic<int64_t> top_{0};
+  char pad_[kCacheLineSize];
+  std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_{nullptr};
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+// Bounded multi-producer multi-consumer queue (D. Vyukov). Every cell
+// carries a sequence number telling producers and consumers whose turn it
+// is, so that push and pop only need one CAS each.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity)
+      : mask_(capacity - 1), cells_(new Cell[capacity]) {
+    TORCH_INTERNAL_ASSERT((capacity & mask_) == 0);
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool push(T x) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = x;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& x) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    x = cell->data;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return dequeue_pos_.load(std::memory_order_relaxed) ==
+        enqueue_pos_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> enqueue_pos_{0};
+  char pad1_[kCacheLineSize];
+  std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace
+
+struct WorkStealingThreadPool::Task {
+  explicit Task(std::function<void()> f) : fn(std::move(f)) {}
+  std::function<void()> fn;
+};
+
+struct WorkStealingThreadPool::Worker {
+  Worker() : inbox(kInboxCapacity) {}
+
+  ChaseLevDeque<Task*> deque;
+  BoundedQueue<Task*> inbox;
+  char pad_[kCacheLineSize];
+  std::atomic_bool busy{false};
+  // xorshift state to pick the victims of steals
+  uint64_t rng;
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    int numa_node_id,
+    std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      running_(true),
+      numa_node_id_(numa_node_id),
+      max_spinning_(std::min<size_t>(
+          threads_.size(),
+          std::thread::hardware_concurrency() / 2)) {
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    workers_.emplace_back(new Worker());
+    workers_.back()->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread]() {
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    running_ = false;
+    park_condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  size_t available = 0;
+  for (const auto& worker : workers_) {
+    available += !worker->busy.load(std::memory_order_relaxed);
+  }
+  return available;
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_pool == this;
+}
+
+void WorkStealingThreadPool::run(std::function<void()> func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  auto* task = new Task(std::move(func));
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  if (current_pool == this) {
+    workers_[current_worker]->deque.push(task);
+  } else {
+    push_external(task);
+  }
+  notify();
+}
+
+void WorkStealingThreadPool::push_external(Task* task) {
+  // round robin per submitting thread, so that submitters do not share a
+  // counter
+  static thread_local size_t next_inbox =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  const size_t n = workers_.size();
+  for (size_t i = 0; i < n; ++i) {
+    if (workers_[next_inbox++ % n]->inbox.push(task)) {
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(overflow_mutex_);
+  overflow_.push_back(task);
+  overflow_size_.store(overflow_.size(), std::memory_order_relaxed);
+}
+
+void WorkStealingThreadPool::notify() {
+  // Pairs with the fence in park(): either the parking worker sees the new
+  // task, or we see it parked. A spinning worker will find the task anyway,
+  // and wakes another worker up if there is more work.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_spinning_.load(std::memory_order_relaxed) > 0 ||
+      num_parked_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  // Only one worker is woken up at a time. When it finds a task, it wakes
+  // up the next one if there is more work, instead of every submission
+  // waking up a worker.
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  if (wakeups_ == 0) {
+    wakeups_++;
+    park_condition_.notify_one();
+  }
+}
+
+void WorkStealingThreadPool::park() {
+  std::unique_lock<std::mutex> lock(park_mutex_);
+  num_parked_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (running_ && !has_work()) {
+    park_condition_.wait(lock, [this] { return wakeups_ > 0 || !running_; });
+    if (wakeups_ > 0) {
+      wakeups_--;
+    }
+  }
+  num_parked_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool WorkStealingThreadPool::has_work() const {
+  for (const auto& worker : workers_) {
+    if (!worker->deque.empty() || !worker->inbox.empty()) {
+      return true;
+    }
+  }
+  return overflow_size_.load(std::memory_order_relaxed) > 0;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::find_task(
+    std::size_t index) {
+  Worker& self = *workers_[index];
+  Task* task = self.deque.pop();
+  if (task || self.inbox.pop(task)) {
+    return task;
+  }
+
+  const size_t n = workers_.size();
+  self.rng ^= self.rng << 13;
+  self.rng ^= self.rng >> 7;
+  self.rng ^= self.rng << 17;
+  const size_t start = self.rng % n;
+  for (size_t i = 0; i < n; ++i) {
+    Worker& victim = *workers_[(start + i) % n];
+    if (&victim == &self) {
+      continue;
+    }
+    task = victim.deque.steal();
+    if (task || victim.inbox.pop(task)) {
+      return task;
+    }
+  }
+
+  if (overflow_size_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    if (!overflow_.empty()) {
+      task = overflow_.back();
+      overflow_.pop_back();
+      overflow_size_.store(overflow_.size(), std::memory_order_relaxed);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingThreadPool::run_task(Worker& worker, Task* task) {
+  worker.busy.store(true, std::memory_order_relaxed);
+  try {
+    task->fn();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in thread pool task: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Exception in thread pool task: unknown";
+  }
+  // destroy the task before signaling completion, it may hold resources
+  delete task;
+  worker.busy.store(false, std::memory_order_relaxed);
+
+  if (pending_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+      num_waiting_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(completed_mutex_);
+    completed_.notify_all();
+  }
+}
+
+void WorkStealingThreadPool::waitWorkComplete() {
+  std::unique_lock<std::mutex> lock(completed_mutex_);
+  num_waiting_.fetch_add(1, std::memory_order_seq_cst);
+  completed_.wait(lock, [this] {
+    return pending_.load(std::memory_order_seq_cst) == 0;
+  });
+  num_waiting_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_pool = this;
+  current_worker = index;
+  Worker& self = *workers_[index];
+  bool woken = false;
+  while (true) {
+    Task* task = find_task(index);
+    // Spinning only pays off if the spinning workers do not take cores
+    // away from the threads producing the tasks, so their number is capped.
+    size_t spinning = num_spinning_.load(std::memory_order_relaxed);
+    while (!task && spinning < max_spinning_) {
+      if (!num_spinning_.compare_exchange_weak(
+              spinning, spinning + 1, std::memory_order_relaxed)) {
+        continue;
+      }
+      for (int round = 0; !task && round < kSpinRounds; ++round) {
+        if (round < kYieldAfterRounds) {
+          C10_CPU_RELAX();
+        } else {
+          std::this_thread::yield();
+        }
+        task = find_task(index);
+      }
+      num_spinning_.fetch_sub(1, std::memory_order_seq_cst);
+      // submitters do not wake workers up while this one was spinning
+      woken = true;
+      break;
+    }
+    if (task) {
+      // pass on the remaining work
+      if (woken && has_work()) {
+        notify();
+      }
+      woken = false;
+      run_task(self, task);
+      continue;
+    }
+    // drain the queues before exiting
+    if (!running_ && !has_work()) {
+      break;
+    }
+    park();
+    woken = true;
+  }
+}
+
+} // namespace c10
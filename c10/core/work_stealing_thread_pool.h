@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10/core/thread_pool.h>
+
+namespace c10 {
+
+/**
+ * A thread pool that avoids the single locked queue of ThreadPool.
+ *
+ * Every worker owns a Chase-Lev deque: tasks submitted from a worker (e.g.
+ * nested parallel regions) are pushed to the bottom of its own deque and
+ * popped LIFO, while idle workers steal FIFO from the top of the others'
+ * deques. Tasks submitted from outside the pool are spread round robin over
+ * bounded lock-free per-worker inboxes; a mutex is only taken when all of
+ * them are full. Idle workers spin for a while before parking on a
+ * condition variable, and submitters only touch the condition variable when
+ * a worker is actually parked.
+ *
+ * Like ThreadPool, exceptions thrown by tasks are logged and swallowed.
+ * Tasks still queued when the pool is destroyed are run before the workers
+ * exit.
+ */
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(std::function<void()> func) override;
+
+  /// @brief Wait until all the submitted tasks have run
+  void waitWorkComplete();
+
+ private:
+  struct Task;
+  struct Worker;
+
+  // Entry point for pool threads.
+  void main_loop(std::size_t index);
+  Task* find_task(std::size_t index);
+  bool has_work() const;
+  void run_task(Worker& worker, Task* task);
+  void push_external(Task* task);
+  void notify();
+  void park();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic_bool running_;
+  int numa_node_id_;
+
+  // Number of workers looking for tasks before parking, capped at half of
+  // the cores
+  std::atomic<size_t> num_spinning_{0};
+  const size_t max_spinning_;
+
+  // Tasks that did not fit into any inbox
+  std::mutex overflow_mutex_;
+  std::vector<Task*> overflow_;
+  std::atomic<size_t> overflow_size_{0};
+
+  // Parking. Wakeups are counted so that a notification sent between a
+  // worker deciding to park and it waiting is not lost.
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_;
+  std::atomic<size_t> num_parked_{0};
+  size_t wakeups_{0};
+
+  // waitWorkComplete()
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> num_waiting_{0};
+  std::mutex completed_mutex_;
+  std::condition_variable completed_;
+};
+
+} // namespace c10
@@ -1,6 +1,7 @@
 #include <climits>
 
 #include <c10/mobile/CPUProfilingAllocator.h>
+#include <c10/util/llvmMathExtras.h>
 
 namespace c10 {
 
@@ -126,11 +127,12 @@ std::vector<uint64_t> formulate_greedy_allocation_plan(
 
   // lower_bound on this map will get all candidates of
   // the right size for allocation.
-  std::map<uint64_t, uint64_t> free_size_to_offset;
+  // Several free blocks may have the same size.
+  std::multimap<uint64_t, uint64_t> free_size_to_offset;
   // This provides fast lookup when we want to insert freed block
   // back, especially when we want to merge blocks.
-  ska::flat_hash_map<uint64_t, std::map<uint64_t, uint64_t>::iterator> free_start_offset_to_size_iter;
-  ska::flat_hash_map<uint64_t, std::map<uint64_t, uint64_t>::iterator> free_end_offset_to_size_iter;
+  ska::flat_hash_map<uint64_t, std::multimap<uint64_t, uint64_t>::iterator> free_start_offset_to_size_iter;
+  ska::flat_hash_map<uint64_t, std::multimap<uint64_t, uint64_t>::iterator> free_end_offset_to_size_iter;
   // Upon free end_ptr = offset + size
   // If end_ptr exists merge freed allocation
   // Also find corresponding offset in size_to_offset
@@ -163,13 +165,14 @@ std::vector<uint64_t> formulate_greedy_allocation_plan(
         // 2. If block still has space left insert the remainder back in map.
         //    Including reverse map entries.
         alloc_offset = it->second;
+        const auto block_size = it->first;
         new_offset = alloc_offset + mem_event.size;
-        new_size = it->first - mem_event.size;
+        new_size = block_size - mem_event.size;
         free_size_to_offset.erase(it);
         free_start_offset_to_size_iter.erase(alloc_offset);
-        free_end_offset_to_size_iter.erase(alloc_offset + it->first);
+        free_end_offset_to_size_iter.erase(alloc_offset + block_size);
         if (new_size > 0) {
-          auto ref_it = free_size_to_offset.emplace(new_size, new_offset).first;
+          auto ref_it = free_size_to_offset.emplace(new_size, new_offset);
           free_start_offset_to_size_iter.emplace(new_offset, ref_it);
           free_end_offset_to_size_iter.emplace(new_offset + new_size, ref_it);
         }
@@ -216,7 +219,7 @@ std::vector<uint64_t> formulate_greedy_allocation_plan(
         free_start_offset_to_size_iter.erase(freed_offset);
       }
       auto freed_block_it =
-        free_size_to_offset.emplace(freed_size, freed_offset).first;
+        free_size_to_offset.emplace(freed_size, freed_offset);
       free_start_offset_to_size_iter.emplace(freed_offset, freed_block_it);
       free_end_offset_to_size_iter.emplace(
           freed_offset + freed_size, freed_block_it);
@@ -323,7 +326,9 @@ void CPUProfilingAllocator::set_plan(const AllocationPlan* plan) {
   TORCH_CHECK(plan != nullptr, "Allocation plan is nullptr.");
   plan_ = plan;
   allocation_id_ = 0;
+  num_fallbacks_ = 0;
   allocation_ptr_to_id_.clear();
+  live_blocks_.clear();
   if (current_size_ < plan->total_size) {
     // Free existing memory and reallocate for larger size.
     c10::free_cpu(blob_);
@@ -335,24 +340,53 @@ void CPUProfilingAllocator::set_plan(const AllocationPlan* plan) {
 void CPUProfilingAllocator::unset_plan() {
   allocation_id_ = 0;
   allocation_ptr_to_id_.clear();
+  live_blocks_.clear();
   plan_ = nullptr;
 }
 
+bool CPUProfilingAllocator::overlaps_live_block(
+    uint64_t start_offset, uint64_t end_offset) const {
+  // Live blocks do not overlap each other, so only the last one starting
+  // before end_offset can overlap.
+  auto it = live_blocks_.lower_bound(end_offset);
+  if (it == live_blocks_.begin()) {
+    return false;
+  }
+  --it;
+  return it->second > start_offset;
+}
+
 void* CPUProfilingAllocator::allocate(const size_t bytes) {
-  TORCH_CHECK(bytes == plan_->allocation_sizes[allocation_id_],
-      "Got allocation request that does not match with the plan.");
-  if (plan_->allocation_lifetimes[allocation_id_] ==
-      std::numeric_limits<uint64_t>::max()) {
-    // This allocation is not managed by ProfilingAllocator.
-    allocation_id_++;
+  TORCH_CHECK(plan_ != nullptr, "ProfilingAllocator: no allocation plan set.");
+  const uint64_t id = allocation_id_++;
+  if (bytes == 0) {
+    // An empty block would not overlap, and so could take the offset and the
+    // pointer of a live block. It needs no memory from the blob anyway.
     return c10::alloc_cpu(bytes);
   }
-  void* ptr =
-    reinterpret_cast<uint8_t*>(blob_) +
-    plan_->allocation_offsets[allocation_id_];
-  allocation_ptr_to_id_[ptr] = allocation_id_;
-  allocation_id_++;
-  return ptr;
+  if (id < plan_->allocation_sizes.size()) {
+    if (plan_->allocation_lifetimes[id] ==
+        std::numeric_limits<uint64_t>::max()) {
+      // This allocation is not managed by ProfilingAllocator.
+      if (bytes != plan_->allocation_sizes[id]) {
+        num_fallbacks_++;
+      }
+      return c10::alloc_cpu(bytes);
+    }
+    const uint64_t start_offset = plan_->allocation_offsets[id];
+    const uint64_t end_offset = start_offset + bytes;
+    if (bytes <= plan_->allocation_sizes[id] &&
+        !overlaps_live_block(start_offset, end_offset) &&
+        live_blocks_.emplace(start_offset, end_offset).second) {
+      void* ptr = reinterpret_cast<uint8_t*>(blob_) + start_offset;
+      allocation_ptr_to_id_[ptr] = id;
+      return ptr;
+    }
+  }
+  // The allocation does not fit into the plan, e.g. larger input shapes or
+  // different control flow than when profiling.
+  num_fallbacks_++;
+  return c10::alloc_cpu(bytes);
 }
 
 void CPUProfilingAllocator::free(void* const ptr) {
@@ -371,27 +405,94 @@ void CPUProfilingAllocator::free(void* const ptr) {
     //      }
     //      out is used..
     //    }
+    // or
+    // 3. Allocation that fell back to alloc_cpu is being freed.
     c10::free_cpu(ptr);
     return;
   }
   auto id = it->second;
   TORCH_CHECK(id < plan_->allocation_lifetimes.size(),
       "Freeing allocation that is not accordingly to the plan.");
-  auto lifetime_id = plan_->allocation_lifetimes[id];
-  TORCH_CHECK(
-      lifetime_id == allocation_id_,
-      "Lifetime of allocations do not match: allocation_id ",
-      id,
-      ", expected:",
-      lifetime_id,
-      ", got:",
-      allocation_id_);
+  // A lifetime differing from the plan is fine, later allocations that
+  // would overlap the block fall back while it is alive.
+  live_blocks_.erase(plan_->allocation_offsets[id]);
+  allocation_ptr_to_id_.erase(it);
 }
 
 CPUProfilingAllocator::~CPUProfilingAllocator() {
   c10::free_cpu(blob_);
 }
 
+AllocationPlanCache::ShapeSignature AllocationPlanCache::bucket(
+    const ShapeSignature& signature) {
+  ShapeSignature bucket = signature;
+  for (auto& sizes : bucket) {
+    for (auto& size : sizes) {
+      if (size > 1) {
+        size = int64_t(1) << llvm::Log2_64_Ceil(size);
+      }
+    }
+  }
+  return bucket;
+}
+
+bool AllocationPlanCache::dominates(
+    const ShapeSignature& a, const ShapeSignature& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].size() != b[i].size()) {
+      return false;
+    }
+    for (size_t d = 0; d < a[i].size(); ++d) {
+      if (a[i][d] < b[i][d]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+const AllocationPlan* AllocationPlanCache::find(
+    const ShapeSignature& signature) const {
+  // Number of elements of all inputs, to pick the smallest plan
+  auto numel = [](const ShapeSignature& signature) {
+    uint64_t numel = 0;
+    for (const auto& sizes : signature) {
+      uint64_t n = 1;
+      for (auto size : sizes) {
+        n *= size;
+      }
+      numel += n;
+    }
+    return numel;
+  };
+  const Entry* best = nullptr;
+  uint64_t best_numel = std::numeric_limits<uint64_t>::max();
+  for (const auto& it : plans_) {
+    const Entry& entry = it.second;
+    if (dominates(entry.recorded_signature, signature)) {
+      const uint64_t entry_numel = numel(entry.recorded_signature);
+      if (entry_numel < best_numel) {
+        best = &entry;
+        best_numel = entry_numel;
+      }
+    }
+  }
+  return best ? best->plan.get() : nullptr;
+}
+
+AllocationPlan* AllocationPlanCache::plan_to_record(
+    const ShapeSignature& signature) {
+  Entry& entry = plans_[bucket(signature)];
+  if (!entry.plan) {
+    entry.plan = std::make_unique<AllocationPlan>();
+  }
+  entry.recorded_signature = signature;
+  return entry.plan.get();
+}
+
 WithProfileAllocationsGuard::WithProfileAllocationsGuard(
     AllocationPlan* plan) {
   // Nesting of allocation profiling does not seem meaningful.
@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <c10/core/CPUAllocator.h>
 #include <c10/util/Exception.h>
@@ -70,6 +72,13 @@ class C10_API AllocationPlanner {
 };
 
 // NOT THREAD SAFE profiling allocator.
+// Allocation i of a run is placed at its offset in the blob when the plan
+// has an i-th allocation at least as large, managed by the plan, and its
+// block does not overlap a planned allocation that is still alive.
+// Otherwise that single allocation falls back to alloc_cpu, so that runs
+// whose allocations deviate from the plan (e.g. smaller input shapes, or
+// different control flow) are still served correctly.
+// Planned allocations must not outlive the WithProfilingAllocatorGuard.
 class C10_API CPUProfilingAllocator {
   private:
     const AllocationPlan* plan_{nullptr};
@@ -77,12 +86,76 @@ class C10_API CPUProfilingAllocator {
     uint64_t current_size_{0};
     void* blob_{nullptr};
     ska::flat_hash_map<const void*, uint64_t> allocation_ptr_to_id_;
+    // Start and end offsets of the planned allocations alive
+    std::map<uint64_t, uint64_t> live_blocks_;
+    uint64_t num_fallbacks_{0};
+
+    bool overlaps_live_block(uint64_t start_offset, uint64_t end_offset) const;
   public:
     ~CPUProfilingAllocator();
     void set_plan(const AllocationPlan* plan);
     void unset_plan();
     void* allocate(const size_t bytes);
     void free(void* const ptr);
+    // Number of allocations since set_plan that could not follow the plan
+    uint64_t num_fallbacks() const {
+      return num_fallbacks_;
+    }
+};
+
+/*
+ * Keeps one AllocationPlan per bucket of input shapes, for models run with
+ * varying input shapes (e.g. batch sizes). A shape signature holds the sizes
+ * of every input. Its bucket rounds every size up to a power of two.
+ *
+ * find() returns the plan recorded with the smallest signature that
+ * dominates the request, i.e. has the same ranks and sizes at least as
+ * large, assuming allocation sizes grow with the input sizes. Such a plan
+ * serves every allocation of the request from the blob. When there is none,
+ * the run is profiled into the plan of the request's bucket, replacing the
+ * plan previously recorded for that bucket. Profiling with inputs padded to
+ * the bucket makes a single plan serve the whole bucket.
+ *
+ * Usage:
+ * AllocationPlanCache plans;
+ * CPUProfilingAllocator profiling_allocator;
+ * for (each request) {
+ *   AllocationPlanCache::ShapeSignature signature = ...input sizes...;
+ *   if (const AllocationPlan* plan = plans.find(signature)) {
+ *     WithProfilingAllocatorGuard guard(&profiling_allocator, plan);
+ *     module.forward(...);
+ *   } else {
+ *     WithProfileAllocationsGuard guard(plans.plan_to_record(signature));
+ *     module.forward(...);
+ *   }
+ * }
+ *
+ * NOT THREAD SAFE.
+ */
+class C10_API AllocationPlanCache {
+  public:
+    using ShapeSignature = std::vector<std::vector<int64_t>>;
+
+    static ShapeSignature bucket(const ShapeSignature& signature);
+    // Whether a request with signature b fits into a plan recorded with a
+    static bool dominates(const ShapeSignature& a, const ShapeSignature& b);
+
+    const AllocationPlan* find(const ShapeSignature& signature) const;
+    AllocationPlan* plan_to_record(const ShapeSignature& signature);
+
+    size_t size() const {
+      return plans_.size();
+    }
+    void clear() {
+      plans_.clear();
+    }
+  private:
+    struct Entry {
+      ShapeSignature recorded_signature;
+      // unique_ptr so that plans handed out stay valid when the map grows
+      std::unique_ptr<AllocationPlan> plan;
+    };
+    std::map<ShapeSignature, Entry> plans_;
 };
 
 /*
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUSizeClassCachingAllocator.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace c10;
+
+namespace {
+
+CPUSizeClassCachingAllocator::Stats fresh_stats() {
+  CPUSizeClassCachingAllocator::emptyCache();
+  CPUSizeClassCachingAllocator::resetAccumulatedStats();
+  CPUSizeClassCachingAllocator::resetPeakStats();
+  return CPUSizeClassCachingAllocator::getStats();
+}
+
+} // namespace
+
+TEST(CPUSizeClassCachingAllocatorTest, SizeClasses) {
+  EXPECT_EQ(CPUSizeClassCachingAllocator::sizeClassBytes(1), 64u);
+  EXPECT_EQ(CPUSizeClassCachingAllocator::sizeClassBytes(64), 64u);
+  EXPECT_EQ(CPUSizeClassCachingAllocator::sizeClassBytes(65), 128u);
+  EXPECT_EQ(CPUSizeClassCachingAllocator::sizeClassBytes(4000), 4096u);
+  EXPECT_EQ(
+      CPUSizeClassCachingAllocator::sizeClassBytes(32u << 20), 32u << 20);
+  EXPECT_EQ(
+      CPUSizeClassCachingAllocator::sizeClassBytes((32u << 20) + 1), 0u);
+}
+
+TEST(CPUSizeClassCachingAllocatorTest, ReusesBlocks) {
+  Allocator* allocator = CPUSizeClassCachingAllocator::get();
+  const auto before = fresh_stats();
+
+  void* first = nullptr;
+  {
+    DataPtr ptr = allocator->allocate(1000);
+    first = ptr.get();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0u);
+    EXPECT_EQ(ptr.get(), ptr.get_context());
+    memset(first, 1, 1000);
+    EXPECT_EQ(
+        CPUSizeClassCachingAllocator::getStats().allocated_bytes,
+        before.allocated_bytes + 1024);
+  }
+  {
+    // same size class
+    DataPtr ptr = allocator->allocate(600);
+    EXPECT_EQ(ptr.get(), first);
+  }
+
+  auto stats = CPUSizeClassCachingAllocator::getStats();
+  EXPECT_EQ(stats.cache_misses, 1);
+  EXPECT_EQ(stats.cache_hits, 1);
+  EXPECT_EQ(stats.allocated_bytes, before.allocated_bytes);
+  EXPECT_EQ(stats.cached_bytes, 1024);
+  EXPECT_EQ(stats.reserved_bytes, before.reserved_bytes + 1024);
+
+  CPUSizeClassCachingAllocator::emptyCache();
+  stats = CPUSizeClassCachingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes, 0);
+  EXPECT_EQ(stats.reserved_bytes, before.reserved_bytes);
+  EXPECT_EQ(stats.peak_reserved_bytes, before.reserved_bytes + 1024);
+}
+
+TEST(CPUSizeClassCachingAllocatorTest, Oversize) {
+  Allocator* allocator = CPUSizeClassCachingAllocator::get();
+  const auto before = fresh_stats();
+  const size_t nbytes = (32u << 20) + 1;
+  {
+    DataPtr ptr = allocator->allocate(nbytes);
+    memset(ptr.get(), 1, nbytes);
+  }
+  const auto stats = CPUSizeClassCachingAllocator::getStats();
+  EXPECT_EQ(stats.oversize_allocations, 1);
+  EXPECT_EQ(stats.cached_bytes, 0);
+  EXPECT_EQ(stats.reserved_bytes, before.reserved_bytes);
+}
+
+TEST(CPUSizeClassCachingAllocatorTest, CrossThreadFree) {
+  Allocator* allocator = CPUSizeClassCachingAllocator::get();
+  const auto before = fresh_stats();
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumBlocks = 1000;
+  std::vector<std::vector<DataPtr>> ptrs(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumBlocks; ++i) {
+        ptrs[t].push_back(allocator->allocate(64 << (i % 8)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  // freed by other threads than the ones that allocated, which then exit
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back(
+        [&, t]() { ptrs[(t + 1) % kNumThreads].clear(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = CPUSizeClassCachingAllocator::getStats();
+  EXPECT_EQ(stats.cache_hits + stats.cache_misses, kNumThreads * kNumBlocks);
+  EXPECT_EQ(stats.allocated_bytes, before.allocated_bytes);
+  EXPECT_EQ(stats.reserved_bytes - before.reserved_bytes, stats.cached_bytes);
+
+  CPUSizeClassCachingAllocator::emptyCache();
+  stats = CPUSizeClassCachingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes, 0);
+  EXPECT_EQ(stats.reserved_bytes, before.reserved_bytes);
+}
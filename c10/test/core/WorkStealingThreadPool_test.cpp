@@ -0,0 +1,61 @@
+#include <c10/core/work_stealing_thread_pool.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+using c10::WorkStealingThreadPool;
+
+TEST(WorkStealingThreadPoolTest, givenTasks_whenWaiting_thenAllTasksRan) {
+  WorkStealingThreadPool pool(4);
+  EXPECT_EQ(4, pool.size());
+  EXPECT_FALSE(pool.inThreadPool());
+
+  std::atomic<int> count{0};
+  // more tasks than fit into the inboxes of the workers
+  constexpr int kNumTasks = 10000;
+  for (int i = 0; i < kNumTasks; ++i) {
+    pool.run([&count]() { count++; });
+  }
+  pool.waitWorkComplete();
+  EXPECT_EQ(kNumTasks, count.load());
+}
+
+TEST(WorkStealingThreadPoolTest, givenNestedTasks_whenWaiting_thenAllTasksRan) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> count{0};
+  std::atomic<int> in_pool{0};
+  for (int i = 0; i < 100; ++i) {
+    pool.run([&]() {
+      in_pool += pool.inThreadPool();
+      // pushed to the deque of this worker, and stolen by the others
+      for (int j = 0; j < 100; ++j) {
+        pool.run([&count]() { count++; });
+      }
+    });
+  }
+  pool.waitWorkComplete();
+  EXPECT_EQ(100, in_pool.load());
+  EXPECT_EQ(100 * 100, count.load());
+}
+
+TEST(WorkStealingThreadPoolTest, givenThrowingTask_whenRunning_thenPoolSurvives) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> count{0};
+  pool.run([]() { throw std::runtime_error("expected"); });
+  pool.run([&count]() { count++; });
+  pool.waitWorkComplete();
+  EXPECT_EQ(1, count.load());
+  EXPECT_EQ(2, pool.numAvailable());
+}
+
+TEST(WorkStealingThreadPoolTest, givenQueuedTasks_whenDestroying_thenTasksRun) {
+  std::atomic<int> count{0};
+  {
+    WorkStealingThreadPool pool(1);
+    for (int i = 0; i < 100; ++i) {
+      pool.run([&count]() { count++; });
+    }
+  }
+  EXPECT_EQ(100, count.load());
+}
@@ -1,6 +1,12 @@
 #include <c10/util/numa.h>
 
 C10_DEFINE_bool(caffe2_cpu_numa_enabled, false, "Use NUMA whenever possible.");
+C10_DEFINE_bool(
+    caffe2_cpu_numa_first_touch,
+    false,
+    "If set together with caffe2_cpu_numa_enabled, CPU allocations are placed "
+    "on the allocating thread's NUMA node by touching their pages instead of "
+    "binding them with mbind.");
 
 #if defined(__linux__) && defined(C10_USE_NUMA) && !defined(C10_MOBILE)
 #include <numa.h>
@@ -94,6 +100,23 @@ void NUMAMove(void* ptr, size_t size, int numa_node_id) {
       "Could not move memory to a NUMA node");
 }
 
+void NUMAFirstTouch(void* ptr, size_t size) {
+  if (!IsNUMAEnabled() || size == 0) {
+    return;
+  }
+  AT_ASSERT(ptr);
+
+  const uintptr_t page_size = getpagesize();
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t end = start + size;
+  // volatile so that the stores to otherwise unused memory are kept
+  *reinterpret_cast<volatile char*>(start) = 0;
+  for (uintptr_t page = (start & ~(page_size - 1)) + page_size; page < end;
+       page += page_size) {
+    *reinterpret_cast<volatile char*>(page) = 0;
+  }
+}
+
 int GetCurrentNUMANode() {
   if (!IsNUMAEnabled()) {
     return -1;
@@ -123,6 +146,9 @@ int GetNumNUMANodes() {
 void NUMAMove(void* ptr, size_t size, int numa_node_id) {
 }
 
+void NUMAFirstTouch(void* ptr, size_t size) {
+}
+
 int GetCurrentNUMANode() {
   return -1;
 }
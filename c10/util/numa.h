@@ -4,6 +4,7 @@
 #include <c10/util/Optional.h>
 
 C10_DECLARE_bool(caffe2_cpu_numa_enabled);
+C10_DECLARE_bool(caffe2_cpu_numa_first_touch);
 
 namespace c10 {
 
@@ -32,6 +33,15 @@ C10_API int GetNumNUMANodes();
  */
 C10_API void NUMAMove(void* ptr, size_t size, int numa_node_id);
 
+/**
+ * Touch every page of the memory pointed to by `ptr` of a given size from the
+ * calling thread, so that pages not yet backed by physical memory are
+ * allocated on the calling thread's NUMA node. Unlike NUMAMove, pages that are
+ * already resident are left where they are and no memory policy is set.
+ * The contents of the memory are clobbered.
+ */
+C10_API void NUMAFirstTouch(void* ptr, size_t size);
+
 /**
  * Get the current NUMA node id
  */
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +64,60 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, LoadMmapped) {
+  const std::string file_name = "output_mmap.zip";
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  std::array<char, 4096> data2;
+  for (int i = 0; i < data2.size(); ++i) {
+    data2[i] = i % 64;
+  }
+  {
+    PyTorchStreamWriter writer(file_name);
+    writer.writeRecord("key1", data1.data(), data1.size());
+    writer.writeRecord("key2", data2.data(), data2.size());
+    writer.writeRecord("key3", data2.data(), data2.size(), /*compress=*/true);
+    writer.writeEndOfFile();
+  }
+
+  at::DataPtr data_ptr1, data_ptr2, data_ptr3;
+  size_t size1, size2, size3, off1, off2, off3;
+  {
+    PyTorchStreamReader reader(std::make_shared<MmapFileAdapter>(file_name));
+    std::tie(data_ptr1, size1) = reader.getRecord("key1");
+    std::tie(data_ptr2, size2) = reader.getRecord("key2");
+    std::tie(data_ptr3, size3) = reader.getRecord("key3");
+    off1 = reader.getRecordOffset("key1");
+    off2 = reader.getRecordOffset("key2");
+    off3 = reader.getRecordOffset("key3");
+  }
+
+  // Stored records alias the mapping, which outlives the reader.
+  auto base = static_cast<char*>(data_ptr1.get()) - off1;
+  ASSERT_EQ(static_cast<char*>(data_ptr2.get()) - off2, base);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(data_ptr1.get()) % 64, 0);
+  ASSERT_EQ(size1, data1.size());
+  ASSERT_EQ(memcmp(data_ptr1.get(), data1.data(), data1.size()), 0);
+  ASSERT_EQ(size2, data2.size());
+  ASSERT_EQ(memcmp(data_ptr2.get(), data2.data(), data2.size()), 0);
+
+  // Compressed records are copied.
+  ASSERT_NE(static_cast<char*>(data_ptr3.get()) - off3, base);
+  ASSERT_EQ(size3, data2.size());
+  ASSERT_EQ(memcmp(data_ptr3.get(), data2.data(), data2.size()), 0);
+
+  // Writes to aliased records don't change the file.
+  memset(data_ptr2.get(), 0, size2);
+  PyTorchStreamReader reader(file_name);
+  at::DataPtr data_ptr;
+  size_t size;
+  std::tie(data_ptr, size) = reader.getRecord("key2");
+  ASSERT_EQ(memcmp(data_ptr.get(), data2.data(), data2.size()), 0);
+  std::remove(file_name.c_str());
+}
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
@@ -0,0 +1,163 @@
+#include "caffe2/serialize/mmap_file_adapter.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <c10/util/Exception.h>
+
+namespace caffe2 {
+namespace serialize {
+
+// The mapping is shared by the adapter and the DataPtrs it returns, so it
+// is only unmapped once all of them are gone.
+class MmapFileAdapter::Mapping {
+ public:
+  Mapping(const std::string& file_name, bool random_access);
+  ~Mapping();
+
+  char* data = nullptr;
+  size_t size = 0;
+};
+
+#ifdef _WIN32
+// Windows doesn't read ahead of faulting pages of a mapping by default.
+MmapFileAdapter::Mapping::Mapping(
+    const std::string& file_name,
+    bool /*random_access*/) {
+  HANDLE file = CreateFileA(
+      file_name.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    AT_ERROR(
+        "open file failed, file path: ",
+        file_name,
+        ", error: ",
+        GetLastError());
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    auto error = GetLastError();
+    CloseHandle(file);
+    AT_ERROR("getting size of ", file_name, " failed, error: ", error);
+  }
+  size = file_size.QuadPart;
+  if (size > 0) {
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+      data = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+      CloseHandle(mapping);
+    }
+    if (data == nullptr) {
+      auto error = GetLastError();
+      CloseHandle(file);
+      AT_ERROR("mapping ", file_name, " failed, error: ", error);
+    }
+  }
+  CloseHandle(file);
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (data != nullptr) {
+    UnmapViewOfFile(data);
+  }
+}
+#else
+MmapFileAdapter::Mapping::Mapping(
+    const std::string& file_name,
+    bool random_access) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR(
+        "open file failed, file path: ", file_name, ", ", strerror(errno));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    auto error = errno;
+    close(fd);
+    AT_ERROR("getting size of ", file_name, " failed: ", strerror(error));
+  }
+  size = file_stat.st_size;
+  if (size > 0) {
+    // Private and writable, so that writes to the aliased records copy the
+    // written pages instead of failing or modifying the file.
+    void* ptr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+      auto error = errno;
+      close(fd);
+      AT_ERROR("mapping ", file_name, " failed: ", strerror(error));
+    }
+    data = static_cast<char*>(ptr);
+    if (random_access) {
+      // Only a hint, the mapping works the same if it is ignored.
+      madvise(ptr, size, MADV_RANDOM);
+    }
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (data != nullptr) {
+    munmap(data, size);
+  }
+}
+#endif
+
+MmapFileAdapter::MmapFileAdapter(
+    const std::string& file_name,
+    bool random_access)
+    : mapping_(std::make_shared<Mapping>(file_name, random_access)) {}
+
+size_t MmapFileAdapter::size() const {
+  return mapping_->size;
+}
+
+size_t MmapFileAdapter::read(
+    uint64_t pos,
+    void* buf,
+    size_t n,
+    const char* what) const {
+  TORCH_CHECK(
+      pos <= mapping_->size && n <= mapping_->size - pos,
+      "mmap reader failed: ",
+      what,
+      ".");
+  if (n > 0) {
+    memcpy(buf, mapping_->data + pos, n);
+  }
+  return n;
+}
+
+at::DataPtr MmapFileAdapter::aliasData(uint64_t pos, size_t n) const {
+  TORCH_CHECK(
+      pos <= mapping_->size && n <= mapping_->size - pos,
+      "mmap reader failed: aliasing out of range data.");
+  // Every DataPtr holds a reference to the mapping.
+  auto ctx = new std::shared_ptr<Mapping>(mapping_);
+  return at::DataPtr(
+      mapping_->data + pos,
+      ctx,
+      [](void* ctx) { delete static_cast<std::shared_ptr<Mapping>*>(ctx); },
+      at::Device(at::DeviceType::CPU));
+}
+
+MmapFileAdapter::~MmapFileAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
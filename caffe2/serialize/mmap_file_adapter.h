@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// Reads a file through a copy-on-write memory mapping of the whole file.
+//
+// Unlike FileAdapter, it supports aliasData, so PyTorchStreamReader returns
+// uncompressed records without copying them. Their pages are backed by the
+// page cache, shared between the processes that map the same file and only
+// read from disk when they are first touched. Writing to them makes a private
+// copy of the written pages; the file itself is never modified.
+//
+// If `random_access` is set, the kernel is told not to read ahead of the
+// touched pages, so only the pages that are actually used are read from disk.
+//
+// The file must not be truncated while it is mapped, that is while the
+// adapter or any DataPtr returned by aliasData is alive.
+class TORCH_API MmapFileAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapFileAdapter);
+  explicit MmapFileAdapter(
+      const std::string& file_name,
+      bool random_access = false);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr aliasData(uint64_t pos, size_t n) const override;
+  ~MmapFileAdapter();
+
+ private:
+  class Mapping;
+  std::shared_ptr<Mapping> mapping_;
+};
+
+} // namespace serialize
+} // namespace caffe2
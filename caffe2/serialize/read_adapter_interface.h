@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "c10/core/Allocator.h"
 #include "c10/macros/Macros.h"
 
 namespace caffe2 {
@@ -16,6 +17,11 @@ class TORCH_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // Returns a DataPtr to the n bytes at pos that aliases memory owned by the
+  // reader (e.g. a memory mapping of the file) instead of a copy, or an empty
+  // DataPtr if the reader doesn't support it. The returned DataPtr keeps the
+  // memory alive after the reader is destroyed.
+  virtual at::DataPtr aliasData(uint64_t pos, size_t n) const;
   virtual ~ReadAdapterInterface();
 };
 
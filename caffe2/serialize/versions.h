@@ -53,7 +53,17 @@ constexpr uint64_t kProducedFileFormatVersion = 0x3L;
 // should be increased too. The relationship is:
 // kMaxSupportedFileFormatVersion >= (most likely ==) kProducedBytecodeVersion
 //   >= kProducedFileFormatVersion
-constexpr uint64_t kProducedBytecodeVersion = 0x4L;
+//
+// Bytecode versions:
+// 4. Stack based bytecode, the same as the TorchScript interpreter's
+// 5. Operators whose inputs are loaded from registers, and whose output is
+//      stored into a register, are emitted as OPR with explicit register
+//      operands
+constexpr uint64_t kProducedBytecodeVersion = 0x5L;
+
+// The version written when register operands are disabled, see
+// torch::jit::getMobileRegisterOperandsEnabled.
+constexpr uint64_t kStackBytecodeVersion = 0x4L;
 
 static_assert(kProducedBytecodeVersion >= kProducedFileFormatVersion,
     "kProducedBytecodeVersion must be higher or equal to kProducedFileFormatVersion.");
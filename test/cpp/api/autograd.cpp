@@ -2,6 +2,7 @@
 
 #include <torch/torch.h>
 
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/functions/basic_ops.h>
 
 #include <test/cpp/api/support.h>
@@ -188,6 +189,89 @@ TEST(AutogradAPITests, AnomalyMode) {
   }
 }
 
+TEST(AutogradAPITests, ParallelCPUBackward) {
+  auto x = torch::randn({64, 64}, torch::requires_grad());
+  auto w = torch::randn({64, 64}, torch::requires_grad());
+  auto run = [&]() {
+    // Independent branches that all accumulate into x and w
+    std::vector<Variable> branches;
+    for (int i = 0; i < 8; ++i) {
+      auto h = x;
+      for (int j = 0; j < 4; ++j) {
+        h = torch::tanh(h.mm(w) * (i + 1));
+      }
+      branches.push_back(h.sum());
+    }
+    auto xw = grad({torch::stack(branches).sum()}, {x, w});
+    x.sum().backward();
+    return std::make_pair(xw, x.grad().clone());
+  };
+
+  const int old_num_threads = Engine::num_cpu_threads();
+  Engine::set_num_cpu_threads(1);
+  auto expected = run();
+  x.mutable_grad().reset();
+  Engine::set_num_cpu_threads(4);
+  for (int i = 0; i < 4; ++i) {
+    auto result = run();
+    x.mutable_grad().reset();
+    // Gradients are summed in decreasing sequence_nr of their producers,
+    // which is also the order of the single threaded run on this graph
+    ASSERT_TRUE(torch::equal(result.first[0], expected.first[0]));
+    ASSERT_TRUE(torch::equal(result.first[1], expected.first[1]));
+    ASSERT_TRUE(torch::equal(result.second, expected.second));
+  }
+  Engine::set_num_cpu_threads(old_num_threads);
+}
+
+TEST(AutogradAPITests, ParallelCPUBackwardReentrant) {
+  // Like checkpointing, the backward of every branch recomputes its forward
+  // and runs a reentrant backward on it, so the helper threads complete child
+  // graph tasks while the owning thread waits for its own tasks.
+  struct Checkpoint : public Function<Checkpoint> {
+    static Variable forward(AutogradContext* ctx, Variable x, Variable w) {
+      ctx->save_for_backward({x, w});
+      return torch::tanh(x.mm(w));
+    }
+
+    static variable_list backward(
+        AutogradContext* ctx,
+        variable_list grad_output) {
+      auto saved = ctx->get_saved_variables();
+      auto x = saved[0].detach().requires_grad_();
+      auto w = saved[1].detach().requires_grad_();
+      torch::AutoGradMode enable_grad(true);
+      auto y = torch::tanh(x.mm(w));
+      return grad({y}, {x, w}, {grad_output[0]});
+    }
+  };
+
+  auto x = torch::randn({32, 32}, torch::requires_grad());
+  auto w = torch::randn({32, 32}, torch::requires_grad());
+  auto run = [&]() {
+    std::vector<Variable> branches;
+    for (int i = 0; i < 8; ++i) {
+      auto h = x * (i + 1);
+      for (int j = 0; j < 2; ++j) {
+        h = Checkpoint::apply(h, w);
+      }
+      branches.push_back(h.sum());
+    }
+    return grad({torch::stack(branches).sum()}, {x, w});
+  };
+
+  const int old_num_threads = Engine::num_cpu_threads();
+  Engine::set_num_cpu_threads(1);
+  auto expected = run();
+  Engine::set_num_cpu_threads(4);
+  for (int i = 0; i < 20; ++i) {
+    auto result = run();
+    ASSERT_TRUE(torch::allclose(result[0], expected[0]));
+    ASSERT_TRUE(torch::allclose(result[1], expected[1]));
+  }
+  Engine::set_num_cpu_threads(old_num_threads);
+}
+
 TEST(CustomAutogradTest, CustomFunction) {
   struct MyFunction : public Function<MyFunction> {
     static Variable forward(AutogradContext *ctx, Variable var1, int mul, Variable var2) {
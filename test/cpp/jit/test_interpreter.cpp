@@ -2,6 +2,7 @@
 
 #include <ATen/Parallel.h>
 #include "test/cpp/jit/test_utils.h"
+#include "torch/csrc/jit/runtime/unboxed_ops.h"
 #include "torch/jit.h"
 #include "torch/script.h"
 #include "torch/torch.h"
@@ -178,5 +179,106 @@ TEST(InterpreterTest, runAsyncBasicTest) {
   interp.runAsync(stack)->wait();
   ASSERT_TRUE(asyncCounter > 0);
 }
+
+TEST(InterpreterTest, Superinstructions) {
+  Module inner("inner");
+  inner.register_attribute("alpha", FloatType::get(), 0.5);
+  Module m("m");
+  m.register_module("inner", inner);
+  m.define(R"(
+    def forward(self, x, y, n: int):
+        z = x
+        for _ in range(n):
+            z = torch.add(z, y, alpha=self.inner.alpha)
+            z = z * self.inner.alpha
+        if bool(z.sum() > 0):
+            z = z + y
+        return z
+  )");
+  auto graph = m.get_method("forward").graph();
+  auto x = at::randn({2, 3});
+  auto y = at::randn({2, 3});
+
+  std::vector<at::Tensor> outputs;
+  bool old_flag = getInterpreterSuperinstructionsEnabled();
+  for (bool enabled : {true, false}) {
+    getInterpreterSuperinstructionsEnabled() = enabled;
+    Code function(graph, "");
+    InterpreterState interp(function);
+    Stack stack{m._ivalue(), x, y, 10};
+    interp.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    outputs.push_back(stack[0].toTensor());
+  }
+  getInterpreterSuperinstructionsEnabled() = old_flag;
+  ASSERT_TRUE(exactlyEqual(outputs[0], outputs[1]));
+}
+
+TEST(InterpreterTest, UnboxedOperations) {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%a : Tensor,
+      %b : Tensor):
+  %alpha : int = prim::Constant[value=2]()
+  %c : Tensor = aten::add(%a, %b, %alpha)
+  %d : Tensor = aten::relu(%c)
+  %e : Tensor = aten::matmul(%d, %b)
+  return (%e)
+  )IR",
+      &*graph);
+  auto a = at::randn({3, 3});
+  auto b = at::randn({3, 3});
+  auto expected = at::matmul(at::relu(at::add(a, b, 2)), b);
+
+  Code function(graph, "");
+  {
+    InterpreterState interp(function);
+    Stack stack{a, b};
+    interp.run(stack);
+    ASSERT_TRUE(exactlyEqual(stack[0].toTensor(), expected));
+  }
+  {
+    // A different thread local dispatch key state resolves the dispatch key
+    // of the unboxed operations again.
+    c10::impl::ExcludeDispatchKeyGuard guard(c10::DispatchKey::AutogradCPU);
+    InterpreterState interp(function);
+    Stack stack{a, b};
+    interp.run(stack);
+    ASSERT_TRUE(exactlyEqual(stack[0].toTensor(), expected));
+  }
+}
+
+TEST(InterpreterTest, UnboxedOperationsWithOtherLocalDispatchKeys) {
+  auto handle = c10::Dispatcher::singleton().findSchema({"aten::relu", ""});
+  ASSERT_TRUE(handle.has_value());
+  int num_boxed_calls = 0;
+  Operation boxed = [&](Stack* stack) {
+    num_boxed_calls++;
+    handle->callBoxed(stack);
+  };
+  auto unboxed = createUnboxedOperation(*handle, boxed);
+  ASSERT_TRUE(unboxed.has_value());
+  auto run = [&](const at::Tensor& input) {
+    Stack stack{input};
+    (*unboxed)(&stack);
+    return stack[0].toTensor();
+  };
+
+  auto a = at::randn({3, 3});
+  ASSERT_TRUE(exactlyEqual(run(a), at::relu(a)));
+  {
+    // The lite interpreter runs models in this mode, but doesn't load them
+    // in it.
+    at::AutoNonVariableTypeMode non_var_type_mode(true);
+    ASSERT_TRUE(exactlyEqual(run(a), at::relu(a)));
+  }
+  ASSERT_EQ(num_boxed_calls, 0);
+
+  // Other tensors than dense CPU ones take the boxed path.
+  auto q = at::quantize_per_tensor(a, 0.1, 10, at::kQUInt8);
+  ASSERT_TRUE(run(q).equal(at::relu(q)));
+  ASSERT_EQ(num_boxed_calls, 1);
+}
 } // namespace jit
 } // namespace torch
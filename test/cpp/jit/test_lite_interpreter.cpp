@@ -4,12 +4,14 @@
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/mobile/import.h>
+#include <torch/csrc/jit/mobile/interpreter.h>
 #include <torch/csrc/jit/mobile/module.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/custom_class.h>
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <unordered_set>
 
 #define ASSERT_THROWS_WITH(statement, substring)                         \
@@ -47,6 +49,42 @@ TEST(LiteInterpreterTest, UpsampleNearest2d) {
   ASSERT_TRUE(resd.equal(refd));
 }
 
+TEST(LiteInterpreterTest, RegisterOperands) {
+  Module m("m");
+  m.register_parameter("w", torch::ones({2, 2}), false);
+  m.define(R"(
+    def forward(self, x, n: int):
+      y = x
+      for i in range(n):
+        y = torch.add(torch.mul(y, self.w), x)
+        if i % 2 == 0:
+          y = torch.relu(y)
+        else:
+          y = torch.sigmoid(y)
+      return y
+  )");
+
+  std::vector<IValue> inputs{torch::rand({2, 2}) - 0.5, 3};
+  auto ref = m.forward(inputs).toTensor();
+
+  bool old_flag = getMobileRegisterOperandsEnabled();
+  for (bool enabled : {true, false}) {
+    getMobileRegisterOperandsEnabled() = enabled;
+    std::stringstream ss;
+    m._save_for_mobile(ss);
+    mobile::Module bc = _load_for_mobile(ss);
+    const auto& instructions =
+        bc.get_method("forward").function().get_code()->instructions_;
+    bool has_opr = std::any_of(
+        instructions.begin(), instructions.end(), [](const Instruction& ins) {
+          return ins.op == OPR;
+        });
+    ASSERT_EQ(has_opr, enabled);
+    ASSERT_TRUE(bc.forward(inputs).toTensor().equal(ref));
+  }
+  getMobileRegisterOperandsEnabled() = old_flag;
+}
+
 TEST(LiteInterpreterTest, CheckAttrAccess) {
   Module m("m");
   m.register_attribute("mobile_optimized", BoolType::get(), true);
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <test/cpp/jit/test_utils.h>
+#include <cstdio>
 #include <sstream>
 
 #include <torch/csrc/jit/serialization/export.h>
@@ -120,6 +121,75 @@ TEST(SerializationTest, TypeTags) {
   }
 }
 
+TEST(SerializationTest, LoadManyTensors) {
+  // The tensor records of an archive are read as the unpickler references
+  // them, or mapped and prefetched concurrently before unpickling.
+  Module m("m");
+  constexpr int kNumParameters = 200;
+  for (int i = 0; i < kNumParameters; i++) {
+    m.register_parameter(
+        "p" + c10::to_string(i), torch::randn({i + 1}), /*is_buffer=*/false);
+  }
+  const std::string filename = "many_tensors.pt";
+  m.save(filename);
+
+  const bool mmap = getMmapTensorData();
+  const bool prefetch = getPrefetchTensorData();
+  for (bool enabled : {false, true}) {
+    setMmapTensorData(enabled);
+    setPrefetchTensorData(enabled);
+    auto loaded = torch::jit::load(filename);
+    for (int i = 0; i < kNumParameters; i++) {
+      const auto name = "p" + c10::to_string(i);
+      ASSERT_TRUE(loaded.attr(name).toTensor().equal(m.attr(name).toTensor()));
+    }
+  }
+  setMmapTensorData(mmap);
+  setPrefetchTensorData(prefetch);
+  std::remove(filename.c_str());
+}
+
+TEST(SerializationTest, SaveToLoadedPath) {
+  // Tensors loaded from a file don't depend on it by default, so a module can
+  // be saved back to the path it was loaded from.
+  Module m("m");
+  m.register_parameter("weight", torch::randn({64, 1024}), false);
+  const std::string filename = "resaved.pt";
+  m.save(filename);
+
+  auto loaded = torch::jit::load(filename);
+  loaded.save(filename);
+  ASSERT_TRUE(
+      loaded.attr("weight").toTensor().equal(m.attr("weight").toTensor()));
+  auto reloaded = torch::jit::load(filename);
+  ASSERT_TRUE(
+      reloaded.attr("weight").toTensor().equal(m.attr("weight").toTensor()));
+  std::remove(filename.c_str());
+}
+
+TEST(SerializationTest, LoadLazily) {
+  Module m("m");
+  m.register_parameter("weight", torch::randn({64, 1024}), false);
+  m.register_parameter("bias", torch::randn({64}), false);
+  const std::string filename = "lazy_tensors.pt";
+  m.save(filename);
+
+  const bool lazy = getLazyTensorData();
+  setLazyTensorData(true);
+  auto loaded = torch::jit::load(filename);
+  ASSERT_TRUE(
+      loaded.attr("weight").toTensor().equal(m.attr("weight").toTensor()));
+  ASSERT_TRUE(loaded.attr("bias").toTensor().equal(m.attr("bias").toTensor()));
+
+  // Writes to lazily loaded tensors don't reach the archive.
+  loaded.attr("weight").toTensor().zero_();
+  auto reloaded = torch::jit::load(filename);
+  ASSERT_TRUE(
+      reloaded.attr("weight").toTensor().equal(m.attr("weight").toTensor()));
+  setLazyTensorData(lazy);
+  std::remove(filename.c_str());
+}
+
 TEST(SerializationTest, TestJitStream_CUDA) {
   torch::jit::Module model;
   std::vector<torch::jit::IValue> inputs;
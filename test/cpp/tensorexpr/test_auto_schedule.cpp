@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <test/cpp/tensorexpr/test_base.h>
+
+#include <torch/csrc/jit/tensorexpr/auto_schedule.h>
+#include <torch/csrc/jit/tensorexpr/eval.h>
+#include <torch/csrc/jit/tensorexpr/ir.h>
+#include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
+#include <torch/csrc/jit/tensorexpr/loopnest.h>
+#include <torch/csrc/jit/tensorexpr/tensor.h>
+
+namespace torch {
+namespace jit {
+
+using namespace torch::jit::tensorexpr;
+
+namespace {
+
+std::vector<float> iotaVector(size_t size) {
+  std::vector<float> v(size);
+  for (size_t i = 0; i < size; i++) {
+    v[i] = i % 17;
+  }
+  return v;
+}
+
+// Evaluates the loops computing `t` after scheduling them with the best
+// candidate, which is checked to be of kind `expected`.
+std::vector<float> runScheduled(
+    Tensor* t,
+    const std::vector<CodeGen::BufferArg>& args,
+    std::vector<std::vector<float>> inputs,
+    size_t outputSize,
+    ScheduleCandidate::Kind expected) {
+  LoopNest l({t});
+  AutoScheduler scheduler;
+  std::vector<ScheduleCandidate> candidates = scheduler.candidates(l, t);
+  EXPECT_FALSE(candidates.empty());
+  if (candidates.empty()) {
+    return {};
+  }
+  EXPECT_EQ(candidates[0].kind, expected);
+  scheduler.apply(l, t, candidates[0]);
+  l.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+
+  std::vector<float> out(outputSize, -1.f);
+  std::vector<CodeGen::CallArg> callArgs;
+  for (auto& input : inputs) {
+    callArgs.emplace_back(input.data());
+  }
+  callArgs.emplace_back(out.data());
+  SimpleIREvaluator cg(s, args);
+  cg.call(callArgs);
+  return out;
+}
+
+} // namespace
+
+TEST(AutoSchedule, TileTransposedAdd) {
+  KernelScope kernel_scope;
+  const int N = 512;
+  Placeholder a(BufHandle("a", {N, N}, kFloat));
+  Placeholder b(BufHandle("b", {N, N}, kFloat));
+  Tensor* c = Compute(
+      "c", {{N, "i"}, {N, "j"}}, [&](const VarHandle& i, const VarHandle& j) {
+        return a.load(i, j) + b.load(j, i);
+      });
+
+  std::vector<float> aData = iotaVector(N * N);
+  std::vector<float> bData = iotaVector(N * N);
+  std::vector<float> out = runScheduled(
+      c, {a, b, c}, {aData, bData}, N * N, ScheduleCandidate::kTile);
+  ASSERT_EQ(out.size(), N * N);
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      ASSERT_EQ(out[i * N + j], aData[i * N + j] + bData[j * N + i]);
+    }
+  }
+}
+
+TEST(AutoSchedule, TiledLoopOrder) {
+  KernelScope kernel_scope;
+  const int N = 512;
+  Placeholder a(BufHandle("a", {N, N}, kFloat));
+  Tensor* c = Compute(
+      "c", {{N, "i"}, {N, "j"}}, [&](const VarHandle& i, const VarHandle& j) {
+        return a.load(j, i);
+      });
+  LoopNest l({c});
+  std::vector<For*> before = l.getLoopStmtsFor(c);
+
+  AutoScheduler scheduler;
+  std::vector<ScheduleCandidate> candidates = scheduler.candidates(l, c);
+  ASSERT_FALSE(candidates.empty());
+  ASSERT_EQ(candidates[0].kind, ScheduleCandidate::kTile);
+  scheduler.apply(l, c, candidates[0]);
+
+  // i_outer, j_outer, i_inner, j_inner
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  ASSERT_EQ(loops.size(), 4);
+  const std::vector<int>& tiles = candidates[0].tileSizes;
+  std::vector<int> expectedTrips = {
+      N / tiles[0], N / tiles[1], tiles[0], tiles[1]};
+  for (size_t i = 0; i < loops.size(); i++) {
+    const Expr* trips = IRSimplifier::simplify(loops[i]->stop());
+    ASSERT_TRUE(trips->isConstant());
+    ASSERT_EQ(immediateAs<int>(trips), expectedTrips[i]);
+  }
+}
+
+TEST(AutoSchedule, ContiguousAddKeepsDefault) {
+  KernelScope kernel_scope;
+  const int N = 512;
+  Placeholder a(BufHandle("a", {N, N}, kFloat));
+  Placeholder b(BufHandle("b", {N, N}, kFloat));
+  Tensor* c = Compute(
+      "c", {{N, "i"}, {N, "j"}}, [&](const VarHandle& i, const VarHandle& j) {
+        return a.load(i, j) + b.load(i, j);
+      });
+  LoopNest l({c});
+  std::vector<ScheduleCandidate> candidates =
+      AutoScheduler().candidates(l, c);
+  ASSERT_FALSE(candidates.empty());
+  ASSERT_EQ(candidates[0].kind, ScheduleCandidate::kDefault);
+}
+
+TEST(AutoSchedule, RfactorRowReduction) {
+  KernelScope kernel_scope;
+  const int M = 64;
+  const int N = 256;
+  Placeholder in(BufHandle("in", {M, N}, kFloat));
+  Tensor* sum = Reduce("sum", {{M, "m"}}, Sum(), in, {{N, "n"}});
+
+  std::vector<float> inData = iotaVector(M * N);
+  std::vector<float> out = runScheduled(
+      sum, {in, sum}, {inData}, M, ScheduleCandidate::kRfactorVectorize);
+  ASSERT_EQ(out.size(), M);
+  for (int m = 0; m < M; m++) {
+    float expected = 0;
+    for (int n = 0; n < N; n++) {
+      expected += inData[m * N + n];
+    }
+    ASSERT_EQ(out[m], expected);
+  }
+}
+
+TEST(AutoSchedule, VectorizeColumnReduction) {
+  KernelScope kernel_scope;
+  const int M = 64;
+  const int N = 260;
+  Placeholder in(BufHandle("in", {M, N}, kFloat));
+  Tensor* sum = Reduce(
+      "sum",
+      {{N, "n"}},
+      Sum(),
+      [&](const VarHandle& n, const VarHandle& m) { return in.load(m, n); },
+      {{M, "m"}});
+
+  std::vector<float> inData = iotaVector(M * N);
+  std::vector<float> out = runScheduled(
+      sum, {in, sum}, {inData}, N, ScheduleCandidate::kVectorizeOutput);
+  ASSERT_EQ(out.size(), N);
+  for (int n = 0; n < N; n++) {
+    float expected = 0;
+    for (int m = 0; m < M; m++) {
+      expected += inData[m * N + n];
+    }
+    ASSERT_EQ(out[n], expected);
+  }
+}
+
+TEST(AutoSchedule, SymbolicBounds) {
+  KernelScope kernel_scope;
+  VarHandle n("n", kInt);
+  Placeholder a(BufHandle("a", {n}, kFloat));
+  Tensor* b = Compute("b", {{n, "i"}}, [&](const VarHandle& i) {
+    return a.load(i) * 2.f;
+  });
+  LoopNest l({b});
+  ASSERT_TRUE(AutoScheduler().candidates(l, b).empty());
+}
+
+} // namespace jit
+} // namespace torch
@@ -1289,6 +1289,44 @@ TEST(LLVM, BroadcastAdd) {
   }
 }
 
+TEST(LLVM, ParallelBroadcastAdd) {
+  KernelScope kernel_scope;
+  const int M = 32;
+  const int N = 1024;
+  Placeholder a(BufHandle("a", {M, N}, kFloat));
+  Placeholder b(BufHandle("b", {N}, kFloat));
+  VarHandle alpha("alpha", kFloat);
+  Tensor* c = Compute(
+      "c", {{M, "i"}, {N, "j"}}, [&](const VarHandle& i, const VarHandle& j) {
+        return a.load(i, j) + alpha * b.load(j);
+      });
+
+  Placeholder c_buf(BufHandle(c->buf()));
+  LoopNest l({c});
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  l.setParallel(loops[0]);
+  ASSERT_TRUE(loops[0]->loop_options().is_parallel());
+  ASSERT_EQ(loops[0]->loop_options().ToString(), "parallel");
+  l.prepareForCodegen();
+  l.vectorizeInnerLoops();
+  Stmt* s = l.root_stmt();
+
+  LLVMCodeGen cg(s, {a, b, c_buf, alpha});
+
+  std::vector<float> av(M * N);
+  std::iota(av.begin(), av.end(), 0);
+  std::vector<float> bv(N);
+  std::iota(bv.begin(), bv.end(), 0);
+  std::vector<float> cv(M * N, 0);
+  cg.call({av, bv, cv, 2.0f});
+
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      ASSERT_EQ(cv[i * N + j], av[i * N + j] + 2.0f * bv[j]);
+    }
+  }
+}
+
 TEST(LLVM, BitwiseOps) {
   KernelScope kernel_scope;
   auto a = IntImm::make(59);
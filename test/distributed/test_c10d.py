@@ -4056,7 +4056,9 @@ class ReducerTest(TestCase):
         buckets = [list(indices) for _, indices in group_by_dtype]
         dist.Reducer(parameters, buckets, self.process_group)
 
-    def _create_reducer_for_models(self, models, find_unused_parameters=False):
+    def _create_reducer_for_models(
+        self, models, find_unused_parameters=False, gradient_as_bucket_view=False
+    ):
         parameters = [list(model.parameters()) for model in models]
         group_by_dtype = groupby(
             range(len(parameters[0])), key=lambda i: parameters[0][i].dtype
@@ -4067,6 +4069,7 @@ class ReducerTest(TestCase):
             buckets,
             self.process_group,
             find_unused_parameters=find_unused_parameters,
+            gradient_as_bucket_view=gradient_as_bucket_view,
         )
 
     def test_forward_backward_single_replica(self):
@@ -4141,6 +4144,66 @@ class ReducerTest(TestCase):
             output.backward()
             optimizer.step()
 
+    def test_gradient_as_bucket_view_before_backward(self):
+        batch_size = 10
+        model = self._create_mixed_precision_model()
+        reducer = self._create_reducer_for_models([model], gradient_as_bucket_view=True)
+        loss = nn.CrossEntropyLoss()
+        input = torch.rand([batch_size, 2], dtype=torch.double)
+        target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+        output = loss(model(input), target)
+        reducer.prepare_for_backward(output)
+
+        # The grads point into the buckets before the backward pass, so that
+        # autograd accumulates into them directly.
+        bucket_ptrs = {
+            tensors[0].storage().data_ptr() for tensors in reducer.get_bucket_tensors()
+        }
+        for parameter in model.parameters():
+            self.assertEqual(torch.zeros_like(parameter), parameter.grad)
+            self.assertIn(parameter.grad.storage().data_ptr(), bucket_ptrs)
+
+        output.backward()
+        for parameter in model.parameters():
+            self.assertIn(parameter.grad.storage().data_ptr(), bucket_ptrs)
+
+    def test_dynamic_bucketing(self):
+        batch_size = 10
+        model = self._create_mixed_precision_model()
+        reference = copy.deepcopy(model)
+        reducer = self._create_reducer_for_models([model])
+        reducer._set_dynamic_bucketing_interval(2)
+        loss = nn.CrossEntropyLoss()
+        for i in range(7):
+            # Buckets are rebuilt in ready order after the first iteration and
+            # may be re-assigned every second iteration after that.
+            rebuilt = reducer._rebuild_buckets()
+            if i == 1:
+                self.assertTrue(rebuilt)
+            elif i in [0, 2]:
+                self.assertFalse(rebuilt)
+
+            model.zero_grad()
+            reference.zero_grad()
+            input = torch.rand([batch_size, 2], dtype=torch.double)
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            loss(reference(input), target).backward()
+
+            # With a single process the reduced grads are the local ones.
+            for parameter, expected in zip(model.parameters(), reference.parameters()):
+                self.assertEqual(expected.grad, parameter.grad)
+
+    def test_dynamic_bucketing_unused_parameters(self):
+        model = self._create_mixed_precision_model()
+        reducer = self._create_reducer_for_models([model], find_unused_parameters=True)
+        with self.assertRaisesRegex(
+            RuntimeError, "Dynamic bucketing does not support find_unused_parameters"
+        ):
+            reducer._set_dynamic_bucketing_interval(2)
+
     def test_ddp_comm_hook_multiple_replica_check(self):
         """
         DDP communication hook does not support single process multiple device mode.
@@ -916,6 +916,32 @@ class TestForeach(TestCase):
         torch._foreach_add_([tensor1], [tensor2])
         self.assertEqual(res, [tensor1])
 
+    @dtypes(torch.float, torch.double)
+    def test_ops_with_chunked_tensors(self, device, dtype):
+        # Sizes that don't line up with the chunks the fused CPU kernels split
+        # the lists into, and tensors that are dense but not contiguous.
+        def make_tensors():
+            tensors = [torch.rand(n, device=device, dtype=dtype) + 1 for n in [1, 7, 100000, 33, 65536]]
+            tensors.append(torch.rand(3, 50, 50, device=device, dtype=dtype).permute(2, 0, 1) + 1)
+            return tensors
+
+        tensors1, tensors2, tensors3 = make_tensors(), make_tensors(), make_tensors()
+        scalars = [float(i + 1) for i in range(len(tensors1))]
+
+        self.assertEqual(torch._foreach_add(tensors1, tensors2, alpha=2),
+                         [torch.add(t1, t2, alpha=2) for t1, t2 in zip(tensors1, tensors2)])
+        self.assertEqual(torch._foreach_mul(tensors1, scalars),
+                         [torch.mul(t, s) for t, s in zip(tensors1, scalars)])
+        self.assertEqual(torch._foreach_sqrt(tensors1), [torch.sqrt(t) for t in tensors1])
+        self.assertEqual(torch._foreach_exp(tensors1), [torch.exp(t) for t in tensors1])
+        self.assertEqual(torch._foreach_addcdiv(tensors1, tensors2, tensors3, scalars),
+                         [torch.addcdiv(t1, t2, t3, value=s) for t1, t2, t3, s in zip(tensors1, tensors2, tensors3, scalars)])
+
+        expected = [torch.addcmul(t1, t2, t3, value=0.5) for t1, t2, t3 in zip(tensors1, tensors2, tensors3)]
+        torch._foreach_addcmul_(tensors1, tensors2, tensors3, 0.5)
+        self.assertEqual(tensors1, expected)
+        self.assertEqual(tensors1[-1].stride(), tensors2[-1].stride())
+
 instantiate_device_type_tests(TestForeach, globals())
 
 if __name__ == '__main__':
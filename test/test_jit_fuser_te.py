@@ -52,6 +52,23 @@ def texpr_reductions_enabled():
     finally:
         torch._C._jit_set_texpr_reductions_enabled(old)
 
+@contextlib.contextmanager
+def te_auto_schedule_mode(mode):
+    old = torch._C._jit_get_te_auto_schedule_mode()
+    torch._C._jit_set_te_auto_schedule_mode(mode)
+    try:
+        yield
+    finally:
+        torch._C._jit_set_te_auto_schedule_mode(old)
+
+@contextlib.contextmanager
+def texpr_dynamic_shapes_enabled():
+    old = torch._C._jit_set_texpr_dynamic_shapes_enabled(True)
+    try:
+        yield
+    finally:
+        torch._C._jit_set_texpr_dynamic_shapes_enabled(old)
+
 class TestTEFuser(JitTestCase):
     def setUp(self):
         self.old_cpu_fuser_state = torch._C._jit_can_fuse_on_cpu()
@@ -222,6 +239,90 @@ class TestTEFuser(JitTestCase):
             ]
             self.checkScript(scaleshift, inputs)
 
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "requires profiling")
+    def test_dynamic_shapes(self):
+        def scaleshift(x, scale, shift):
+            return (x * scale + shift).relu()
+
+        with texpr_dynamic_shapes_enabled():
+            scripted = torch.jit.script(scaleshift)
+            inputs = [torch.randn(4, 8), torch.randn(8), torch.randn(1, 8)]
+            warmup_forward(scripted, *inputs)
+            self.assertAllFused(scripted.graph_for(*inputs))
+
+            # the kernel compiled for a batch of 4 runs for other batch sizes
+            # and falls back when the shapes don't match the symbols
+            for x, scale in [(torch.randn(7, 8), torch.randn(8)),
+                             (torch.randn(1, 8), torch.randn(8)),
+                             (torch.randn(0, 8), torch.randn(8)),
+                             (torch.randn(5, 3), torch.randn(3)),
+                             (torch.randn(8, 8).t(), torch.randn(8))]:
+                shift = torch.randn(1, x.size(1))
+                self.assertEqual(scripted(x, scale, shift), scaleshift(x, scale, shift))
+
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "requires profiling")
+    def test_external_calls(self):
+        def linear_relu(x, w, b):
+            return torch.nn.functional.linear(x, w, b).relu()
+
+        def addmm_sigmoid(b, x, w):
+            return torch.addmm(b, x, w).sigmoid()
+
+        def matmul_add_tanh(x, w, y):
+            return (torch.matmul(x, w) + y).tanh()
+
+        def conv2d_relu(x, w, b):
+            return torch.conv2d(x, w, b, [1, 1], [1, 1], [1, 1], 1).relu()
+
+        cases = [
+            (linear_relu, [torch.randn(4, 8), torch.randn(16, 8), torch.randn(16)]),
+            (addmm_sigmoid, [torch.randn(16), torch.randn(4, 8), torch.randn(8, 16)]),
+            (matmul_add_tanh, [torch.randn(4, 8), torch.randn(8, 16), torch.randn(4, 16)]),
+            (conv2d_relu, [torch.randn(2, 3, 8, 8), torch.randn(4, 3, 3, 3), torch.randn(4)]),
+        ]
+        for fn, inputs in cases:
+            scripted = torch.jit.script(fn)
+            warmup_forward(scripted, *inputs)
+            self.assertAllFused(scripted.graph_for(*inputs))
+            self.assertEqual(scripted(*inputs), fn(*inputs))
+
+    def test_auto_schedule(self):
+        def transposed_add(x, y):
+            return (x + y) * 2
+
+        def row_sum(x):
+            return (x * 2).sum(-1)
+
+        def col_sum(x):
+            return (x * 2).sum(0)
+
+        cases = [
+            (transposed_add, [torch.randn(512, 512), torch.randn(512, 512).t()]),
+            (row_sum, [torch.randn(64, 256)]),
+            (col_sum, [torch.randn(64, 260)]),
+        ]
+        for mode in [1, 2]:
+            with te_auto_schedule_mode(mode), texpr_reductions_enabled():
+                for fn, inputs in cases:
+                    scripted = torch.jit.script(fn)
+                    warmup_forward(scripted, *inputs)
+                    self.assertAllFused(scripted.graph_for(*inputs))
+                    self.assertEqual(scripted(*inputs), fn(*inputs))
+
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "requires profiling")
+    def test_auto_schedule_external_call(self):
+        # Autotuning compiles a kernel per candidate schedule, each of which
+        # contains the external call of the matmul.
+        def matmul_transposed_add(x, y, z):
+            return torch.matmul(x, y) + z
+
+        inputs = [torch.randn(256, 256), torch.randn(256, 256), torch.randn(256, 256).t()]
+        with te_auto_schedule_mode(2):
+            scripted = torch.jit.script(matmul_transposed_add)
+            warmup_forward(scripted, *inputs)
+            self.assertAllFused(scripted.graph_for(*inputs))
+            self.assertEqual(scripted(*inputs), matmul_transposed_add(*inputs))
+
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     @unittest.skipIf(not RUN_CUDA_HALF, "no half support")
     @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.LEGACY, "no half support with profiling on")
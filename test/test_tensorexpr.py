@@ -1,4 +1,6 @@
 import numpy as np
+import os
+import tempfile
 import torch
 import torch.nn.functional as F
 from torch import nn
@@ -7,7 +9,7 @@ import unittest
 from torch.testing._internal.common_utils import suppress_warnings, num_profiled_runs, run_tests
 
 from torch.testing._internal.te_utils import CudaCodeGenCreated, CudaCodeGenExecuted, \
-    LLVMCodeGenExecuted, SimpleIREvalExecuted
+    LLVMCodeGenCacheHit, LLVMCodeGenExecuted, SimpleIREvalExecuted
 
 from torch.testing._internal.jit_utils import JitTestCase
 
@@ -86,6 +88,30 @@ class TestTensorExprFuser(BaseTestClass):
             or simple_ir_eval_executed.elapsed_value() >= 1
         )
 
+    @unittest.skipIf(not torch._C._llvm_enabled(), "LLVM is disabled")
+    def test_llvm_kernel_cache(self):
+        def easy(x, y, z):
+            return torch.add(torch.mul(x, y), z)
+
+        inputs = (torch.rand(1024), torch.rand(1024), torch.rand(1024))
+        old_cache_dir = torch._C._jit_get_te_llvm_kernel_cache_dir()
+        try:
+            with tempfile.TemporaryDirectory() as cache_dir:
+                torch._C._jit_set_te_llvm_kernel_cache_dir(cache_dir)
+                cache_hit = LLVMCodeGenCacheHit()
+                x = warmup_and_run_forward(torch.jit.trace(easy, inputs), *inputs)
+                self.assertLastGraphAllFused()
+                self.assertEqual(cache_hit.elapsed_value(), 0)
+                self.assertEqual(len(os.listdir(cache_dir)), 1)
+
+                # a new kernel for the same graph loads the object code
+                y = warmup_and_run_forward(torch.jit.trace(easy, inputs), *inputs)
+                self.assertEqual(cache_hit.elapsed_value(), 1)
+                self.assertEqual(x, y)
+                self.assertEqual(y, easy(*inputs))
+        finally:
+            torch._C._jit_set_te_llvm_kernel_cache_dir(old_cache_dir)
+
     def test_four_arg(self):
         def run_addcmul(x, y, z, w):
             c = torch.addcmul(torch.add(x, y), z, w)
@@ -67,6 +67,8 @@ def _profiler_enabled() -> bool: ...
 def kineto_available() -> bool: ...
 def _enable_record_function(enable: bool) -> None: ...
 def _set_empty_test_observer(is_global: bool, sampling_prob: float) -> None: ...
+def _set_num_cpu_threads(num_threads: int) -> None: ...
+def _get_num_cpu_threads() -> int: ...
 
 def _enable_profiler_legacy(config: ProfilerConfig) -> None: ...
 def _disable_profiler_legacy() -> List[List[ProfilerEvent]]: ...
@@ -18,9 +18,11 @@
 #include <c10/util/Optional.h>
 #include <c10/core/StreamGuard.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -97,6 +99,9 @@ static thread_local std::shared_ptr<GraphTask> current_graph_task = nullptr;
 // see Note [Reentrant backwards] for more details.
 static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 
+// True on the engine's CPU helper threads, see Note [Parallel CPU backward]
+static thread_local bool in_cpu_helper = false;
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -156,6 +161,34 @@ static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 // the leaf streams with the default streams is sufficient to implement
 // the historic behavior.
 
+// Note [Parallel CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default the CPU nodes of a backward call all run on the thread that
+// called it, one at a time, even when the graph has independent branches
+// that could be differentiated at the same time. When num_cpu_threads() is
+// larger than 1, a top level backward call on CPU also hands its GraphTask to
+// num_cpu_threads() - 1 helper threads. They pop the NodeTasks that are ready
+// from the same cpu_ready_queue_ as the owning thread and run them the way
+// thread_main does, so the dependency counts and the ready queue priorities
+// work as before. The helpers never take the empty tasks used to wake the
+// owning thread up, and they leave the GraphTask as soon as it is completed.
+//
+// Running nodes concurrently changes the order in which the gradients flowing
+// into one node arrive, and the sum computed by InputBuffer would change with
+// it. For such graph tasks, the gradients of a node that is not ready yet are
+// kept in pending_inputs_ and only summed when the last one arrives, in
+// decreasing sequence_nr of the nodes that produced them, which makes the
+// result independent of the scheduling.
+//
+// A reentrant backward call made by a node running on the owning thread
+// shares its ready queue, so it is parallel as well. One made on a helper
+// thread is treated as a new top level call on that thread and does not get
+// helpers of its own.
+//
+// The helper threads are kept in a pool like the one of Note [Reentrant
+// backwards] rather than on the intra-op or inter-op thread pools, as they
+// block until their GraphTask is completed.
+
 int NodeTask::getReentrantDepth() const {
   std::shared_ptr<GraphTask> graph_task = base_.lock();
   if (graph_task) {
@@ -168,7 +201,17 @@ int NodeTask::getReentrantDepth() const {
   }
 }
 
+namespace {
+
+// Whether pop_node_task() takes the task
+bool isNodeTask(const NodeTask& task) {
+  return task.fn_ && !task.isShutdownTask_;
+}
+
+} // namespace
+
 auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
+  const bool is_node_task = isNodeTask(item);
   {
     // Lock mutex for writing to heap_
     std::lock_guard<std::mutex> lock(mutex_);
@@ -180,6 +223,9 @@ auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
     heap_.push(std::move(item));
   }
   not_empty_.notify_one();
+  if (is_node_task) {
+    node_task_available_.notify_one();
+  }
 }
 
 auto ReadyQueue::pushShutdownTask() -> void {
@@ -202,9 +248,41 @@ auto ReadyQueue::pop() -> NodeTask {
   not_empty_.wait(lock, [this]{ return !heap_.empty(); });
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  // Empty and shutdown tasks sort first, so a NodeTask below the popped task
+  // wasn't available to pop_node_task() yet
+  const bool uncovered_node_task =
+      !isNodeTask(task) && !heap_.empty() && isNodeTask(heap_.top());
+  lock.unlock();
+  if (uncovered_node_task) {
+    node_task_available_.notify_one();
+  }
+  return task;
+}
+
+auto ReadyQueue::pop_node_task(const std::function<bool()>& stop) -> c10::optional<NodeTask> {
+  // Lock mutex for accesses to heap_
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Empty and shutdown tasks sort first, so a NodeTask on top means that the
+  // owning thread has nothing else to be woken up for
+  node_task_available_.wait(lock, [this, &stop]{
+    return stop() || (!heap_.empty() && isNodeTask(heap_.top()));
+  });
+  if (stop()) {
+    return c10::nullopt;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
   return task;
 }
 
+void ReadyQueue::wake_all() {
+  {
+    // Lock mutex so that no thread is between checking stop() and waiting
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  node_task_available_.notify_all();
+}
+
 bool ReadyQueue::empty() const {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
@@ -213,6 +291,23 @@ bool ReadyQueue::empty() const {
 
 Engine::Engine() : max_recursion_depth_(MAX_DEPTH), non_reentrant_device_thread_count_(0) {}
 
+static std::atomic<int>& cpu_threads() {
+  static std::atomic<int> num_threads{[]() {
+    const char* env = std::getenv("TORCH_AUTOGRAD_CPU_THREADS");
+    return env ? std::max(std::atoi(env), 1) : 1;
+  }()};
+  return num_threads;
+}
+
+void Engine::set_num_cpu_threads(int num_threads) {
+  TORCH_CHECK(num_threads > 0, "Expected a positive number of autograd CPU threads, but got ", num_threads);
+  cpu_threads().store(num_threads);
+}
+
+int Engine::num_cpu_threads() {
+  return cpu_threads().load();
+}
+
 // Send shutdown tasks to all device_ready_queues_ if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest priority
 Engine::~Engine() {
@@ -438,6 +533,73 @@ void Engine::reentrant_thread_init() {
   }
 }
 
+// Runs the CPU work of graph_task that is ready in parallel with its owning
+// thread, until graph_task is completed. See Note [Parallel CPU backward]
+void Engine::cpu_helper_main(const std::shared_ptr<GraphTask>& graph_task) {
+  auto queue = graph_task->cpu_ready_queue_;
+  auto stop = [&graph_task]() { return graph_task->future_completed_.load(); };
+  while (true) {
+    // local_graph_task is the graph_task of the popped NodeTask, which is a
+    // reentrant child of graph_task when it is not graph_task itself.
+    std::shared_ptr<GraphTask> local_graph_task;
+    {
+      c10::optional<NodeTask> task = queue->pop_node_task(stop);
+      if (!task) {
+        break;
+      }
+
+      if (!(local_graph_task = task->base_.lock())) {
+        // GraphTask for function is no longer valid, skipping further
+        // execution.
+        continue;
+      }
+
+      if (!local_graph_task->has_error_.load()) {
+        AutoGradMode grad_mode(local_graph_task->grad_mode_);
+        try {
+          GraphTaskGuard guard(local_graph_task);
+          NodeGuard ndguard(task->fn_);
+          evaluate_function(local_graph_task, task->fn_.get(), task->inputs_, local_graph_task->cpu_ready_queue_);
+        } catch (std::exception& e) {
+          thread_on_exception(local_graph_task, task->fn_, e);
+        }
+      }
+    }
+
+    // Decrement the outstanding tasks.
+    --local_graph_task->outstanding_tasks_;
+
+    if (local_graph_task->completed()) {
+      local_graph_task->mark_as_completed_and_run_post_processing();
+      // A helper is never the owning thread, which might be sleeping on pop(),
+      // see the same case in thread_main.
+      std::atomic_thread_fence(std::memory_order_release);
+      ready_queue_by_index(local_graph_task->cpu_ready_queue_, local_graph_task->owner_)
+          ->push(NodeTask(local_graph_task, nullptr, InputBuffer(0)));
+    }
+  }
+}
+
+void Engine::cpu_helper_thread_init() {
+  at::init_num_threads();
+  in_cpu_helper = true;
+  auto tp_shared = cpu_helper_pool_shared_;
+  while(true) {
+    std::unique_lock<std::mutex> lk(tp_shared->mutex_);
+    ++tp_shared->num_workers_;
+    tp_shared->work_.wait(lk, [&tp_shared]{ return !tp_shared->graphtasks_queue_.empty();});
+    --tp_shared->num_workers_;
+    auto task = tp_shared->graphtasks_queue_.front();
+    tp_shared->graphtasks_queue_.pop();
+    lk.unlock();
+    std::shared_ptr<GraphTask> graph_task;
+    if (!(graph_task = task.lock())) {
+      continue;
+    }
+    cpu_helper_main(graph_task);
+  }
+}
+
 void Engine::thread_on_exception(
     std::shared_ptr<GraphTask> graph_task,
     const std::shared_ptr<Node>& fn,
@@ -475,6 +637,10 @@ void GraphTask::mark_as_completed_and_run_post_processing() {
   } catch (std::exception& e) {
     future_result_->setErrorIfNeeded(std::current_exception());
   }
+  if (parallel_cpu_) {
+    // Release the helper threads waiting for more work of this graph task
+    cpu_ready_queue_->wake_all();
+  }
 }
 
 void GraphTask::exec_post_processing() {
@@ -526,6 +692,9 @@ void GraphTask::set_exception(
   set_exception_without_signal(fn);
   if (!future_completed_.exchange(true)) {
     future_result_->setError(std::move(eptr));
+    if (parallel_cpu_) {
+      cpu_ready_queue_->wake_all();
+    }
   }
 }
 
@@ -689,6 +858,52 @@ static variable_list call_function(
   return outputs;
 }
 
+// Adds output, computed by producer, to the input_buffer of next. When the
+// graph task runs on several CPU threads, the gradients are kept aside until
+// next is ready and then added in a deterministic order.
+// See Note [Parallel CPU backward]
+static void accumulate_input(
+    GraphTask& graph_task,
+    InputBuffer& input_buffer,
+    const Edge& next,
+    const Node& producer,
+    Variable&& output,
+    const c10::optional<c10::Stream>& opt_producer_stream,
+    bool is_ready) {
+  const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
+  auto& pending_inputs = graph_task.pending_inputs_;
+  auto pending_it = pending_inputs.find(next.function.get());
+  if (!graph_task.parallel_cpu_ || (is_ready && pending_it == pending_inputs.end())) {
+    input_buffer.add(next.input_nr,
+                     std::move(output),
+                     opt_producer_stream,
+                     opt_next_stream);
+    return;
+  }
+
+  if (pending_it == pending_inputs.end()) {
+    pending_it = pending_inputs.emplace(next.function.get(), std::vector<GraphTask::PendingInput>()).first;
+  }
+  auto& pending = pending_it->second;
+  pending.push_back({producer.sequence_nr(), next.input_nr, std::move(output), opt_producer_stream});
+  if (!is_ready) {
+    return;
+  }
+  // Nodes with a higher sequence_nr are run first when the graph task has a
+  // single thread. Ties come from the same producer and keep their order.
+  std::stable_sort(pending.begin(), pending.end(),
+      [](const GraphTask::PendingInput& a, const GraphTask::PendingInput& b) {
+        return a.producer_sequence_nr > b.producer_sequence_nr;
+      });
+  for (auto& input : pending) {
+    input_buffer.add(input.input_nr,
+                     std::move(input.var),
+                     input.producer_stream,
+                     opt_next_stream);
+  }
+  pending_inputs.erase(pending_it);
+}
+
 void Engine::evaluate_function(
     std::shared_ptr<GraphTask>& graph_task,
     Node* func,
@@ -785,11 +1000,7 @@ void Engine::evaluate_function(
       InputBuffer input_buffer(next.function->num_inputs());
 
       // Accumulates into buffer
-      const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      accumulate_input(*graph_task, input_buffer, next, fn, std::move(output), opt_parent_stream, is_ready);
 
       if (is_ready) {
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
@@ -803,11 +1014,7 @@ void Engine::evaluate_function(
       auto &input_buffer = not_ready_it->second;
 
       // Accumulates into buffer
-      const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      accumulate_input(*graph_task, input_buffer, next, fn, std::move(output), opt_parent_stream, is_ready);
       if (is_ready) {
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
         queue->push(
@@ -928,6 +1135,10 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
     // set the graph_task owner to the current device
     graph_task->owner_ = worker_device;
 
+    // See Note [Parallel CPU backward]
+    const int num_threads = in_cpu_helper ? 1 : num_cpu_threads();
+    graph_task->parallel_cpu_ = num_threads > 1;
+
     // Now that all the non-thread safe fields of the graph_task have been populated,
     // we can enqueue it.
     queue->push(NodeTask(graph_task, std::move(graph_root), std::move(input_buffer)));
@@ -935,6 +1146,9 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
     // The owning thread start to drive the engine execution for any CPU task that
     // was just pushed or will be added later from other worker threads
     lock.unlock();
+    if (graph_task->parallel_cpu_) {
+      add_cpu_helper_tasks(graph_task, num_threads - 1);
+    }
     thread_main(graph_task);
     TORCH_INTERNAL_ASSERT(graph_task->future_result_->completed());
     // reset the worker_device after the completion of the graph_task, this is so
@@ -947,6 +1161,11 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
     //    backward call from that device.
     graph_task->owner_ = worker_device;
 
+    // A reentrant call from a parallel graph task on CPU shares its ready
+    // queue with the helper threads. See Note [Parallel CPU backward]
+    graph_task->parallel_cpu_ = worker_device == CPU_DEVICE &&
+        current_graph_task && current_graph_task->parallel_cpu_;
+
     // Now that all the non-thread safe fields of the graph_task have been populated,
     // we can enqueue it.
     queue->push(NodeTask(graph_task, std::move(graph_root), std::move(input_buffer)));
@@ -1078,6 +1297,7 @@ auto Engine::start_device_threads() -> void {
   }
 
   thread_pool_shared_ = std::make_shared<ThreadPoolShared>();
+  cpu_helper_pool_shared_ = std::make_shared<ThreadPoolShared>();
 
   for (int i = 0; i < num_devices; ++i) {
     std::thread t(&Engine::thread_init, this, i, device_ready_queues_[i], true);
@@ -1110,6 +1330,29 @@ void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   thread_pool_shared_->work_.notify_one();
 }
 
+void Engine::add_cpu_helper_tasks(
+    const std::shared_ptr<GraphTask>& graph_task,
+    int num_helpers) {
+  std::unique_lock<std::mutex> lck(cpu_helper_pool_shared_->mutex_);
+  auto& graphtasks_queue = cpu_helper_pool_shared_->graphtasks_queue_;
+  for (int i = 0; i < num_helpers; ++i) {
+    graphtasks_queue.push(graph_task);
+  }
+  // Idle helpers pick the new entries up, entries for completed graph tasks
+  // are dropped quickly, so only the missing threads are created
+  const size_t num_workers = cpu_helper_pool_shared_->num_workers_;
+  const size_t num_new_threads = graphtasks_queue.size() > num_workers
+      ? graphtasks_queue.size() - num_workers
+      : 0;
+  // Don't need to be holding the lock while actually creating the threads
+  lck.unlock();
+  for (size_t i = 0; i < num_new_threads; ++i) {
+    std::thread t(&Engine::cpu_helper_thread_init, this);
+    t.detach();
+  }
+  cpu_helper_pool_shared_->work_.notify_all();
+}
+
 void GraphTask::init_to_execute(Node& graph_root, const edge_list& outputs, bool accumulate_grad) {
   exec_info_[&graph_root].needed_ = true;
   int output_idx = 0;
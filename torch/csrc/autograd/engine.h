@@ -6,6 +6,7 @@
 #include <ATen/Tensor.h>
 #include <ATen/core/ivalue.h>
 #include <ATen/ThreadLocalState.h>
+#include <c10/util/Optional.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
 #include <torch/csrc/autograd/function.h>
@@ -56,12 +57,25 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   bool keep_graph_;
   bool grad_mode_;
 
-  // To protect reads/writes to not_ready_, dependencies_, captured_vars_,
-  // has_error_, future_result_, cpu_ready_queue_, and leaf_streams.
+  // To protect reads/writes to not_ready_, dependencies_, pending_inputs_,
+  // captured_vars_, has_error_, future_result_, cpu_ready_queue_, and
+  // leaf_streams.
   std::mutex mutex_;
   std::unordered_map<Node*, InputBuffer> not_ready_;
   std::unordered_map<Node*, int> dependencies_;
 
+  // Gradients received by a node that is not ready yet, when parallel_cpu_ is
+  // set. They are summed into its InputBuffer once it becomes ready, in an
+  // order that does not depend on which thread produced them first.
+  // See Note [Parallel CPU backward]
+  struct PendingInput {
+    uint64_t producer_sequence_nr;
+    size_t input_nr;
+    Variable var;
+    c10::optional<c10::Stream> producer_stream;
+  };
+  std::unordered_map<Node*, std::vector<PendingInput>> pending_inputs_;
+
   struct ExecInfo {
     struct Capture {
       Capture(const Capture&) = delete;
@@ -118,6 +132,11 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   // The number of parent graph tasks for this graph task
   const int reentrant_depth_;
 
+  // Whether the tasks in cpu_ready_queue_ may also be run by the engine's CPU
+  // helper threads. Set before the root is queued and safe to read without
+  // synchronization afterwards. See Note [Parallel CPU backward]
+  bool parallel_cpu_ = false;
+
   bool can_checkpoint() {
     return exec_info_.empty();
   }
@@ -236,6 +255,10 @@ struct ReadyQueue {
 
   // To notify threads waiting on the ReadyQueue of available tasks on the heap_
   std::condition_variable not_empty_;
+  // To notify the helper threads waiting in pop_node_task() of available
+  // NodeTasks. They reject the other tasks, so they must not consume the
+  // notifications of not_empty_ that are meant for the owning thread.
+  std::condition_variable node_task_available_;
   // To protect read and writes to heap_
   mutable std::mutex mutex_;
 
@@ -249,6 +272,11 @@ struct ReadyQueue {
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
   NodeTask pop();
+  // Pops the next task that runs a Node, leaving empty and shutdown tasks to
+  // the thread that owns this queue. Returns nullopt once stop() is true.
+  c10::optional<NodeTask> pop_node_task(const std::function<bool()>& stop);
+  // Wakes up every thread blocked in pop_node_task() to re-check stop().
+  void wake_all();
   bool empty() const;
   size_t size() const;
 };
@@ -318,6 +346,13 @@ struct TORCH_API Engine {
       const std::shared_ptr<ReadyQueue>& ready_queue,
       bool should_increment = true);
 
+  // Number of threads that run the ready CPU nodes of a backward call,
+  // counting the thread that called it. The default of 1 runs them on the
+  // calling thread only; it can be set with TORCH_AUTOGRAD_CPU_THREADS.
+  // See Note [Parallel CPU backward]
+  static void set_num_cpu_threads(int num_threads);
+  static int num_cpu_threads();
+
  protected:
   Engine();
   void compute_dependencies(Node* root, GraphTask& task);
@@ -341,6 +376,11 @@ struct TORCH_API Engine {
   virtual void thread_main(const std::shared_ptr<GraphTask>& task);
   void reentrant_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  void cpu_helper_thread_init();
+  void cpu_helper_main(const std::shared_ptr<GraphTask>& graph_task);
+  void add_cpu_helper_tasks(
+      const std::shared_ptr<GraphTask>& graph_task,
+      int num_helpers);
 
   // Ensures device_ready_queues_ are initialized only once
   std::once_flag start_device_threads_flag_;
@@ -377,6 +417,10 @@ struct TORCH_API Engine {
  // for the graphtasks_queue_ to be nonempty.
  std::shared_ptr<ThreadPoolShared> thread_pool_shared_;
 
+ // Same structure, for the threads helping the owning thread of a GraphTask
+ // with its CPU work. See Note [Parallel CPU backward]
+ std::shared_ptr<ThreadPoolShared> cpu_helper_pool_shared_;
+
 private:
   // Number of non-reentrant threads
   std::atomic<uint32_t> non_reentrant_device_thread_count_;
@@ -4,6 +4,7 @@
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/utils/pybind.h>
 #include <torch/csrc/autograd/autograd.h>
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <ATen/autocast_mode.h>
 #include <torch/csrc/autograd/profiler.h>
@@ -197,6 +198,12 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   m.def("_clear_callbacks", []() {
     at::clearCallbacks();
   });
+  m.def("_set_num_cpu_threads", [](int num_threads) {
+    torch::autograd::Engine::set_num_cpu_threads(num_threads);
+  });
+  m.def("_get_num_cpu_threads", []() {
+    return torch::autograd::Engine::num_cpu_threads();
+  });
 
   Py_RETURN_TRUE;
 }
@@ -224,9 +224,12 @@ PyObject* c10d_init(PyObject* _unused, PyObject* noargs) {
           py::call_guard<py::gil_scoped_release>());
 
   py::enum_<::c10d::BuiltinCommHookType>(module, "BuiltinCommHookType", R"(
-An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_COMPRESS``.)")
+An enum-like class for built-in communication hooks: ``ALLREDUCE``, ``FP16_COMPRESS``,
+``POWER_SGD`` and ``TOP_K``.)")
       .value("ALLREDUCE", ::c10d::BuiltinCommHookType::ALLREDUCE)
-      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS);
+      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS)
+      .value("POWER_SGD", ::c10d::BuiltinCommHookType::POWER_SGD)
+      .value("TOP_K", ::c10d::BuiltinCommHookType::TOP_K);
 
   shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
       .def(
@@ -276,6 +279,10 @@ An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_CO
           "_set_forward_pass_work_handle",
           &::c10d::Reducer::set_forward_pass_work_handle,
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_dynamic_bucketing_interval",
+          &::c10d::Reducer::set_dynamic_bucketing_interval,
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "_get_local_used_maps",
           &::c10d::Reducer::get_local_used_maps_on_device);
@@ -956,7 +963,12 @@ Arguments:
       .def(py::init<>())
       .def_readwrite("devices", &::c10d::ProcessGroupGloo::Options::devices)
       .def_readwrite("timeout", &::c10d::ProcessGroupGloo::Options::timeout)
-      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads);
+      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads)
+      .def_readwrite(
+          "hierarchical_allreduce",
+          &::c10d::ProcessGroupGloo::Options::hierarchicalAllreduce)
+      .def_readwrite(
+          "hostname", &::c10d::ProcessGroupGloo::Options::hostname);
 
   processGroupGloo.def_static(
       "create_device",
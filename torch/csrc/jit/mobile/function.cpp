@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/mobile/interpreter.h>
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/runtime/operator.h>
+#include <torch/csrc/jit/runtime/unboxed_ops.h>
 #include <torch/custom_class_detail.h>
 
 namespace torch {
@@ -58,6 +59,13 @@ bool Function::append_operator(
     }
   }
 
+  if (auto handle = c10::Dispatcher::singleton().findSchema(opname_c10)) {
+    auto boxed = [fn](Stack* stack) { fn(*stack); };
+    if (auto unboxed = createUnboxedOperation(*handle, boxed)) {
+      fn = [op = std::move(*unboxed)](Stack& stack) { op(&stack); };
+    }
+  }
+
   if (model_version == 0x3L &&
       model_version < caffe2::serialize::kProducedBytecodeVersion &&
       opname == c10::OperatorName("aten::_convolution", "")) {
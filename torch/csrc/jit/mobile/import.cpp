@@ -183,7 +183,7 @@ void parseMethods(
       int X = ins_item[1].toInt();
       int N = ins_item[2].toInt();
       function->append_instruction(op_code, X, N);
-      if (op_code == OP) {
+      if (op_code == OP || op_code == OPR) {
         std::string module_debug_info = (has_debug_info)
             ? module_debug_info_list[X].toString()->string()
             : "";
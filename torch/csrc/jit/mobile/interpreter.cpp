@@ -21,6 +21,34 @@ InterpreterState::InterpreterState(std::shared_ptr<Code> code)
 
 using namespace at;
 
+namespace {
+
+// Reports operator X, whose inputs are on top of the stack, to the observers
+// before it runs.
+void recordOperator(const Code& code, size_t pc, int32_t X, Stack& stack) {
+  if (at::hasGlobalCallbacks()) {
+    if (auto* mobile_debug_info =
+            static_cast<MobileDebugInfo*>(c10::ThreadLocalDebugInfo::get(
+                c10::DebugInfoKind::MOBILE_RUNTIME_INFO))) {
+      mobile_debug_info->setOpIdx(pc);
+    }
+  }
+
+  // TODO(iliacher): remove the workaround after RecordFunction is in
+  // Dispatcher
+  bool prev_value = isRecordFunctionEnabled();
+  if (!prev_value) {
+    // enable only for the RecordFunction
+    enableRecordFunction(true);
+  }
+  RECORD_USER_SCOPE_WITH_INPUTS(code.op_names_[X].name, stack);
+  if (!prev_value) {
+    enableRecordFunction(false);
+  }
+}
+
+} // namespace
+
 bool InterpreterState::run(Stack& stack) {
   size_t pc = 0;
   while (true) {
@@ -36,27 +64,26 @@ bool InterpreterState::run(Stack& stack) {
     //    std::cout << std::endl;
     switch (inst.op) {
       case OP: {
-        if (at::hasGlobalCallbacks()) {
-          if (auto* mobile_debug_info =
-                  static_cast<MobileDebugInfo*>(c10::ThreadLocalDebugInfo::get(
-                      c10::DebugInfoKind::MOBILE_RUNTIME_INFO))) {
-            mobile_debug_info->setOpIdx(pc);
+        recordOperator(*code_, pc, inst.X, stack);
+        code_->operators_[inst.X](stack);
+        ++pc;
+      } break;
+      case OPR: {
+        const Instruction* operands = &code_->instructions_[pc + 1];
+        size_t i = 0;
+        for (; i < inst.N && operands[i].N != REG_STORE; ++i) {
+          if (operands[i].N == REG_MOVE) {
+            stack.emplace_back(std::move(reg(operands[i].X)));
+          } else {
+            stack.emplace_back(reg(operands[i].X));
           }
         }
-
-        // TODO(iliacher): remove the workaround after RecordFunction is in
-        // Dispatcher
-        bool prev_value = isRecordFunctionEnabled();
-        if (!prev_value) {
-          // enable only for the RecordFunction
-          enableRecordFunction(true);
-        }
-        RECORD_USER_SCOPE_WITH_INPUTS(code_->op_names_[inst.X].name, stack);
-        if (!prev_value) {
-          enableRecordFunction(false);
-        }
+        recordOperator(*code_, pc, inst.X, stack);
         code_->operators_[inst.X](stack);
-        ++pc;
+        for (size_t j = inst.N; j > i; --j) {
+          reg(operands[j - 1].X) = pop(stack);
+        }
+        pc += inst.N + 1;
       } break;
       case OPN: {
         stack.push_back(inst.N);
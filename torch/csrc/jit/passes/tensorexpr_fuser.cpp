@@ -1,5 +1,6 @@
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 
+#include <ATen/ExpandUtils.h>
 #include <ATen/record_function.h>
 #include <c10/util/FunctionRef.h>
 #include <torch/csrc/jit/codegen/fuser/interface.h>
@@ -27,6 +28,7 @@ namespace torch {
 namespace jit {
 
 static bool texpr_reductions_enabled = false;
+static bool texpr_dynamic_shapes_enabled = false;
 
 bool isSupportedForBlock(Node* node) {
   switch (node->kind()) {
@@ -164,6 +166,59 @@ static const OperatorSet& supported_eltwise_set() {
   return supported_eltwise_set;
 }
 
+// Ops that are lowered to calls of the ATen kernels, see
+// TensorExprKernel::computeExternalCall.
+static const OperatorSet& supported_external_call_set() {
+  // clang-format off
+  static const OperatorSet supported_external_call_set{
+      "aten::matmul(Tensor self, Tensor other) -> Tensor",
+      "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor",
+      "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor",
+      "aten::conv2d(Tensor input, Tensor weight, Tensor? bias=None, int[2] stride=1, int[2] padding=0, int[2] dilation=1, int groups=1) -> Tensor",
+  };
+  // clang-format on
+  return supported_external_call_set;
+}
+
+static bool isExternalCall(Node* node) {
+  return node->isMemberOf(supported_external_call_set());
+}
+
+// The tensors are passed to the ATen kernel as they are, so they have to be
+// contiguous CPU tensors of a single floating point dtype, and all the other
+// arguments have to be constant.
+static bool isSupportedExternalCall(Node* node) {
+  auto device = tensorexpr::pickDeviceType(node->inputs());
+  if (!device || !device->is_cpu()) {
+    return false;
+  }
+  auto const& outType = node->output()->type()->cast<TensorType>();
+  if (!outType || !outType->scalarType() ||
+      !isFloatingType(*outType->scalarType())) {
+    return false;
+  }
+  for (Value* v : node->inputs()) {
+    if (auto const& tt = v->type()->cast<TensorType>()) {
+      if (!tt->isComplete() || tt->scalarType() != outType->scalarType() ||
+          *tt->strides().concrete_sizes() !=
+              TensorType::contiguousStridesOf(*tt->sizes().concrete_sizes())) {
+        return false;
+      }
+    } else if (!v->type()->cast<NoneType>() && !toIValue(v)) {
+      return false;
+    }
+  }
+  if (node->kind() == aten::addmm) {
+    for (auto arg_name : {"beta", "alpha"}) {
+      auto index = node->schema().argumentIndexWithName(arg_name);
+      if (toIValue(node->input(*index))->toScalar().toDouble() != 1.0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool isSupported(Node* node) {
   // For Block codegen we allow limited ops.
   if (tensorexpr::getTEGenerateBlockCode()) {
@@ -185,6 +240,10 @@ bool isSupported(Node* node) {
   };
   // clang-format on
 
+  if (isExternalCall(node)) {
+    return isSupportedExternalCall(node);
+  }
+
   if (node->isMemberOf(supported_eltwise_set()) ||
       node->isMemberOf(supported_misc_set) ||
       (texpr_reductions_enabled && node->isMemberOf(supported_reduction_set))) {
@@ -267,6 +326,16 @@ bool texprReductionsEnabled() {
   return texpr_reductions_enabled;
 }
 
+bool setTexprDynamicShapesEnabled(bool value) {
+  bool old_value = texpr_dynamic_shapes_enabled;
+  texpr_dynamic_shapes_enabled = value;
+  return old_value;
+}
+
+bool texprDynamicShapesEnabled() {
+  return texpr_dynamic_shapes_enabled;
+}
+
 void removeProfileNodesAndSpecializeTypes(Block* b) {
   for (auto it = b->nodes().begin(); it != b->nodes().end(); it++) {
     if (it->kind() == prim::profile) {
@@ -947,6 +1016,34 @@ class TensorExprFuser {
     return true;
   }
 
+  // Whether a tensor that node reads from other is an input of an external
+  // call in node (or in its subgraph, if node is a fusion group).
+  bool readsExternalCallInputFrom(Node* node, Node* other) {
+    // Tensor constants are lifted to fusion group inputs.
+    if (other->kind() == prim::Constant) {
+      return false;
+    }
+    for (size_t i = 0; i < node->inputs().size(); i++) {
+      Value* input = node->input(i);
+      if (input->node() != other || !input->type()->cast<TensorType>()) {
+        continue;
+      }
+      if (node->kind() != prim::TensorExprGroup) {
+        if (tensorexpr::isExternalCall(node)) {
+          return true;
+        }
+        continue;
+      }
+      auto subgraph = SubgraphUtils::getSubgraph(node);
+      for (const Use& use : subgraph->inputs()[i]->uses()) {
+        if (tensorexpr::isExternalCall(use.user)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
 #define REQ(cond)                           \
   if (!(cond)) {                            \
     GRAPH_DEBUG("Failed cond " #cond "\n"); \
@@ -1014,6 +1111,10 @@ class TensorExprFuser {
     // Alias checks
     REQ(aliasDb_->couldMoveBeforeTopologically(producer, consumer));
 
+    // Tensors passed to external calls must be inputs of the fusion group
+    REQ(!readsExternalCallInputFrom(consumer, producer));
+    REQ(!readsExternalCallInputFrom(producer, consumer));
+
     // Ops that return aliases can only be folded if this is the only use.
     if (producer->kind() == aten::slice ||
         producer->kind() == aten::unsqueeze ||
@@ -1106,6 +1207,22 @@ class TensorExprFuser {
     for (Node* fusion_group : fusion_groups) {
       removeOutputsUsedOnlyInSize(fusion_group);
       liftTensorConstantsFromFusionGroups(fusion_group);
+      if (texpr_dynamic_shapes_enabled && generalizeShapes(fusion_group)) {
+        // Sizes and strides are checked by the kernel, which falls back to
+        // the interpreter when they don't fit the compiled shapes.
+        insertTypeGuard(
+            fusion_group,
+            [](const TensorTypePtr& t) {
+              return TensorType::create(
+                  t->scalarType(),
+                  t->device(),
+                  c10::SymbolicShape(t->sizes().size()),
+                  c10::VaryingShape<c10::Stride>(),
+                  t->requiresGrad());
+            },
+            prim::TypeCheck);
+        continue;
+      }
       insertTypeGuard(
           fusion_group,
           [](const TensorTypePtr& t) { return t; },
@@ -1113,6 +1230,89 @@ class TensorExprFuser {
     }
   }
 
+  static bool isContiguousCPUTensor(Value* v) {
+    auto tt = v->type()->cast<TensorType>();
+    if (!tt->isComplete() || !tt->device()->is_cpu() || *tt->dim() == 0) {
+      return false;
+    }
+    return *tt->strides().concrete_sizes() ==
+        TensorType::contiguousStridesOf(*tt->sizes().concrete_sizes());
+  }
+
+  // Replaces the profiled sizes in the subgraph of the fusion group with shape
+  // symbols, so that its kernel is compiled once for all of them. Dims of the
+  // same size share a symbol and dims of size 1 stay static, which keeps the
+  // broadcasts of the profiled run. Only groups of elementwise ops on
+  // contiguous CPU tensors are generalized; returns false for the others.
+  bool generalizeShapes(Node* fusion_group) {
+    auto subgraph = SubgraphUtils::getSubgraph(fusion_group);
+    for (Value* input : subgraph->inputs()) {
+      if (input->type()->cast<TensorType>() && !isContiguousCPUTensor(input)) {
+        return false;
+      }
+    }
+    for (Node* n : subgraph->nodes()) {
+      if (n->kind() == prim::Constant) {
+        continue;
+      }
+      if (n->kind() == aten::sum || n->kind() == aten::softmax ||
+          n->kind() == aten::log_softmax || tensorexpr::isExternalCall(n)) {
+        return false;
+      }
+      std::vector<int64_t> broadcast_sizes;
+      for (Value* input : n->inputs()) {
+        if (auto tt = input->type()->cast<TensorType>()) {
+          broadcast_sizes =
+              at::infer_size(broadcast_sizes, *tt->sizes().concrete_sizes());
+        }
+      }
+      for (Value* output : n->outputs()) {
+        if (!output->type()->cast<TensorType>() ||
+            !isContiguousCPUTensor(output) ||
+            *output->type()->expect<TensorType>()->sizes().concrete_sizes() !=
+                broadcast_sizes) {
+          return false;
+        }
+      }
+    }
+
+    std::unordered_map<int64_t, c10::ShapeSymbol> symbols;
+    auto generalize = [&](Value* v) {
+      auto tt = v->type()->cast<TensorType>();
+      if (!tt) {
+        return;
+      }
+      std::vector<c10::ShapeSymbol> dims;
+      for (int64_t size : *tt->sizes().concrete_sizes()) {
+        if (size == 1) {
+          dims.push_back(c10::ShapeSymbol::fromStaticSize(1));
+          continue;
+        }
+        auto it = symbols.find(size);
+        if (it == symbols.end()) {
+          it = symbols.emplace(size, c10::ShapeSymbol::newSymbol()).first;
+        }
+        dims.push_back(it->second);
+      }
+      v->setType(TensorType::create(
+          tt->scalarType(),
+          tt->device(),
+          c10::SymbolicShape(dims),
+          c10::VaryingShape<c10::Stride>(dims.size()),
+          tt->requiresGrad()));
+    };
+    for (Value* input : subgraph->inputs()) {
+      generalize(input);
+    }
+    for (Node* n : subgraph->nodes()) {
+      for (Value* output : n->outputs()) {
+        generalize(output);
+      }
+    }
+    GRAPH_DEBUG("Generalized shapes of ", getHeader(fusion_group));
+    return true;
+  }
+
   std::shared_ptr<Graph> graph_;
   std::unique_ptr<AliasDb> aliasDb_ = nullptr;
 
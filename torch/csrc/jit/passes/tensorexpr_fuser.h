@@ -24,6 +24,11 @@ TORCH_API void setTensorExprFuserEnabled(bool val);
 TORCH_API bool tensorExprFuserEnabled();
 TORCH_API bool setTexprReductionsEnabled(bool value);
 TORCH_API bool texprReductionsEnabled();
+// If enabled, fusion groups of elementwise CPU ops are compiled with symbolic
+// sizes and guarded only on rank, dtype and contiguity, so that one kernel
+// serves inputs of every size.
+TORCH_API bool setTexprDynamicShapesEnabled(bool value);
+TORCH_API bool texprDynamicShapesEnabled();
 
 TORCH_API void RemoveProfileNodesAndSpecializeTypes(
     std::shared_ptr<Graph>& graph);
@@ -78,6 +78,7 @@
 #include <torch/csrc/jit/runtime/argument_spec.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/runtime/jit_exception.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/print_handler.h>
@@ -86,6 +87,7 @@
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/kernel.h>
+#include <torch/csrc/jit/tensorexpr/llvm_codegen.h>
 #include <torch/csrc/jit/tensorexpr/tensorexpr_init.h>
 
 #include <c10/macros/Export.h>
@@ -534,6 +536,16 @@ void initJITBindings(PyObject* module) {
             getExecutorMode() = profiling_flag;
             return oldState;
           })
+      .def(
+          "_jit_set_mobile_register_operands_enabled",
+          [](bool enabled) {
+            return getMobileRegisterOperandsEnabled().exchange(enabled);
+          })
+      .def(
+          "_jit_set_interpreter_superinstructions_enabled",
+          [](bool enabled) {
+            return getInterpreterSuperinstructionsEnabled().exchange(enabled);
+          })
       .def(
           "_jit_set_num_profiled_runs",
           [](size_t num) {
@@ -620,6 +632,10 @@ void initJITBindings(PyObject* module) {
       .def("_jit_texpr_set_fallback_allowed", &tensorexpr::setFallbackAllowed)
       .def("_jit_set_texpr_reductions_enabled", &setTexprReductionsEnabled)
       .def("_jit_texpr_reductions_enabled", &texprReductionsEnabled)
+      .def(
+          "_jit_set_texpr_dynamic_shapes_enabled",
+          &setTexprDynamicShapesEnabled)
+      .def("_jit_texpr_dynamic_shapes_enabled", &texprDynamicShapesEnabled)
       .def(
           "_jit_set_te_generate_block_code",
           [](bool gen_block_code) {
@@ -632,6 +648,30 @@ void initJITBindings(PyObject* module) {
             using namespace torch::jit::tensorexpr;
             return getTEGenerateBlockCode();
           })
+      .def(
+          "_jit_get_te_cpu_parallel_min_elements",
+          []() -> int64_t {
+            using namespace torch::jit::tensorexpr;
+            return getTECPUParallelMinElements();
+          })
+      .def(
+          "_jit_set_te_cpu_parallel_min_elements",
+          [](int64_t min_elements) {
+            using namespace torch::jit::tensorexpr;
+            return getTECPUParallelMinElements() = min_elements;
+          })
+      .def(
+          "_jit_get_te_auto_schedule_mode",
+          []() -> int {
+            using namespace torch::jit::tensorexpr;
+            return getTEAutoScheduleMode();
+          })
+      .def(
+          "_jit_set_te_auto_schedule_mode",
+          [](int mode) {
+            using namespace torch::jit::tensorexpr;
+            return getTEAutoScheduleMode() = mode;
+          })
       .def(
           "_jit_get_te_must_use_llvm_cpu",
           []() -> bool {
@@ -644,6 +684,24 @@ void initJITBindings(PyObject* module) {
             using namespace torch::jit::tensorexpr;
             getTEMustUseLLVMOnCPU() = use_llvm;
           })
+      .def(
+          "_jit_get_te_llvm_kernel_cache_dir",
+          []() -> std::string {
+#ifdef TORCH_ENABLE_LLVM
+            using namespace torch::jit::tensorexpr;
+            return getTELLVMKernelCacheDir();
+#else
+            return "";
+#endif
+          })
+      .def(
+          "_jit_set_te_llvm_kernel_cache_dir",
+          [](const std::string& cache_dir) {
+#ifdef TORCH_ENABLE_LLVM
+            using namespace torch::jit::tensorexpr;
+            getTELLVMKernelCacheDir() = cache_dir;
+#endif
+          })
       .def(
           "_llvm_enabled",
           []() {
@@ -75,7 +75,7 @@ bool isOpSupportedInMobile(OpCode op) {
       OP, OPN, LOAD, MOVE, STOREN, STORE, DROP, DROPR, LOADC, JF, JMP, LOOP,
       RET, GET_ATTR, SET_ATTR, LIST_CONSTRUCT, TUPLE_CONSTRUCT, WARN,
       INTERFACE_CALL, LIST_UNPACK, TUPLE_SLICE, DICT_CONSTRUCT,
-      NAMED_TUPLE_CONSTRUCT
+      NAMED_TUPLE_CONSTRUCT, OPR, REG
   };
   // clang-format on
 
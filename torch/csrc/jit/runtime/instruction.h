@@ -54,7 +54,15 @@ namespace jit {
   _(FORK, "CN") /* launch a thread to run code entry x with N inputs  */       \
   _(WARN, "I") /* emit a warning with line information */                      \
   _(ENTER, "EN") /* enter scope of a contextmanager */                         \
-  _(EXIT, "EX") /* exit the last entered contextmanager */
+  _(EXIT, "EX") /* exit the last entered contextmanager */                     \
+  _(OPR, "OI") /* invoke operator X on the N REG operands that follow */       \
+  _(REG, "RI") /* operand of OPR: register X, N is a RegOperandKind */         \
+  /* superinstructions, only used by the interpreter and never serialized */   \
+  _(LOADS_OP, "RI") /* run the N LOAD/MOVEs starting here, then the OP */      \
+  _(LOADS_OP_STORE, "RI") /* LOADS_OP, then the STORE that follows it */       \
+  _(OP_STORE, "O") /* invoke operator X, then the STORE that follows it */     \
+  _(LOAD_GET_ATTRS, "RI") /* LOAD/MOVE reg X, then the N GET_ATTRs */          \
+  _(GET_ATTRS, "SI") /* run the N GET_ATTRs starting here */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
@@ -62,6 +70,13 @@ enum OpCode : uint8_t {
 #undef DEFINE_OP
 };
 
+// The kind of a REG operand. The inputs of an OPR come before its outputs.
+enum RegOperandKind : uint16_t {
+  REG_LOAD = 0, // push a copy of the register as an input
+  REG_MOVE = 1, // move the register into an input
+  REG_STORE = 2, // pop an output into the register
+};
+
 struct Instruction {
   OpCode op;
   uint8_t unused;
@@ -22,6 +22,7 @@
 #include <torch/csrc/jit/runtime/jit_exception.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/profiling_record.h>
+#include <torch/csrc/jit/runtime/unboxed_ops.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 
 #ifdef USE_RPC
@@ -31,6 +32,7 @@ using torch::distributed::autograd::DistAutogradContainer;
 
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -450,6 +452,10 @@ struct CodeImpl {
   // instruction to be emitted?
   std::vector<Node*> instructions_source_;
 
+  // The instructions the interpreter dispatches on, see
+  // emitSuperinstructions. instructions_ is what gets serialized.
+  std::vector<Instruction> run_instructions_;
+
   std::vector<IValue> constant_table_;
   std::vector<Operation> operator_table_;
   std::vector<Function*> function_table_;
@@ -513,6 +519,7 @@ struct CodeImpl {
     // we deferred the emission of bailout blocks so they appear at the end
     // emit them now and patch up the jumps
     insertBailoutBlocks();
+    emitSuperinstructions();
   }
 
   const std::vector<c10::IValue>& constant_table() const {
@@ -528,6 +535,7 @@ struct CodeImpl {
         if (count-- == 0) {
           // patching GUARD to FAIL_GUARD
           instructions_[instr_index].op = FAIL_GUARD;
+          run_instructions_[instr_index].op = FAIL_GUARD;
           GRAPH_DEBUG(
               "Added a bailout request for ",
               index,
@@ -586,6 +594,69 @@ struct CodeImpl {
     truncateInstructions(jf_index + 1);
   }
 
+  // Copies instructions_ into run_instructions_, replacing the first
+  // instruction of common sequences with a superinstruction that runs the
+  // whole sequence:
+  //   LOAD/MOVE... OP          -> LOADS_OP (N = number of loads)
+  //   LOAD/MOVE... OP STORE    -> LOADS_OP_STORE
+  //   OP STORE                 -> OP_STORE
+  //   LOAD/MOVE GET_ATTR...    -> LOAD_GET_ATTRS (N = number of GET_ATTRs)
+  //   GET_ATTR GET_ATTR...     -> GET_ATTRS (N = number of GET_ATTRs)
+  // The rest of each sequence is left in place, so jumps into its middle
+  // still work and every pc keeps pointing at the instruction that
+  // instructions_source_ describes.
+  void emitSuperinstructions() {
+    run_instructions_ = instructions_;
+    if (!getInterpreterSuperinstructionsEnabled()) {
+      return;
+    }
+    const size_t n = instructions_.size();
+    const size_t max_run = std::numeric_limits<uint16_t>::max();
+    auto is = [&](size_t i, OpCode op) {
+      return i < n && instructions_[i].op == op;
+    };
+    auto countRun = [&](size_t i, OpCode op, OpCode op2) {
+      size_t end = i;
+      while (end - i < max_run && (is(end, op) || is(end, op2))) {
+        ++end;
+      }
+      return end - i;
+    };
+
+    size_t i = 0;
+    while (i < n) {
+      size_t loads = countRun(i, LOAD, MOVE);
+      if (loads > 0) {
+        size_t end = i + loads;
+        if (is(end, OP)) {
+          bool store = is(end + 1, STORE);
+          run_instructions_[i].op = store ? LOADS_OP_STORE : LOADS_OP;
+          run_instructions_[i].N = loads;
+          i = end + (store ? 2 : 1);
+        } else if (is(end, GET_ATTR)) {
+          size_t attrs = countRun(end, GET_ATTR, GET_ATTR);
+          run_instructions_[end - 1].op = LOAD_GET_ATTRS;
+          run_instructions_[end - 1].N = attrs;
+          i = end + attrs;
+        } else {
+          i = end;
+        }
+      } else if (is(i, OP) && is(i + 1, STORE)) {
+        run_instructions_[i].op = OP_STORE;
+        i += 2;
+      } else if (is(i, GET_ATTR)) {
+        size_t attrs = countRun(i, GET_ATTR, GET_ATTR);
+        if (attrs > 1) {
+          run_instructions_[i].op = GET_ATTRS;
+          run_instructions_[i].N = attrs;
+        }
+        i += attrs;
+      } else {
+        ++i;
+      }
+    }
+  }
+
   int allocRegs(at::ArrayRef<Value*> vs) {
     int result = register_size_ + 1;
     for (Value* v : vs) {
@@ -641,7 +712,13 @@ struct CodeImpl {
     } else {
       insertInstruction(OP, operator_table_.size());
     }
-    operator_table_.emplace_back(op.getOperation(node));
+    Operation operation = op.getOperation(node);
+    if (op.isC10Op()) {
+      if (auto unboxed = createUnboxedOperation(op.c10Handle(), operation)) {
+        operation = std::move(*unboxed);
+      }
+    }
+    operator_table_.emplace_back(std::move(operation));
   }
 
   void emitWait(Node* node) {
@@ -1035,6 +1112,29 @@ struct CodeImpl {
   }
 };
 
+// The interpreter loop dispatches instructions with a switch, or where the
+// compiler supports it, by jumping straight from the end of one instruction to
+// the label of the next through a table of label addresses. Instructions that
+// change the current frame go back to the top of the loop with `continue`.
+#if defined(__GNUC__) || defined(__clang__)
+#define JIT_USE_COMPUTED_GOTO
+#endif
+
+#ifdef JIT_USE_COMPUTED_GOTO
+#define INST(NAME) \
+  NAME:            \
+  label_##NAME
+#define INST_DISPATCH goto* dispatch_table[inst.op]
+#else
+#define INST(NAME) NAME
+#define INST_DISPATCH break
+#endif
+
+#define INST_FETCH(X) (frame.function->run_instructions_[frame.pc += (X)])
+#define INST_NEXT       \
+  inst = INST_FETCH(1); \
+  INST_DISPATCH
+
 // InterpreterState state that and used to compute a Code
 struct InterpreterStateImpl : c10::intrusive_ptr_target {
   InterpreterStateImpl(const Code& code, TaskLauncher taskLauncher)
@@ -1166,6 +1266,17 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     checkAndStartRecordFunction(frames.back(), stack);
   }
 
+  // Pushes the registers of the n LOAD and MOVE instructions at `inst`.
+  void loadRegisters(Stack& stack, const Instruction* inst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (inst[i].op == MOVE) {
+        stack.emplace_back(std::move(reg(inst[i].X)));
+      } else {
+        stack.emplace_back(reg(inst[i].X));
+      }
+    }
+  }
+
   bool runImpl(Stack& stack) {
     // if we have never run before, then we might have to return the
     // stack when we suspend, record where it starts so we return the right
@@ -1183,20 +1294,29 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     if (frames.back().pc == 0 && stack_start_ == 0) {
       checkAndStartRecordFunction(frames.back(), stack);
     }
+
+#ifdef JIT_USE_COMPUTED_GOTO
+    static void* dispatch_table[] = {
+#define DISPATCH_TABLE_ENTRY(op, _) &&label_##op,
+        FORALL_OPCODES(DISPATCH_TABLE_ENTRY)
+#undef DISPATCH_TABLE_ENTRY
+    };
+#endif
+
     try {
       while (true) {
         Frame& frame = frames.back();
         // std::cout << "RUNNING ";
         // frames.back().function->dump(std::cout, frame.pc);
-        Instruction inst = frame.function->instructions_[frame.pc];
+        Instruction inst = INST_FETCH(0);
         switch (inst.op) {
-          case ENTER: {
+          case INST(ENTER): {
             auto obj = peek(stack, 0, 1);
             TORCH_INTERNAL_ASSERT(obj.isObject());
             entered_objects.push_back(obj);
-            ++frame.pc;
-          } break;
-          case EXIT: {
+          }
+            INST_NEXT;
+          case INST(EXIT): {
             auto obj = entered_objects.back().toObject();
             auto& f = obj->type()->getMethod("__exit__");
             push(stack, obj);
@@ -1205,65 +1325,61 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             push(stack, IValue());
             push(stack, IValue());
             runGraphFunction(stack, &f);
-          } break;
-          case OP:
+          }
+            continue;
+          case INST(OP):
             frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case OPN:
+            INST_NEXT;
+          case INST(OPN):
             stack.push_back(inst.N);
             frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case LOAD:
+            INST_NEXT;
+          case INST(LOAD):
             stack.emplace_back(reg(inst.X));
-            ++frame.pc;
-            break;
-          case MOVE:
+            INST_NEXT;
+          case INST(MOVE):
             stack.emplace_back(std::move(reg(inst.X)));
-            ++frame.pc;
-            break;
-          case STORE:
+            INST_NEXT;
+          case INST(STORE):
             reg(inst.X) = pop(stack);
-            ++frame.pc;
-            break;
-          case STOREN:
+            INST_NEXT;
+          case INST(STOREN):
             for (size_t i = inst.N; i > 0; --i) {
               reg(inst.X + i - 1) = pop(stack);
             }
-            ++frame.pc;
-            break;
-          case DROP:
+            INST_NEXT;
+          case INST(DROP):
             pop(stack);
-            ++frame.pc;
-            break;
-          case DROPR:
+            INST_NEXT;
+          case INST(DROPR):
             reg(inst.X) = IValue();
-            ++frame.pc;
-            break;
-          case LOADC:
+            INST_NEXT;
+          case INST(LOADC):
             stack.emplace_back(frame.function->constant_table_[inst.X]);
-            ++frame.pc;
-            break;
-          case GET_ATTR: {
+            INST_NEXT;
+          case INST(GET_ATTR): {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
             push(stack, std::move(value));
-            ++frame.pc;
-          } break;
-          case SET_ATTR: {
+          }
+            INST_NEXT;
+          case INST(SET_ATTR): {
             auto v = pop(stack);
             auto userObj = pop(stack).toObject();
             userObj->setSlot(inst.X, std::move(v));
-            ++frame.pc;
-          } break;
-          case JF:
-            frame.pc += (pop(stack).toBool()) ? 1 : inst.X;
-            break;
-          case JMP:
-            frame.pc += inst.X;
-            break;
-          case LOOP: {
+          }
+            INST_NEXT;
+          case INST(JF):
+            if (pop(stack).toBool()) {
+              inst = INST_FETCH(1);
+            } else {
+              inst = INST_FETCH(inst.X);
+            }
+            INST_DISPATCH;
+          case INST(JMP):
+            inst = INST_FETCH(inst.X);
+            INST_DISPATCH;
+          case INST(LOOP): {
             // stack: iteration_count, max_iter, cond, loop_carried_deps...
             auto fr = stack.end() - (inst.N + 1);
             int64_t trip_count = fr[0].toInt();
@@ -1272,25 +1388,27 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (trip_count < max_trip_count && cond) {
               fr[2] = trip_count;
               fr[0] = trip_count + 1;
-              ++frame.pc;
+              inst = INST_FETCH(1);
             } else {
               size_t n_loop_carried = inst.N - 2;
               for (size_t i = 0; i < n_loop_carried; ++i) {
                 fr[i] = std::move(fr[i + 3]);
               }
               drop(stack, 3); // iteration_count, max_iter, cond
-              frame.pc += inst.X;
+              inst = INST_FETCH(inst.X);
             }
-          } break;
-          case CALL: {
+          }
+            INST_DISPATCH;
+          case INST(CALL): {
             Function* fn = frame.function->function_table_[inst.X];
             if (!fn->isGraphFunction()) {
               runBuiltinFunction(stack, fn);
             } else {
               runGraphFunction(stack, fn);
             }
-          } break;
-          case INTERFACE_CALL: {
+          }
+            continue;
+          case INST(INTERFACE_CALL): {
             // note the hash table lookup to find the function
             // this can be more optimized if necessary, caching parts
             // of the hashing computation or storing the offset when
@@ -1314,11 +1432,12 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             } else {
               runGraphFunction(stack, &function);
             }
-          } break;
-          case RET:
+          }
+            continue;
+          case INST(RET):
             if (frames.size() > 1) {
               leaveFrame();
-              break;
+              continue;
             }
             if (future_) {
               auto num_outputs = frames.back().function->n_outputs;
@@ -1332,7 +1451,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             // destroy the last frame and call RecordFunction's end callbacks
             leaveFrame();
             return false;
-          case WAIT: {
+          case INST(WAIT): {
             auto future = stack.back().toFuture();
             if (!future->completed()) {
               getOrCreateFuture();
@@ -1387,9 +1506,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             }
             stack.pop_back();
             stack.emplace_back(future->value());
-            ++frame.pc;
-          } break;
-          case PROFILE_OP: {
+          }
+            INST_NEXT;
+          case INST(PROFILE_OP): {
             auto& frame_id_ref = frame.id;
             if (!frame_id_ref.has_value()) {
               frame_id_ref = Frame::num_frames++;
@@ -1397,19 +1516,18 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             auto callback = frame.function->profile_function_table_[inst.X];
             push(stack, c10::IValue{static_cast<int64_t>(*frame_id_ref)});
             callback(stack);
-            ++frame.pc;
-            break;
           }
-          case FAIL_GUARD: {
+            INST_NEXT;
+          case INST(FAIL_GUARD): {
             // patch FAIL_GUARD back to GUARD
             GRAPH_DEBUG(
                 "Bailout ", inst.X, " triggered via bailout_requests_!");
             frame.function->instructions_[frame.pc].op = GUARD;
+            frame.function->run_instructions_[frame.pc].op = GUARD;
             push(stack, false);
-            ++frame.pc;
-            break;
           }
-          case TYPECHECK: {
+            INST_NEXT;
+          case INST(TYPECHECK): {
             int num_inputs = inst.N, i = 0;
             TORCH_INTERNAL_ASSERT(stack.size() >= num_inputs && num_inputs > 0);
             // Check every input's shape against profiled (expected) shape.
@@ -1426,10 +1544,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (i == num_inputs) {
               push(stack, true);
             }
-            ++frame.pc;
-            break;
           }
-          case GUARD: {
+            INST_NEXT;
+          case INST(GUARD): {
             if (!stack.back().isTensor()) {
               // stack.back() is an Uninitialized IValue and this is a guard
               // on a block output. Uninitialized IValues are never used
@@ -1447,9 +1564,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 push(stack, expected_type->matchTensor(t));
               }
             }
-            ++frame.pc;
-          } break;
-          case TAIL_CALL: {
+          }
+            INST_NEXT;
+          case INST(TAIL_CALL): {
             GRAPH_DEBUG("running TAIL_CALL for ", inst.X);
             frame.function->function_table_[inst.X]->ensure_defined();
             size_t remaining_bailout_depth =
@@ -1472,50 +1589,51 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             leaveFrame();
             enterFrame(code, base_pointer);
             checkAndStartRecordFunction(frames.back(), stack);
-          } break;
-          case LIST_UNPACK: {
+          }
+            continue;
+          case INST(LIST_UNPACK): {
             listUnpack(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(TUPLE_CONSTRUCT): {
             tupleConstruct(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_SLICE: {
+          }
+            INST_NEXT;
+          case INST(TUPLE_SLICE): {
             tupleSlice(stack, inst.X, inst.X + inst.N);
-            ++frame.pc;
-          } break;
-          case NAMED_TUPLE_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(NAMED_TUPLE_CONSTRUCT): {
             auto type =
                 frame.function->type_table_[inst.X]->expect<TupleType>();
             namedTupleConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case LIST_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(LIST_CONSTRUCT): {
             const auto& type =
                 frame.function->type_table_[inst.X]->expectRef<ListType>();
             listConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case DICT_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(DICT_CONSTRUCT): {
             auto type = frame.function->type_table_[inst.X]->expect<DictType>();
             dictConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case CREATE_OBJECT: {
+          }
+            INST_NEXT;
+          case INST(CREATE_OBJECT): {
             auto type =
                 frame.function->type_table_[inst.X]->expect<ClassType>();
             createObject(stack, type);
-            ++frame.pc;
-          } break;
-          case ISINSTANCE: {
+          }
+            INST_NEXT;
+          case INST(ISINSTANCE): {
             at::ArrayRef<TypePtr> types(
                 &(frame.function->type_table_[inst.X]),
                 &(frame.function->type_table_[inst.X + inst.N]));
             isinstance(stack, types);
-            ++frame.pc;
-          } break;
-          case FORK: {
+          }
+            INST_NEXT;
+          case INST(FORK): {
             // Move inputs to a separate stack
             Function* forked_fn = frame.function->function_table_[inst.X];
             InterpreterState forked_interpreter(
@@ -1530,9 +1648,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             drop(stack, inst.N);
             push(stack, forked_interpreter.getFuture());
             taskLauncher_(std::move(continuation));
-            ++frame.pc;
-          } break;
-          case WARN: {
+          }
+            INST_NEXT;
+          case INST(WARN): {
             // Keeps track of which WARN instruction has been executed before,
             // we only want to execute each WARN once to match default Python
             // warning behavior.
@@ -1563,8 +1681,58 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 TORCH_WARN(msg);
               }
             }
+          }
+            INST_NEXT;
+          case INST(OPR):
+          case INST(REG):
+            // register operands only exist in the lite interpreter's bytecode
+            TORCH_INTERNAL_ASSERT(false, inst, " is not supported");
+          // Superinstructions run the sequence of instructions they head,
+          // reading its operands from instructions_, and leave the pc at its
+          // last instruction so errors are reported for the right node.
+          case INST(LOADS_OP): {
+            const Instruction* seq = &frame.function->instructions_[frame.pc];
+            loadRegisters(stack, seq, inst.N);
+            frame.pc += inst.N;
+            frame.function->operator_table_[seq[inst.N].X](&stack);
+          }
+            INST_NEXT;
+          case INST(LOADS_OP_STORE): {
+            const Instruction* seq = &frame.function->instructions_[frame.pc];
+            loadRegisters(stack, seq, inst.N);
+            frame.pc += inst.N;
+            frame.function->operator_table_[seq[inst.N].X](&stack);
+            ++frame.pc;
+            reg(seq[inst.N + 1].X) = pop(stack);
+          }
+            INST_NEXT;
+          case INST(OP_STORE): {
+            frame.function->operator_table_[inst.X](&stack);
             ++frame.pc;
-          } break;
+            reg(frame.function->instructions_[frame.pc].X) = pop(stack);
+          }
+            INST_NEXT;
+          case INST(LOAD_GET_ATTRS): {
+            const Instruction* seq = &frame.function->instructions_[frame.pc];
+            IValue value = seq[0].op == MOVE ? std::move(reg(inst.X))
+                                             : reg(inst.X);
+            for (size_t i = 1; i <= inst.N; ++i) {
+              ++frame.pc;
+              value = value.toObject()->getSlot(seq[i].X);
+            }
+            push(stack, std::move(value));
+          }
+            INST_NEXT;
+          case INST(GET_ATTRS): {
+            const Instruction* seq = &frame.function->instructions_[frame.pc];
+            IValue value = pop(stack).toObject()->getSlot(inst.X);
+            for (size_t i = 1; i < inst.N; ++i) {
+              ++frame.pc;
+              value = value.toObject()->getSlot(seq[i].X);
+            }
+            push(stack, std::move(value));
+          }
+            INST_NEXT;
         }
       }
     } catch (std::exception& e) {
@@ -1696,6 +1864,11 @@ std::vector<StackEntry> currentCallstack() {
 
 std::atomic<size_t> InterpreterStateImpl::Frame::num_frames;
 
+std::atomic<bool>& getInterpreterSuperinstructionsEnabled() {
+  static std::atomic<bool> enabled{true};
+  return enabled;
+}
+
 std::ostream& operator<<(std::ostream& out, const Code& code) {
   out << *code.pImpl->graph_ << "\n";
   code.pImpl->dump(out);
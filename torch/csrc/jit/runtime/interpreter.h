@@ -1,5 +1,6 @@
 #pragma once
 #include <c10/util/Optional.h>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -137,5 +138,9 @@ TORCH_API at::TensorTypePtr tensorTypeInCurrentExecutionContext(
 // current (TLS) TorchScript interpreter callstack
 TORCH_API std::vector<StackEntry> currentCallstack();
 
+// Whether Code created from now on runs common instruction sequences as
+// superinstructions. Enabled by default.
+TORCH_API std::atomic<bool>& getInterpreterSuperinstructionsEnabled();
+
 } // namespace jit
 } // namespace torch
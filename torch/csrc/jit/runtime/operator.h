@@ -156,6 +156,11 @@ struct TORCH_API Operator {
     return op_.is_left();
   }
 
+  const c10::OperatorHandle& c10Handle() const {
+    TORCH_INTERNAL_ASSERT(isC10Op());
+    return op_.left().handle_;
+  }
+
   c10::AliasAnalysisKind aliasAnalysisKind() const {
     const FunctionSchema& schemaRef = schema();
     c10::AliasAnalysisKind alias_analysis = schemaRef.aliasAnalysis();
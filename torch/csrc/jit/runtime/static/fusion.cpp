@@ -53,7 +53,30 @@ RegisterOperators StaticSubgraphOps({torch::jit::Operator(
     return false;                           \
   }
 
+// The blocks of prim::If and prim::Loop run with nested Static Runtimes, so
+// control flow can be handled if every node inside it can.
+bool canHandleBlocks(Node* node) {
+  for (Block* block : node->blocks()) {
+    for (Node* n : block->nodes()) {
+      auto kind = n->kind();
+      if (kind == prim::Constant) {
+        continue;
+      }
+      if (kind == prim::If || kind == prim::Loop) {
+        REQ(canHandleBlocks(n));
+        continue;
+      }
+      REQ(kind == prim::TupleConstruct || kind == prim::ListConstruct ||
+          canRunOutOfPlace(n));
+    }
+  }
+  return true;
+}
+
 bool canHandle(Node* node) {
+  if (node->kind() == prim::If || node->kind() == prim::Loop) {
+    return canHandleBlocks(node);
+  }
   for (Value* input : node->inputs()) {
     bool is_tensor = !!input->type()->cast<TensorType>();
     auto list_type = input->type()->cast<ListType>();
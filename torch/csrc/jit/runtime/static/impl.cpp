@@ -1,19 +1,28 @@
 #include <torch/csrc/jit/runtime/static/impl.h>
 
+#include <ATen/Parallel.h>
 #include <ATen/core/LegacyTypeDispatch.h>
 #include <ATen/core/interned_strings.h>
 #include <c10/core/CPUAllocator.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
+#include <c10/util/accumulate.h>
 #include <caffe2/core/scope_guard.h>
 #include <caffe2/core/timer.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/liveness.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
+#include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
 #include <torch/csrc/jit/runtime/static/ops.h>
 #include <torch/csrc/jit/runtime/static/passes.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 
+#include <chrono>
+#include <numeric>
+
 namespace torch {
 namespace jit {
 
@@ -41,8 +50,9 @@ void CheckGraphEligibility(const std::shared_ptr<torch::jit::Graph>& graph) {
     }
   }
   // check output types
-  // Static Runtime supports output types include None, Tensor and List/Tuple
-  // of Tensor
+  // Static Runtime supports output types include None, Tensor, List/Tuple
+  // of Tensor and scalars (e.g. the condition and loop-carried counters
+  // returned by the blocks of prim::If and prim::Loop)
   for (Value* output : graph->outputs()) {
     VLOG(1) << "output: %" << output->debugName()
             << " has type: " << output->type()->repr_str();
@@ -59,8 +69,11 @@ void CheckGraphEligibility(const std::shared_ptr<torch::jit::Graph>& graph) {
       const auto& type = output->type();
       TORCH_CHECK(
           type->cast<TensorType>() != nullptr ||
-              type->cast<NoneType>() != nullptr,
-          "Static Runtime expects output type as None or Tensor, but got ",
+              type->cast<NoneType>() != nullptr ||
+              type->cast<BoolType>() != nullptr ||
+              type->cast<IntType>() != nullptr ||
+              type->cast<FloatType>() != nullptr,
+          "Static Runtime expects output type as None, Tensor or scalar, but got ",
           type->repr_str());
     }
   }
@@ -68,7 +81,8 @@ void CheckGraphEligibility(const std::shared_ptr<torch::jit::Graph>& graph) {
 
 // remove unused input 0 from graph
 void RemoveSelfFromGraphInput(std::shared_ptr<torch::jit::Graph>& graph) {
-  if (graph->inputs().at(0)->type()->is_module()) {
+  if (graph->inputs().size() > 0 &&
+      graph->inputs().at(0)->type()->is_module()) {
     TORCH_CHECK(!graph->inputs().at(0)->hasUses());
     graph->eraseInput(0);
   }
@@ -82,6 +96,57 @@ std::unique_ptr<c10::FunctionSchema> RemoveSelfFromSchema(
   return std::make_unique<c10::FunctionSchema>(s.cloneWithArguments(args));
 }
 
+bool IsDefinedIn(Value* v, Block* block) {
+  for (Block* b = v->node()->owningBlock(); b != nullptr;
+       b = b->owningNode() ? b->owningNode()->owningBlock() : nullptr) {
+    if (b == block) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CollectCapturedValues(
+    Node* node,
+    Block* block,
+    std::vector<Value*>& captured,
+    std::unordered_set<Value*>& seen) {
+  auto capture = [&](Value* v) {
+    if (!IsDefinedIn(v, block) && seen.insert(v).second) {
+      captured.push_back(v);
+    }
+  };
+  for (Value* input : node->inputs()) {
+    capture(input);
+  }
+  for (Block* b : node->blocks()) {
+    for (Node* n : b->nodes()) {
+      CollectCapturedValues(n, block, captured, seen);
+    }
+    for (Value* output : b->outputs()) {
+      capture(output);
+    }
+  }
+}
+
+// Values used inside the blocks of node but defined outside of node, in the
+// order of their first use.
+std::vector<Value*> CapturedValues(Node* node) {
+  std::vector<Value*> captured;
+  std::unordered_set<Value*> seen{node->inputs().begin(), node->inputs().end()};
+  for (Block* block : node->blocks()) {
+    for (Node* n : block->nodes()) {
+      CollectCapturedValues(n, block, captured, seen);
+    }
+    for (Value* output : block->outputs()) {
+      if (!IsDefinedIn(output, block) && seen.insert(output).second) {
+        captured.push_back(output);
+      }
+    }
+  }
+  return captured;
+}
+
 // Returns two useful constructs:
 //  first: map each value to all values that are alive
 //    at the same time.
@@ -117,14 +182,24 @@ LivenessMap(const std::shared_ptr<torch::jit::Graph>& graph) {
     }
 
     for (const auto& u : v->uses()) {
-      const auto& node = u.user;
+      // a use inside a block is attributed to the prim::If or prim::Loop
+      // node owning the block
+      Node* node = u.user;
+      while (node->owningBlock() != graph->block()) {
+        node = node->owningBlock()->owningNode();
+      }
       // track deps of this value
       live_values.at(v).insert(node);
     }
   };
 
   auto traverse_node = [&](Node* node, std::vector<Value*>& dead) {
-    for (const auto& input : node->inputs()) {
+    std::vector<Value*> used{node->inputs().begin(), node->inputs().end()};
+    if (!node->blocks().empty()) {
+      auto captured = CapturedValues(node);
+      used.insert(used.end(), captured.begin(), captured.end());
+    }
+    for (const auto& input : used) {
       // ignore constant values
       if (input->node()->kind() == prim::Constant) {
         always_alive.insert(input);
@@ -176,6 +251,9 @@ std::unordered_set<Value*> GetOptimizableValues(
   // these need to be removed from "can_reuse" after analyzing all nodes
   std::unordered_set<Value*> cannot_reuse;
   for (const auto& n : graph->nodes()) {
+    for (Value* v : CapturedValues(n)) {
+      cannot_reuse.insert(v);
+    }
     for (const auto& v : n->inputs()) {
       if (canRunOutOfPlace(n) && canReuseInputs(n)) {
         can_reuse.insert(v);
@@ -288,7 +366,6 @@ size_t AssignRegisters(
       reg_to_val[reg].insert(output);
     }
   }
-  TORCH_CHECK(graph->outputs().size() > 0);
   for (Value* output : graph->outputs()) {
     TORCH_CHECK(value_to_reg.count(output) > 0);
     output_regs.push_back(value_to_reg[output]);
@@ -319,12 +396,55 @@ void DeduceInternalValues(
     }
   }
 }
+
+// Copies block into a graph whose inputs are the captured values followed
+// by the inputs of the block. Captured constants are cloned into the graph.
+std::shared_ptr<torch::jit::Graph> BlockToGraph(
+    Block* block,
+    const std::vector<Value*>& captured_values) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> value_map;
+  for (Value* v : captured_values) {
+    value_map[v] = graph->addInput()->copyMetadata(v);
+  }
+  graph->block()->cloneFrom(block, [&](Value* v) -> Value* {
+    auto it = value_map.find(v);
+    if (it != value_map.end()) {
+      return it->second;
+    }
+    TORCH_INTERNAL_ASSERT(v->node()->kind() == prim::Constant);
+    Value* c = graph->insertConstant(toIValue(v).value());
+    c->setType(v->type());
+    value_map[v] = c;
+    return c;
+  });
+  return graph;
+}
 } // namespace
 
 void InferenceModule::init() {
   OptimizeGraph(graph);
   CheckGraphEligibility(graph);
   RemoveSelfFromGraphInput(graph);
+  for (Node* node : graph->nodes()) {
+    if (node->blocks().empty()) {
+      continue;
+    }
+    TORCH_CHECK(
+        node->kind() == prim::If || node->kind() == prim::Loop,
+        "Static Runtime does not support blocks of ",
+        node->kind().toQualString());
+    Blocks& b = blocks[node];
+    for (Value* v : CapturedValues(node)) {
+      if (v->node()->kind() != prim::Constant) {
+        b.captured_values.push_back(v);
+      }
+    }
+    for (Block* block : node->blocks()) {
+      b.modules.emplace_back(std::make_shared<InferenceModule>(
+          BlockToGraph(block, b.captured_values), opts));
+    }
+  }
   reused_regs = AssignRegisters(
       graph,
       value_to_reg,
@@ -416,15 +536,119 @@ StaticRuntime::StaticRuntime(
     for (Value* input : node->inputs()) {
       inputs.emplace_back(val_to_ival.at(input));
     }
-    nodes_.emplace_back(
-        ProcessedNode(node, std::move(inputs), opts.enable_out_variant));
+    std::vector<std::unique_ptr<StaticRuntime>> block_runtimes;
+    auto blocks = module_->blocks.find(node);
+    if (blocks != module_->blocks.end()) {
+      for (Value* v : blocks->second.captured_values) {
+        inputs.emplace_back(val_to_ival.at(v));
+      }
+      // blocks run within a node of this runtime, which already runs its
+      // independent nodes concurrently, so blocks run their nodes sequentially
+      StaticRuntimeOptions block_opts = opts_;
+      block_opts.enable_inter_op_parallelism = false;
+      // the time and allocations of a block are accounted to its node
+      block_opts.metrics_sampling_period = 0;
+      for (const auto& m : blocks->second.modules) {
+        block_runtimes.emplace_back(
+            std::make_unique<StaticRuntime>(m, block_opts));
+      }
+    }
+    nodes_.emplace_back(ProcessedNode(
+        node,
+        std::move(inputs),
+        opts.enable_out_variant,
+        std::move(block_runtimes)));
     for (auto i = 0; i < node->outputs().size(); ++i) {
       val_to_ival[node->outputs()[i]] = &nodes_.back().Output(i);
     }
   }
+  std::unordered_set<const IValue*> node_outputs;
+  for (ProcessedNode& pnode : nodes_) {
+    for (const IValue& output : pnode.outputs()) {
+      node_outputs.insert(&output);
+    }
+  }
   for (auto output : graph->outputs()) {
     outputs_.emplace_back(val_to_ival.at(output));
+    if (node_outputs.count(outputs_.back())) {
+      node_outputs_.emplace_back(outputs_.back());
+    }
+  }
+
+  if (opts_.enable_inter_op_parallelism) {
+    build_dependency_graph();
+  }
+  if (opts_.metrics_sampling_period > 0) {
+    counters_ = std::make_unique<StaticRuntimeCounters>(nodes_.size());
+  }
+}
+
+namespace {
+bool HasSideEffectsOrWriters(Node* node, const AliasDb& alias_db) {
+  if (node->hasSideEffects() || alias_db.hasWriters(node)) {
+    return true;
+  }
+  for (Block* block : node->blocks()) {
+    for (Node* n : block->nodes()) {
+      if (HasSideEffectsOrWriters(n, alias_db)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+} // namespace
+
+void StaticRuntime::build_dependency_graph() {
+  const std::shared_ptr<Graph>& graph = module_->graph;
+  AliasDb alias_db(graph);
+
+  std::unordered_map<Value*, size_t> producer;
+  std::vector<std::unordered_set<size_t>> deps(nodes_.size());
+  // Nodes that mutate their inputs or have side effects are not reordered
+  // with respect to any other node.
+  c10::optional<size_t> last_barrier;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    Node* node = nodes_[i].get_node();
+    std::vector<Value*> used{node->inputs().begin(), node->inputs().end()};
+    auto blocks = module_->blocks.find(node);
+    if (blocks != module_->blocks.end()) {
+      const auto& captured = blocks->second.captured_values;
+      used.insert(used.end(), captured.begin(), captured.end());
+    }
+    for (Value* input : used) {
+      auto it = producer.find(input);
+      if (it != producer.end()) {
+        deps[i].insert(it->second);
+      }
+    }
+    if (HasSideEffectsOrWriters(node, alias_db)) {
+      for (size_t j = last_barrier ? *last_barrier : 0; j < i; ++j) {
+        deps[i].insert(j);
+      }
+      last_barrier = i;
+    } else if (last_barrier) {
+      deps[i].insert(*last_barrier);
+    }
+    for (Value* output : node->outputs()) {
+      producer[output] = i;
+    }
+  }
+
+  node_dependents_.assign(nodes_.size(), {});
+  node_num_deps_.assign(nodes_.size(), 0);
+  root_nodes_.clear();
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    node_num_deps_[i] = deps[i].size();
+    if (deps[i].empty()) {
+      root_nodes_.push_back(i);
+    }
+    for (size_t dep : deps[i]) {
+      node_dependents_[dep].push_back(i);
+    }
   }
+  parallel_state_ = std::make_shared<ParallelRunState>();
+  parallel_state_->pending_deps.reset(new std::atomic<size_t>[nodes_.size()]);
 }
 
 size_t StaticRuntime::num_outputs() const {
@@ -463,10 +687,6 @@ c10::IValue StaticRuntime::run(
   // functions, such as resize_ and resize_as_.
   at::AutoNonVariableTypeMode non_var_type_mode(true);
 
-  if (planner_) {
-    planner_->allocate();
-  }
-
   if (!kwargs.empty()) {
     // This is not ideal
     TORCH_CHECK(
@@ -484,11 +704,78 @@ c10::IValue StaticRuntime::run(
     }
   }
 
-  // NB: before optimizing the order of execution, ensure that the
-  // memory optimization pass (LivenessMap + AssignRegisters) is
-  // aware of the new order!
-  for (auto& n : nodes_) {
-    n.run();
+  run_nodes();
+
+  // no need to keep references of outputs in static runtime anymore
+  c10::IValue result;
+  if (num_outputs() > 1) {
+    std::vector<c10::IValue> outputs;
+    outputs.reserve(num_outputs());
+    for (auto i = 0; i < num_outputs(); ++i) {
+      outputs.emplace_back(Output(i));
+    }
+    result = c10::ivalue::Tuple::create(outputs);
+  } else if (num_outputs() == 1) {
+    result = Output(0);
+  }
+  release_outputs();
+  return result;
+}
+
+void StaticRuntime::run_block(
+    std::vector<c10::IValue>& args,
+    std::vector<c10::IValue>& outputs) {
+  DCHECK_EQ(args.size(), inputs_.size());
+  DCHECK_EQ(outputs.size(), num_outputs());
+  for (size_t i = 0; i < args.size(); i++) {
+    Input(i) = std::move(args[i]);
+  }
+
+  run_nodes();
+
+  for (size_t i = 0; i < outputs.size(); i++) {
+    outputs[i] = Output(i);
+  }
+  release_outputs();
+}
+
+void StaticRuntime::run_nodes() {
+  sampling_ = false;
+  std::chrono::steady_clock::time_point start;
+  if (counters_) {
+    const uint64_t num_runs =
+        counters_->num_runs.fetch_add(1, std::memory_order_relaxed) + 1;
+    sampling_ = num_runs % opts_.metrics_sampling_period == 0;
+    if (sampling_) {
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  if (planner_) {
+    planner_->allocate();
+  }
+
+  {
+    // Count allocations through the memory reporting hook of the allocators,
+    // which reports to the profiler as well.
+    c10::optional<c10::DebugInfoGuard> allocation_guard;
+    if (sampling_) {
+      static const auto allocation_counter =
+          std::make_shared<AllocationCounter>();
+      allocation_guard.emplace(
+          c10::DebugInfoKind::MEMORY_REPORTER, allocation_counter);
+    }
+
+    // NB: before optimizing the order of execution, ensure that the
+    // memory optimization pass (LivenessMap + AssignRegisters) is
+    // aware of the new order!
+    if (opts_.enable_inter_op_parallelism) {
+      run_nodes_in_parallel();
+    } else {
+      for (size_t i = 0; i < nodes_.size(); ++i) {
+        run_node(i);
+      }
+    }
   }
 
   if (opts_.cleanup_activations) {
@@ -496,19 +783,206 @@ c10::IValue StaticRuntime::run(
       std::unordered_map<Value*, std::vector<Value*>> shared;
       planner_ = std::make_unique<MemoryPlanner>(this, shared);
     }
+    if (sampling_) {
+      counters_->unmanaged_bytes.store(
+          planner_->total_unmanaged(), std::memory_order_relaxed);
+    }
     planner_->deallocate();
+    if (sampling_) {
+      counters_->managed_bytes.store(
+          planner_->total_managed(), std::memory_order_relaxed);
+    }
   }
 
-  // no need to keep references of outputs in static runtime anymore
-  if (num_outputs() > 1) {
-    std::vector<c10::IValue> outputs;
-    outputs.reserve(num_outputs());
-    for (auto i = 0; i < num_outputs(); ++i) {
-      outputs.emplace_back(Output(i));
+  if (sampling_) {
+    auto end = std::chrono::steady_clock::now();
+    counters_->run_latency.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+    counters_->num_sampled_runs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void StaticRuntime::run_node(size_t idx) {
+  if (!sampling_) {
+    nodes_[idx].run();
+    return;
+  }
+  const uint64_t bytes = AllocationCounter::thread_bytes();
+  const uint64_t allocations = AllocationCounter::thread_allocations();
+  auto start = std::chrono::steady_clock::now();
+  nodes_[idx].run();
+  auto end = std::chrono::steady_clock::now();
+
+  auto& counters = counters_->nodes[idx];
+  counters.latency.record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
+  counters.bytes_allocated.fetch_add(
+      AllocationCounter::thread_bytes() - bytes, std::memory_order_relaxed);
+  counters.num_allocations.fetch_add(
+      AllocationCounter::thread_allocations() - allocations,
+      std::memory_order_relaxed);
+}
+
+StaticRuntime::LiveMetrics StaticRuntime::get_metrics() const {
+  TORCH_CHECK(
+      counters_ != nullptr,
+      "Metrics are disabled, set StaticRuntimeOptions::metrics_sampling_period "
+      "to enable them");
+  constexpr double kNanosPerMilli = 1e6;
+  LiveMetrics metrics;
+  metrics.num_runs = counters_->num_runs.load(std::memory_order_relaxed);
+  metrics.num_sampled_runs =
+      counters_->num_sampled_runs.load(std::memory_order_relaxed);
+  metrics.p50_ms = counters_->run_latency.percentile(50) / kNanosPerMilli;
+  metrics.p99_ms = counters_->run_latency.percentile(99) / kNanosPerMilli;
+  metrics.managed_bytes =
+      counters_->managed_bytes.load(std::memory_order_relaxed);
+  metrics.unmanaged_bytes =
+      counters_->unmanaged_bytes.load(std::memory_order_relaxed);
+  metrics.num_fallback_nodes = 0;
+  metrics.nodes.reserve(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const auto& counters = counters_->nodes[i];
+    NodeMetrics node_metrics;
+    node_metrics.kind = nodes_[i].get_node()->kind().toQualString();
+    node_metrics.is_fallback = nodes_[i].is_fallback();
+    node_metrics.num_samples = counters.latency.count();
+    node_metrics.mean_ms = node_metrics.num_samples == 0
+        ? 0
+        : counters.latency.total_nanos() /
+            static_cast<double>(node_metrics.num_samples) / kNanosPerMilli;
+    node_metrics.p50_ms = counters.latency.percentile(50) / kNanosPerMilli;
+    node_metrics.p99_ms = counters.latency.percentile(99) / kNanosPerMilli;
+    node_metrics.bytes_allocated =
+        counters.bytes_allocated.load(std::memory_order_relaxed);
+    node_metrics.num_allocations =
+        counters.num_allocations.load(std::memory_order_relaxed);
+    metrics.num_fallback_nodes += node_metrics.is_fallback;
+    metrics.nodes.emplace_back(std::move(node_metrics));
+  }
+  return metrics;
+}
+
+void StaticRuntime::reset_metrics() {
+  TORCH_CHECK(
+      counters_ != nullptr,
+      "Metrics are disabled, set StaticRuntimeOptions::metrics_sampling_period "
+      "to enable them");
+  counters_->reset();
+}
+
+void StaticRuntime::release_outputs() {
+  for (IValue* output : node_outputs_) {
+    *output = IValue();
+  }
+}
+
+void StaticRuntime::run_nodes_in_parallel() {
+  if (nodes_.empty()) {
+    return;
+  }
+  auto& state = *parallel_state_;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    state.pending_deps[i].store(node_num_deps_[i], std::memory_order_relaxed);
+  }
+  state.remaining.store(nodes_.size(), std::memory_order_relaxed);
+  state.failed.store(false, std::memory_order_relaxed);
+  state.error = nullptr;
+  state.finished = false;
+
+  // the calling thread runs the first root itself
+  for (size_t i = 1; i < root_nodes_.size(); ++i) {
+    launch_ready_node(root_nodes_[i]);
+  }
+  run_node_and_dependents(root_nodes_[0]);
+
+  // Instead of only waiting for the inter-op pool, run the ready nodes that
+  // no task has taken yet. The pool may be busy, e.g. with this very run()
+  // when it is called from an inter-op task.
+  std::unique_lock<std::mutex> lock(state.mutex);
+  while (true) {
+    state.cv.wait(
+        lock, [&state] { return state.finished || !state.ready.empty(); });
+    if (state.finished) {
+      break;
+    }
+    size_t idx = state.ready.front();
+    state.ready.pop_front();
+    lock.unlock();
+    run_node_and_dependents(idx);
+    lock.lock();
+  }
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+}
+
+// Queues a ready node and launches a task on the inter-op pool to run it,
+// unless the calling thread of run_nodes_in_parallel() gets to it first.
+void StaticRuntime::launch_ready_node(size_t idx) {
+  {
+    std::lock_guard<std::mutex> lock(parallel_state_->mutex);
+    parallel_state_->ready.push_back(idx);
+  }
+  parallel_state_->cv.notify_one();
+  at::launch([this, state = parallel_state_]() {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    // The run, and this runtime, may be over by now if the node was taken
+    // by another thread. A node taken here keeps the run from finishing.
+    if (state->ready.empty()) {
+      return;
+    }
+    size_t idx = state->ready.front();
+    state->ready.pop_front();
+    lock.unlock();
+    run_node_and_dependents(idx);
+  });
+}
+
+// Runs the node at idx, then keeps running on this thread the first of its
+// dependents that becomes ready and queues the other ready ones. Once a node has failed, the remaining nodes are only
+// retired so that run_nodes_in_parallel() can return and rethrow.
+void StaticRuntime::run_node_and_dependents(size_t idx) {
+  auto& state = *parallel_state_;
+  while (true) {
+    if (!state.failed.load(std::memory_order_relaxed)) {
+      try {
+        run_node(idx);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.error) {
+          state.error = std::current_exception();
+        }
+        state.failed.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    c10::optional<size_t> next;
+    for (size_t dependent : node_dependents_[idx]) {
+      if (state.pending_deps[dependent].fetch_sub(
+              1, std::memory_order_acq_rel) == 1) {
+        if (!next) {
+          next = dependent;
+        } else {
+          launch_ready_node(dependent);
+        }
+      }
     }
-    return c10::ivalue::Tuple::create(outputs);
+
+    if (state.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // notify under the lock: the runtime may be destroyed as soon as
+      // the waiting thread wakes up
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.finished = true;
+      state.cv.notify_all();
+    }
+    if (!next) {
+      return;
+    }
+    idx = *next;
   }
-  return Output(0);
 }
 
 void StaticRuntime::benchmark(
@@ -650,6 +1124,77 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
   return results;
 }
 
+void StaticRuntime::plan_memory(
+    const std::vector<std::vector<c10::IValue>>& input_buckets) {
+  TORCH_CHECK(
+      opts_.cleanup_activations && opts_.enable_out_variant,
+      "Ahead-of-time memory planning requires cleanup_activations and "
+      "enable_out_variant");
+  TORCH_CHECK(!input_buckets.empty(), "Expected at least one input bucket");
+
+  // infer the size of every tensor for each bucket and keep the max
+  const std::shared_ptr<Graph>& graph = module_->graph;
+  std::unordered_map<Value*, size_t> value_sizes;
+  std::unordered_map<Value*, at::ScalarType> value_dtypes;
+  for (const auto& inputs : input_buckets) {
+    TORCH_CHECK(
+        inputs.size() == graph->inputs().size(),
+        "Expected ",
+        graph->inputs().size(),
+        " inputs per bucket, but got ",
+        inputs.size());
+    std::shared_ptr<Graph> copy = graph->copy();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (inputs[i].isTensor()) {
+        copy->inputs()[i]->setType(TensorType::create(inputs[i].toTensor()));
+      }
+    }
+    PropagateInputShapes(copy);
+
+    // graph->copy() preserves the order of nodes and outputs
+    auto copy_it = copy->nodes().begin();
+    for (Node* node : graph->nodes()) {
+      Node* copy_node = *copy_it++;
+      for (size_t i = 0; i < node->outputs().size(); ++i) {
+        auto type = copy_node->outputs()[i]->type()->cast<TensorType>();
+        if (!type) {
+          continue;
+        }
+        auto sizes = type->sizes().concrete_sizes();
+        auto dtype = type->scalarType();
+        if (!sizes || !dtype) {
+          continue;
+        }
+        size_t nbytes =
+            c10::elementSize(*dtype) * c10::multiply_integers(*sizes);
+        size_t& max_nbytes = value_sizes[node->outputs()[i]];
+        max_nbytes = std::max(max_nbytes, nbytes);
+        value_dtypes[node->outputs()[i]] = *dtype;
+      }
+    }
+  }
+
+  // Create the outputs of ops with out variants up front, so that the
+  // planner can take ownership of their StorageImpls before the first run.
+  // Outputs whose dtype cannot be inferred are left to the out variants.
+  for (ProcessedNode& pnode : nodes_) {
+    if (!pnode.has_out_variant()) {
+      continue;
+    }
+    for (size_t i = 0; i < pnode.outputs().size(); ++i) {
+      Value* out = pnode.get_node()->outputs()[i];
+      auto it = value_dtypes.find(out);
+      if (it != value_dtypes.end() && pnode.Output(i).isNone()) {
+        pnode.Output(i) = at::empty({0}, at::TensorOptions().dtype(it->second));
+      }
+    }
+  }
+
+  std::unordered_map<Value*, std::vector<Value*>> shared;
+  planner_ = std::make_unique<MemoryPlanner>(this, shared);
+  planner_->plan_ahead_of_time(this, value_sizes);
+}
+
 MemoryPlanner::MemoryPlanner(
     StaticRuntime* runtime,
     std::unordered_map<Value*, std::vector<Value*>> should_share) {
@@ -700,19 +1245,27 @@ MemoryPlanner::MemoryPlanner(
   std::unordered_map<Value*, size_t> shared;
 
   // Snapshot of the current memory state
-  for (const auto& pnode : runtime->get_nodes()) {
+  for (auto& pnode : runtime->get_nodes()) {
     for (auto i = 0; i < pnode.outputs().size(); ++i) {
       const auto& ival = pnode.outputs()[i];
       const auto& val = pnode.get_node()->outputs()[i];
       if (managed_values.count(val)) {
+        if (ival.isNone()) {
+          // not created yet when planning ahead of time without a known
+          // dtype; leave it to the default allocator
+          unmanaged_values_.emplace_back(&pnode.Output(i));
+          continue;
+        }
         TORCH_CHECK(ival.isTensor());
         auto* impl = ival.toTensor().storage().unsafeGetStorageImpl();
         if (shared.count(val)) {
           managed_storage_[shared.at(val)].second.emplace_back(impl);
+          managed_storage_values_[shared.at(val)].emplace_back(val);
         } else {
           auto p =
               std::make_pair<size_t, std::vector<c10::StorageImpl*>>(0, {impl});
           managed_storage_.emplace_back(std::move(p));
+          managed_storage_values_.push_back({val});
           // first of a group, update the shared map with the index
           if (should_share.count(val)) {
             for (auto v : should_share.at(val)) {
@@ -737,6 +1290,142 @@ at::DataPtr MemoryPlanner::allocate_buffer(size_t size) {
   return allocator->allocate(size);
 }
 
+// Greedy-by-size offset assignment: visit the storages from the largest to
+// the smallest and place each one into the smallest gap between the already
+// placed storages whose lifetimes overlap with its own, or after all of them
+// if no gap is big enough. Returns the total size of the buffer.
+size_t MemoryPlanner::assign_offsets(
+    const std::vector<size_t>& sizes,
+    const std::vector<std::pair<size_t, size_t>>& lifetimes,
+    std::vector<size_t>& offsets) {
+  DCHECK_EQ(sizes.size(), lifetimes.size());
+  std::vector<size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sizes[a] > sizes[b];
+  });
+
+  offsets.assign(sizes.size(), 0);
+  size_t total = 0;
+  // indices of the placed storages, sorted by offset
+  std::vector<size_t> placed;
+  for (size_t idx : order) {
+    const size_t size = sizes[idx];
+    if (size == 0) {
+      continue;
+    }
+    const auto& lifetime = lifetimes[idx];
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (size_t other : placed) {
+      const auto& other_lifetime = lifetimes[other];
+      if (other_lifetime.second < lifetime.first ||
+          lifetime.second < other_lifetime.first) {
+        continue;
+      }
+      if (offsets[other] >= prev_end) {
+        size_t gap = offsets[other] - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end = std::max(prev_end, offsets[other] + sizes[other]);
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+    offsets[idx] = best_offset;
+    total = std::max(total, best_offset + size);
+    auto pos = std::upper_bound(
+        placed.begin(), placed.end(), idx, [&](size_t a, size_t b) {
+          return offsets[a] < offsets[b];
+        });
+    placed.insert(pos, idx);
+  }
+  return total;
+}
+
+void MemoryPlanner::plan_ahead_of_time(
+    StaticRuntime* runtime,
+    const std::unordered_map<Value*, size_t>& value_sizes) {
+  const std::shared_ptr<Graph>& graph =
+      runtime->get_inference_module()->graph;
+  const auto& nodes = runtime->get_nodes();
+
+  // Lifetime of every value as the range of indices into nodes: from the
+  // node defining it to the last node at which it is live.
+  std::unordered_map<Value*, std::pair<size_t, size_t>> lifetimes;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (Value* out : nodes[i].get_node()->outputs()) {
+      lifetimes[out] = std::make_pair(i, i);
+    }
+  }
+  auto liveness_sets = BuildLivenessSets(graph);
+  // With inter-op parallelism the execution order is not known ahead of
+  // time, so storages are never shared.
+  const bool sequential = !runtime->get_options().enable_inter_op_parallelism;
+  for (size_t i = 0; sequential && i < nodes.size(); ++i) {
+    auto it = liveness_sets.find(nodes[i].get_node());
+    if (it == liveness_sets.end()) {
+      continue;
+    }
+    for (Value* v : it->second) {
+      auto lifetime = lifetimes.find(v);
+      if (lifetime != lifetimes.end()) {
+        lifetime->second.second = std::max(lifetime->second.second, i);
+      }
+    }
+  }
+
+  // A storage must stay alive as long as any value that may alias it, e.g.
+  // the output of a view op, and until the end if it may escape through the
+  // graph outputs.
+  AliasDb alias_db(graph);
+  managed_lifetimes_.clear();
+  for (const auto& vals : managed_storage_values_) {
+    auto lifetime = lifetimes.at(vals[0]);
+    if (!sequential) {
+      managed_lifetimes_.emplace_back(0, nodes.size());
+      continue;
+    }
+    for (Value* v : vals) {
+      for (const auto& p : lifetimes) {
+        if (p.first == v || !p.first->type()->cast<TensorType>()) {
+          continue;
+        }
+        if (alias_db.mayAlias(v, p.first)) {
+          lifetime.first = std::min(lifetime.first, p.second.first);
+          lifetime.second = std::max(lifetime.second, p.second.second);
+        }
+      }
+      for (Value* output : graph->outputs()) {
+        if (alias_db.mayAlias(v, output)) {
+          lifetime.second = nodes.size();
+        }
+      }
+    }
+    managed_lifetimes_.emplace_back(lifetime);
+  }
+
+  std::vector<size_t> sizes;
+  for (size_t i = 0; i < managed_storage_.size(); ++i) {
+    size_t max = 0;
+    for (Value* v : managed_storage_values_[i]) {
+      auto it = value_sizes.find(v);
+      if (it != value_sizes.end()) {
+        max = std::max(max, compute_aligned_tensor_size(it->second));
+      }
+    }
+    managed_storage_[i].first = max;
+    sizes.emplace_back(max);
+  }
+  managed_bytes_ = assign_offsets(sizes, managed_lifetimes_, managed_offsets_);
+  VLOG(1) << "Planned " << managed_bytes_ << " bytes ahead of time for "
+          << managed_storage_.size() << " storages";
+}
+
 void MemoryPlanner::allocate() {
   if (managed_bytes_ == 0) {
     return;
@@ -747,11 +1436,15 @@ void MemoryPlanner::allocate() {
   size_t offset = 0;
   uint8_t* start = static_cast<uint8_t*>(buffer_.get());
 
-  for (const auto& ms : managed_storage_) {
+  for (size_t i = 0; i < managed_storage_.size(); ++i) {
+    const auto& ms = managed_storage_[i];
     auto tensor_size = ms.first;
     if (tensor_size == 0) {
       continue;
     }
+    if (is_planned_ahead_of_time()) {
+      offset = managed_offsets_[i];
+    }
     const auto& impls = ms.second;
     DCHECK_LE(offset + tensor_size, managed_bytes_);
     void* src = static_cast<void*>(start + offset);
@@ -763,11 +1456,25 @@ void MemoryPlanner::allocate() {
 
     offset += tensor_size;
   }
-  DCHECK_EQ(offset, managed_bytes_);
+  DCHECK(is_planned_ahead_of_time() || offset == managed_bytes_);
+}
+
+size_t MemoryPlanner::total_unmanaged() const {
+  size_t bytes = 0;
+  for (const IValue* iv : unmanaged_values_) {
+    if (iv->isTensor()) {
+      const auto& t = iv->toTensor();
+      if (t.defined() && t.has_storage()) {
+        bytes += t.storage().nbytes();
+      }
+    }
+  }
+  return bytes;
 }
 
 void MemoryPlanner::deallocate() {
-  managed_bytes_ = 0;
+  size_t total = 0;
+  bool grown = false;
 
   // free memory used by outputs of ops in out variants
   // but keep the TensorImpl and StorageImpl around
@@ -779,8 +1486,26 @@ void MemoryPlanner::deallocate() {
       impl->reset();
       max = std::max(max, current_size);
     }
+    grown |= max > ms.first;
+    if (is_planned_ahead_of_time()) {
+      // never shrink a planned size, it covers the largest bucket
+      max = std::max(max, ms.first);
+    }
     ms.first = max;
-    managed_bytes_ += max;
+    total += max;
+  }
+  if (!is_planned_ahead_of_time()) {
+    managed_bytes_ = total;
+  } else if (grown) {
+    std::vector<size_t> sizes;
+    sizes.reserve(managed_storage_.size());
+    for (const auto& ms : managed_storage_) {
+      sizes.emplace_back(ms.first);
+    }
+    managed_bytes_ =
+        assign_offsets(sizes, managed_lifetimes_, managed_offsets_);
+    VLOG(1) << "Managed storage outgrew the ahead-of-time plan, replanned "
+            << managed_bytes_ << " bytes";
   }
   for (auto& iv : unmanaged_values_) {
     *iv = IValue();
@@ -791,10 +1516,27 @@ void MemoryPlanner::deallocate() {
 ProcessedNode::ProcessedNode(
     Node* node,
     std::vector<const IValue*>&& inputs,
-    bool enable_out_variants)
-    : node_(node), inputs_(std::move(inputs)) {
+    bool enable_out_variants,
+    std::vector<std::unique_ptr<StaticRuntime>> block_runtimes)
+    : node_(node),
+      inputs_(std::move(inputs)),
+      block_runtimes_(std::move(block_runtimes)) {
   // TODO leverage type information
   outputs_.resize(node->outputs().size());
+  if (node->kind() == prim::If || node->kind() == prim::Loop) {
+    TORCH_CHECK(block_runtimes_.size() == node->blocks().size());
+    // both blocks of a prim::If take the same inputs
+    const InferenceModule* block = block_runtimes_[0]->get_inference_module();
+    block_args_.resize(block->input_regs.size());
+    block_outputs_.resize(block->output_regs.size());
+    if (node->kind() == prim::If) {
+      native_fn_ = [](ProcessedNode* p_node) { p_node->run_if(); };
+    } else {
+      native_fn_ = [](ProcessedNode* p_node) { p_node->run_loop(); };
+    }
+    VLOG(1) << "Nested static runtimes for node: " << *node;
+    return;
+  }
   if (node->kind() != prim::ListConstruct &&
       node->kind() != prim::TupleConstruct &&
       node->kind() != prim::ListUnpack) {
@@ -803,7 +1545,10 @@ ProcessedNode::ProcessedNode(
     op_ = op.getOperation(node);
   }
   if (enable_out_variants && canRunOutOfPlace(node)) {
+    // may be empty if the out variant does not support this overload
     fn_ = getOutOfPlaceOperation(node);
+  }
+  if (fn_) {
     std::ostringstream ss;
     node->print(ss, 0, nullptr, false);
     VLOG(1) << "Switch to out variant for node: " << ss.str();
@@ -842,5 +1587,52 @@ void ProcessedNode::run() {
   }
 }
 
+// The branch taken is chosen by the condition, Input(0). The captured values
+// follow the inputs of the node and are the inputs of both blocks.
+void ProcessedNode::run_if() {
+  StaticRuntime& block = *block_runtimes_[Input(0).toBool() ? 0 : 1];
+  const size_t num_node_inputs = node_->inputs().size();
+  DCHECK_EQ(block_args_.size(), inputs_.size() - num_node_inputs);
+  for (size_t i = 0; i < block_args_.size(); i++) {
+    block_args_[i] = Input(num_node_inputs + i);
+  }
+  block.run_block(block_args_, outputs_);
+}
+
+// The inputs of the node are the max trip count, the initial condition and
+// the initial values of the loop-carried dependencies. The body takes the
+// captured values, the iteration count and the loop-carried values, and
+// returns the condition for the next iteration and the new loop-carried
+// values. The loop-carried values live in outputs_ between iterations.
+void ProcessedNode::run_loop() {
+  StaticRuntime& body = *block_runtimes_[0];
+  const int64_t max_trip_count = Input(0).toInt();
+  bool cond = Input(1).toBool();
+  const size_t num_node_inputs = node_->inputs().size();
+  const size_t num_captured = inputs_.size() - num_node_inputs;
+  const size_t num_carried = outputs_.size();
+  DCHECK_EQ(num_node_inputs, num_carried + 2);
+  DCHECK_EQ(block_args_.size(), num_captured + 1 + num_carried);
+  DCHECK_EQ(block_outputs_.size(), num_carried + 1);
+
+  for (size_t i = 0; i < num_carried; i++) {
+    Output(i) = Input(i + 2);
+  }
+  for (int64_t trip = 0; cond && trip < max_trip_count; trip++) {
+    for (size_t i = 0; i < num_captured; i++) {
+      block_args_[i] = Input(num_node_inputs + i);
+    }
+    block_args_[num_captured] = trip;
+    for (size_t i = 0; i < num_carried; i++) {
+      block_args_[num_captured + 1 + i] = std::move(Output(i));
+    }
+    body.run_block(block_args_, block_outputs_);
+    cond = block_outputs_[0].toBool();
+    for (size_t i = 0; i < num_carried; i++) {
+      Output(i) = std::move(block_outputs_[i + 1]);
+    }
+  }
+}
+
 } // namespace jit
 } // namespace torch
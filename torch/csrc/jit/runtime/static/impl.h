@@ -7,6 +7,12 @@
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/passes/constant_propagation.h>
 #include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/runtime/static/metrics.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace torch {
 namespace jit {
@@ -18,6 +24,12 @@ struct TORCH_API InferenceModuleOptions {
 struct TORCH_API StaticRuntimeOptions {
   bool cleanup_activations{true};
   bool enable_out_variant{true};
+  // run independent nodes concurrently on the inter-op thread pool
+  bool enable_inter_op_parallelism{false};
+  // time every node and count its allocations in one out of every
+  // metrics_sampling_period runs, see StaticRuntime::get_metrics().
+  // 0 disables metrics.
+  size_t metrics_sampling_period{0};
 };
 
 /// Static runime supports two execution modes.
@@ -35,6 +47,11 @@ struct TORCH_API StaticRuntimeOptions {
 ///   auto runtime = StaticRuntime(mod, opts);
 ///   auto output = runtime.run(args, kwargs);
 /// @endcode
+/// Setting StaticRuntimeOptions::enable_inter_op_parallelism additionally
+/// lets a single run() execute independent branches of the graph
+/// concurrently on the inter-op thread pool (see at::launch). The thread
+/// calling run() takes part in running the nodes, so a run makes progress even
+/// when called from the inter-op pool and all of its threads are busy.
 /// Mode 2: similar to data parallelism, run the same model for different inputs
 /// on different threads at the same time. In this case, run
 /// PrepareForStaticRuntime to prepare the graph for Static Runtime. You
@@ -79,6 +96,18 @@ struct TORCH_API InferenceModule {
   size_t reused_regs = 0;
   InferenceModuleOptions opts;
 
+  // Every block of a prim::If or prim::Loop node is prepared as a graph of
+  // its own and run by a nested Static Runtime, with its own registers and
+  // memory planner. The values a node's blocks capture from the enclosing
+  // graph are passed to each block as its first inputs, followed by the
+  // inputs of the block itself (the iteration count and loop-carried values
+  // of a prim::Loop body).
+  struct Blocks {
+    std::vector<Value*> captured_values;
+    std::vector<std::shared_ptr<InferenceModule>> modules;
+  };
+  std::unordered_map<Node*, Blocks> blocks;
+
  private:
   void init();
 };
@@ -114,6 +143,13 @@ class TORCH_API StaticRuntime {
 
   std::vector<at::Tensor> run(const std::vector<at::Tensor>& inps);
 
+  // Runs the graph of a block. The inputs are moved out of args and the
+  // graph outputs are written to outputs, which must have num_outputs()
+  // elements. Used by prim::If and prim::Loop to run their blocks.
+  void run_block(
+      std::vector<c10::IValue>& args,
+      std::vector<c10::IValue>& outputs);
+
   // This interface only works module_ that has a non-empty TorchScript module
   // member; otherwise use the above interface
   c10::IValue run(
@@ -147,6 +183,47 @@ class TORCH_API StaticRuntime {
       const int warmup_runs,
       const int main_runs);
 
+  struct NodeMetrics {
+    std::string kind;
+    // whether the node falls back to the boxed operator of the JIT
+    bool is_fallback;
+    uint64_t num_samples;
+    float mean_ms;
+    float p50_ms;
+    float p99_ms;
+    // totals over the sampled runs
+    uint64_t bytes_allocated;
+    uint64_t num_allocations;
+  };
+
+  struct LiveMetrics {
+    uint64_t num_runs;
+    uint64_t num_sampled_runs;
+    float p50_ms;
+    float p99_ms;
+    // as of the last sampled run
+    size_t managed_bytes;
+    size_t unmanaged_bytes;
+    size_t num_fallback_nodes;
+    std::vector<NodeMetrics> nodes;
+  };
+
+  // Snapshot of the metrics sampled so far, see
+  // StaticRuntimeOptions::metrics_sampling_period. Unlike run(), this can be
+  // called from any thread, including while another thread is running the
+  // model.
+  LiveMetrics get_metrics() const;
+  void reset_metrics();
+
+  // Plan memory ahead of time instead of profiling the first iteration.
+  // Each entry of input_buckets is a representative set of inputs for one
+  // shape bucket; only the types and shapes of the tensors are used. The
+  // sizes of all managed tensors are inferred with shape propagation, their
+  // lifetimes are computed with liveness analysis and they are packed into a
+  // single arena big enough for the largest bucket, so that even the first
+  // run() allocates the arena only once.
+  void plan_memory(const std::vector<std::vector<c10::IValue>>& input_buckets);
+
   const InferenceModule* get_inference_module() {
     return module_.get();
   }
@@ -169,6 +246,10 @@ class TORCH_API StaticRuntime {
     return outputs_;
   }
 
+  const StaticRuntimeOptions& get_options() const {
+    return opts_;
+  }
+
  private:
   // Static runtime states
   std::shared_ptr<InferenceModule> module_;
@@ -178,6 +259,9 @@ class TORCH_API StaticRuntime {
   std::vector<IValue> constants_;
   std::vector<IValue> inputs_;
   std::vector<IValue*> outputs_;
+  // the graph outputs produced by nodes_, which are released after each run
+  // so that ops with out variants do not overwrite the returned values
+  std::vector<IValue*> node_outputs_;
   // The nodes we need to run
   std::vector<ProcessedNode> nodes_;
 
@@ -186,6 +270,43 @@ class TORCH_API StaticRuntime {
   // runtime.
   std::unique_ptr<MemoryPlanner> planner_;
 
+  // Dependency DAG between nodes_, only built if
+  // opts_.enable_inter_op_parallelism is true. A node becomes ready once all
+  // the nodes it depends on have run.
+  std::vector<std::vector<size_t>> node_dependents_;
+  std::vector<size_t> node_num_deps_;
+  std::vector<size_t> root_nodes_;
+
+  // Scheduler state of the current run. The counters are decremented by the
+  // tasks without locking; the mutex guards the ready nodes, completion and
+  // errors. Ready nodes are taken by the tasks launched on the inter-op pool
+  // and by the calling thread, whichever comes first. Shared with the tasks,
+  // which may only get to run after run() has returned.
+  struct ParallelRunState {
+    std::unique_ptr<std::atomic<size_t>[]> pending_deps;
+    std::atomic<size_t> remaining{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    bool finished{false};
+    std::deque<size_t> ready;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  std::shared_ptr<ParallelRunState> parallel_state_;
+
+  // Only allocated if opts_.metrics_sampling_period > 0
+  std::unique_ptr<StaticRuntimeCounters> counters_;
+  // whether the current run is sampled
+  bool sampling_{false};
+
+  void run_nodes();
+  void run_node(size_t idx);
+  void release_outputs();
+  void build_dependency_graph();
+  void run_nodes_in_parallel();
+  void run_node_and_dependents(size_t idx);
+  void launch_ready_node(size_t idx);
+
   // Input is readwrite
   IValue& Input(size_t i) {
     DCHECK(i < inputs_.size());
@@ -220,6 +341,13 @@ class TORCH_API StaticRuntime {
 ///      the default allocator for memory allocation.
 ///   3. free the buffer at the end of each iteration
 /// Steps 1 and 3 are handled by `deallocate()`, and step 2 by `allocate()`.
+///
+/// Alternatively, `plan_ahead_of_time()` takes statically inferred sizes and
+/// computes the lifetime of every managed StorageImpl with liveness analysis.
+/// Storages with disjoint lifetimes then share memory in the buffer, and the
+/// offsets are assigned greedily by size (largest first, best fitting gap).
+/// If a storage outgrows its planned size at runtime, the offsets are
+/// recomputed with the new size at the end of that iteration.
 /// Only models with simple output types are supported, i.e. None, Tensor or
 /// List/Tuple of Tensors. Complex output types such as List of Lists are not
 /// supported.
@@ -232,9 +360,14 @@ class MemoryPlanner {
 
   void allocate();
   void deallocate();
+  void plan_ahead_of_time(
+      StaticRuntime* runtime,
+      const std::unordered_map<Value*, size_t>& value_sizes);
   size_t total_managed() const {
     return managed_bytes_;
   }
+  // bytes held by the unmanaged values, only meaningful before deallocate()
+  size_t total_unmanaged() const;
 
  private:
   std::vector<IValue*> unmanaged_values_;
@@ -243,19 +376,38 @@ class MemoryPlanner {
   // Thus, if memonger is disabled, all vectors are of size 1.
   std::vector<std::pair<size_t, std::vector<c10::StorageImpl*>>>
       managed_storage_;
+  // the Values backed by each entry of managed_storage_
+  std::vector<std::vector<Value*>> managed_storage_values_;
+  // only populated by plan_ahead_of_time(): the [first, last] node index
+  // during which each entry of managed_storage_ is alive, and its offset
+  // into buffer_
+  std::vector<std::pair<size_t, size_t>> managed_lifetimes_;
+  std::vector<size_t> managed_offsets_;
   size_t managed_bytes_{0};
   at::DataPtr buffer_; // allocated each time we call Run()
 
+  bool is_planned_ahead_of_time() const {
+    return !managed_lifetimes_.empty();
+  }
+
   static size_t compute_aligned_tensor_size(size_t nbytes);
   static at::DataPtr allocate_buffer(size_t size);
+  static size_t assign_offsets(
+      const std::vector<size_t>& sizes,
+      const std::vector<std::pair<size_t, size_t>>& lifetimes,
+      std::vector<size_t>& offsets);
 };
 
 class ProcessedNode {
  public:
+  // For prim::If and prim::Loop, inputs also holds the values captured by
+  // the blocks after the inputs of the node, and block_runtimes holds one
+  // runtime per block.
   ProcessedNode(
       Node* n,
       std::vector<const IValue*>&& inputs,
-      bool enable_out_variant);
+      bool enable_out_variant,
+      std::vector<std::unique_ptr<StaticRuntime>> block_runtimes = {});
 
   void run();
 
@@ -287,6 +439,10 @@ class ProcessedNode {
     return static_cast<bool>(fn_);
   }
 
+  bool is_fallback() const {
+    return !fn_ && !native_fn_;
+  }
+
  private:
   Node* node_;
   c10::optional<Operation> op_;
@@ -294,6 +450,13 @@ class ProcessedNode {
   std::function<void(ProcessedNode*)> native_fn_;
   std::vector<const IValue*> inputs_; // unowned
   std::vector<IValue> outputs_; // TODO make list for safety
+  std::vector<std::unique_ptr<StaticRuntime>> block_runtimes_;
+  // scratch space for the inputs and outputs of block_runtimes_
+  std::vector<IValue> block_args_;
+  std::vector<IValue> block_outputs_;
+
+  void run_if();
+  void run_loop();
 };
 
 } // namespace jit
@@ -0,0 +1,110 @@
+#include <torch/csrc/jit/runtime/static/metrics.h>
+
+#include <c10/util/llvmMathExtras.h>
+
+#include <cmath>
+
+namespace torch {
+namespace jit {
+
+namespace {
+thread_local uint64_t tls_bytes_allocated = 0;
+thread_local uint64_t tls_num_allocations = 0;
+} // namespace
+
+constexpr size_t LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& c : counts_) {
+    c.store(0, std::memory_order_relaxed);
+  }
+}
+
+// Bucket 4 * k + s holds [(4 + s) * 2^k / 4, (5 + s) * 2^k / 4), i.e. the
+// leading bit of nanos selects k and the next two bits select s.
+size_t LatencyHistogram::bucket(uint64_t nanos) {
+  if (nanos == 0) {
+    return 0;
+  }
+  const unsigned msb = c10::llvm::Log2_64(nanos);
+  const uint64_t sub = msb >= 2 ? (nanos >> (msb - 2)) & 3
+                                : (nanos << (2 - msb)) & 3;
+  return msb * kSubBuckets + sub;
+}
+
+double LatencyHistogram::bucket_upper_bound(size_t bucket) {
+  const int msb = bucket / kSubBuckets;
+  const int sub = bucket % kSubBuckets;
+  return std::ldexp(5 + sub, msb - 2);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  counts_[bucket(nanos)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+  for (auto& c : counts_) {
+    c.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  total_nanos_.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::percentile(double p) const {
+  // sum the buckets instead of using count_, which may be out of sync with
+  // them while recording
+  std::array<uint64_t, kNumBuckets> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = counts_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(p / 100.0 * total)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return bucket_upper_bound(i);
+    }
+  }
+  return bucket_upper_bound(kNumBuckets - 1);
+}
+
+void AllocationCounter::reportMemoryUsage(
+    void* /* unused */,
+    int64_t alloc_size,
+    c10::Device /* unused */) {
+  if (alloc_size > 0) {
+    tls_bytes_allocated += alloc_size;
+    tls_num_allocations++;
+  }
+}
+
+uint64_t AllocationCounter::thread_bytes() {
+  return tls_bytes_allocated;
+}
+
+uint64_t AllocationCounter::thread_allocations() {
+  return tls_num_allocations;
+}
+
+void StaticRuntimeCounters::reset() {
+  for (size_t i = 0; i < num_nodes; ++i) {
+    nodes[i].latency.reset();
+    nodes[i].bytes_allocated.store(0, std::memory_order_relaxed);
+    nodes[i].num_allocations.store(0, std::memory_order_relaxed);
+  }
+  run_latency.reset();
+  num_runs.store(0, std::memory_order_relaxed);
+  num_sampled_runs.store(0, std::memory_order_relaxed);
+}
+
+} // namespace jit
+} // namespace torch
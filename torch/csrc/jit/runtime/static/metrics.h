@@ -0,0 +1,91 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace torch {
+namespace jit {
+
+/// Histogram of latencies in nanoseconds. The buckets grow geometrically,
+/// four per power of two, so a percentile is accurate to within 19%.
+/// Recording never blocks, and a snapshot can be read from any thread while
+/// another one is recording.
+class TORCH_API LatencyHistogram {
+ public:
+  static constexpr size_t kSubBuckets = 4;
+  static constexpr size_t kNumBuckets = 64 * kSubBuckets;
+
+  LatencyHistogram();
+
+  void record(uint64_t nanos);
+  void reset();
+
+  uint64_t count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t total_nanos() const {
+    return total_nanos_.load(std::memory_order_relaxed);
+  }
+
+  // Upper bound of the bucket holding the p-th percentile, p in [0, 100].
+  // Returns 0 if nothing has been recorded.
+  double percentile(double p) const;
+
+ private:
+  static size_t bucket(uint64_t nanos);
+  static double bucket_upper_bound(size_t bucket);
+
+  std::array<std::atomic<uint64_t>, kNumBuckets> counts_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> total_nanos_{0};
+};
+
+/// Counts the bytes allocated by the current thread while installed as
+/// DebugInfoKind::MEMORY_REPORTER (see c10::reportMemoryUsageToProfiler).
+/// Frees are ignored.
+class TORCH_API AllocationCounter : public c10::MemoryReportingInfoBase {
+ public:
+  void reportMemoryUsage(void* ptr, int64_t alloc_size, c10::Device device)
+      override;
+
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+
+  // Running totals of the calling thread
+  static uint64_t thread_bytes();
+  static uint64_t thread_allocations();
+};
+
+/// Counters of a StaticRuntime, updated by the thread running it and
+/// readable from any other thread.
+struct TORCH_API StaticRuntimeCounters {
+  struct Node {
+    LatencyHistogram latency;
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> num_allocations{0};
+  };
+
+  explicit StaticRuntimeCounters(size_t num_nodes)
+      : num_nodes(num_nodes), nodes(new Node[num_nodes]) {}
+
+  void reset();
+
+  const size_t num_nodes;
+  std::unique_ptr<Node[]> nodes;
+  LatencyHistogram run_latency;
+  std::atomic<uint64_t> num_runs{0};
+  std::atomic<uint64_t> num_sampled_runs{0};
+  // as of the last sampled run
+  std::atomic<size_t> managed_bytes{0};
+  std::atomic<size_t> unmanaged_bytes{0};
+};
+
+} // namespace jit
+} // namespace torch
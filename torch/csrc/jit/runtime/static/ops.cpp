@@ -1,10 +1,20 @@
 #include <torch/csrc/jit/runtime/static/ops.h>
 
 #include <ATen/CPUFunctions.h>
+#include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/TensorIterator.h>
+#include <ATen/native/Activation.h>
+#include <ATen/native/EmbeddingBag.h>
+#include <ATen/native/SoftMax.h>
+#include <ATen/native/TensorCompare.h>
+#include <ATen/native/layer_norm.h>
+#include <ATen/native/quantized/cpu/packed_params.h>
 #include <ATen/native/quantized/cpu/qembeddingbag.h>
+#include <ATen/quantized/Quantizer.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
+#include <torch/custom_class.h>
 
 namespace torch {
 namespace jit {
@@ -332,6 +342,425 @@ REGISTER_OPERATOR_FUNCTOR(aten::narrow, aten_narrow, [](Node* n) -> SROperator {
   };
 });
 
+REGISTER_OPERATOR_FUNCTOR(
+    aten::softmax,
+    aten_softmax,
+    [](Node* n) -> SROperator {
+      if (n->inputs().size() != 3 || !n->input(1)->type()->cast<IntType>()) {
+        return nullptr;
+      }
+      return [](ProcessedNode* p_node) {
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in1_i = p_node->Input(1).toInt();
+        auto in2_o = p_node->Input(2).toOptional<at::ScalarType>();
+        auto in0 = in2_o ? in0_t.to(*in2_o) : in0_t;
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = create_empty_from(in0);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        fastResizeToZero(out_t);
+        at::native::softmax_cpu_out(out_t, in0, in1_i, false);
+      };
+    });
+
+REGISTER_OPERATOR_FUNCTOR(
+    aten::log_softmax,
+    aten_log_softmax,
+    [](Node* n) -> SROperator {
+      if (n->inputs().size() != 3 || !n->input(1)->type()->cast<IntType>()) {
+        return nullptr;
+      }
+      return [](ProcessedNode* p_node) {
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in1_i = p_node->Input(1).toInt();
+        auto in2_o = p_node->Input(2).toOptional<at::ScalarType>();
+        auto in0 = in2_o ? in0_t.to(*in2_o) : in0_t;
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = create_empty_from(in0);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        fastResizeToZero(out_t);
+        at::native::log_softmax_cpu_out(out_t, in0, in1_i, false);
+      };
+    });
+
+REGISTER_OPERATOR_FUNCTOR(aten::gelu, aten_gelu, [](Node* n) -> SROperator {
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(in0_t);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    auto iter = at::TensorIterator::unary_op(out_t, in0_t);
+    at::native::GeluKernel(at::kCPU, iter);
+  };
+});
+
+REGISTER_OPERATOR_FUNCTOR(
+    aten::layer_norm,
+    aten_layer_norm,
+    [](Node* n) -> SROperator {
+      return [](ProcessedNode* p_node) {
+        // ignore Input(5): `bool cudnn_enable=True`
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in1_iv = p_node->Input(1).toIntVector();
+        auto in2_o = p_node->Input(2).toOptional<at::Tensor>();
+        auto in3_o = p_node->Input(3).toOptional<at::Tensor>();
+        auto in4_d = p_node->Input(4).toDouble();
+        auto inputs = at::native::_prepare_layer_norm_inputs(
+            in0_t,
+            in1_iv,
+            in2_o ? *in2_o : at::Tensor(),
+            in3_o ? *in3_o : at::Tensor());
+        auto X = std::get<0>(inputs);
+        auto gamma = std::get<1>(inputs);
+        auto beta = std::get<2>(inputs);
+        auto M = std::get<3>(inputs);
+        auto N = std::get<4>(inputs);
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = create_empty_from(X);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        at::native::resize_(out_t, X.sizes(), c10::nullopt);
+        if (M > 0) {
+          auto mean = at::empty({M}, X.options());
+          auto rstd = at::empty({M}, X.options());
+          at::native::LayerNormKernel(
+              at::kCPU, X, gamma, beta, M, N, in4_d, &out_t, &mean, &rstd);
+        }
+      };
+    });
+
+REGISTER_OPERATOR_FUNCTOR(aten::linear, aten_linear, [](Node* n) -> SROperator {
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    auto& in1_t = p_node->Input(1).toTensor();
+    auto in2_o = p_node->Input(2).toOptional<at::Tensor>();
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(in0_t);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    if (in0_t.dim() == 2 && in2_o) {
+      at::native::addmm_cpu_out(out_t, *in2_o, in0_t, in1_t.t(), 1, 1);
+    } else {
+      at::native::matmul_out(out_t, in0_t, in1_t.t());
+      if (in2_o) {
+        out_t.add_(*in2_o);
+      }
+    }
+  };
+});
+
+REGISTER_OPERATOR_FUNCTOR(aten::matmul, aten_matmul, [](Node* n) -> SROperator {
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    auto& in1_t = p_node->Input(1).toTensor();
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(in0_t);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    at::native::matmul_out(out_t, in0_t, in1_t);
+  };
+});
+
+// Handles both aten::sum(Tensor self, *, ScalarType? dtype) and
+// aten::sum.dim_IntList(Tensor self, int[1] dim, bool keepdim, *,
+// ScalarType? dtype); an empty dim list reduces over all dimensions
+SROperator aten_sum(Node* n) {
+  if (n->inputs().size() != 2 && n->inputs().size() != 4) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    std::vector<int64_t> dim;
+    bool keepdim = false;
+    c10::optional<at::ScalarType> dtype;
+    if (p_node->inputs().size() == 4) {
+      dim = p_node->Input(1).toIntVector();
+      keepdim = p_node->Input(2).toBool();
+      dtype = p_node->Input(3).toOptional<at::ScalarType>();
+    } else {
+      dtype = p_node->Input(1).toOptional<at::ScalarType>();
+    }
+    if (p_node->Output(0).isNone()) {
+      // integral inputs are summed into int64 unless a dtype is given
+      auto out_dtype = dtype ? *dtype
+          : at::isIntegralType(in0_t.scalar_type(), /*includeBool=*/true)
+          ? at::kLong
+          : in0_t.scalar_type();
+      p_node->Output(0) = create_empty_from(in0_t, out_dtype);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    at::native::sum_out(out_t, in0_t, dim, keepdim, dtype);
+  };
+}
+
+REGISTER_OPERATOR_FUNCTOR(aten::sum, aten_sum, aten_sum);
+
+// Handles both aten::mean(Tensor self, *, ScalarType? dtype) and
+// aten::mean.dim(Tensor self, int[1] dim, bool keepdim, *, ScalarType? dtype)
+SROperator aten_mean(Node* n) {
+  if (n->inputs().size() != 2 && n->inputs().size() != 4) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    std::vector<int64_t> dim;
+    bool keepdim = false;
+    c10::optional<at::ScalarType> dtype;
+    if (p_node->inputs().size() == 4) {
+      dim = p_node->Input(1).toIntVector();
+      keepdim = p_node->Input(2).toBool();
+      dtype = p_node->Input(3).toOptional<at::ScalarType>();
+    } else {
+      dtype = p_node->Input(1).toOptional<at::ScalarType>();
+    }
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) =
+          create_empty_from(in0_t, dtype.value_or(in0_t.scalar_type()));
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    at::native::mean_out_cpu_gpu(out_t, in0_t, dim, keepdim, dtype);
+  };
+}
+
+REGISTER_OPERATOR_FUNCTOR(aten::mean, aten_mean, aten_mean);
+
+REGISTER_OPERATOR_FUNCTOR(
+    aten::index_select,
+    aten_index_select,
+    [](Node* n) -> SROperator {
+      return [](ProcessedNode* p_node) {
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in1_i = p_node->Input(1).toInt();
+        auto& in2_t = p_node->Input(2).toTensor();
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = create_empty_from(in0_t);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        fastResizeToZero(out_t);
+        at::native::index_select_out_cpu_(out_t, in0_t, in1_i, in2_t);
+      };
+    });
+
+REGISTER_OPERATOR_FUNCTOR(aten::gather, aten_gather, [](Node* n) -> SROperator {
+  if (!n->input(1)->type()->cast<IntType>()) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    auto in1_i = p_node->Input(1).toInt();
+    auto& in2_t = p_node->Input(2).toTensor();
+    auto in3_b = p_node->Input(3).toBool();
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(in0_t);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    at::native::gather_out_cpu_cuda(out_t, in0_t, in1_i, in2_t, in3_b);
+  };
+});
+
+// Only aten::where.self(Tensor condition, Tensor self, Tensor other)
+REGISTER_OPERATOR_FUNCTOR(aten::where, aten_where, [](Node* n) -> SROperator {
+  if (n->inputs().size() != 3 || !n->input(1)->type()->cast<TensorType>() ||
+      !n->input(2)->type()->cast<TensorType>()) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& cond_t = p_node->Input(0).toTensor();
+    auto& self_t = p_node->Input(1).toTensor();
+    auto& other_t = p_node->Input(2).toTensor();
+    TORCH_CHECK(
+        cond_t.scalar_type() == at::kByte || cond_t.scalar_type() == at::kBool,
+        "Expected condition to have ScalarType Byte or Bool, but got ",
+        cond_t.scalar_type());
+    TORCH_CHECK(
+        self_t.dtype() == other_t.dtype(),
+        "expected scalar type ",
+        self_t.dtype(),
+        " but found ",
+        other_t.dtype());
+    at::Tensor b_cond, b_self, b_other;
+    std::tie(b_cond, b_self, b_other) =
+        at::expand_outplace(cond_t, self_t, other_t);
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(self_t);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    at::native::resize_(out_t, b_self.sizes(), c10::nullopt);
+    auto iter = at::TensorIteratorConfig()
+                    .check_all_same_dtype(false)
+                    .add_output(out_t)
+                    .add_input(b_cond)
+                    .add_input(b_self)
+                    .add_input(b_other)
+                    .build();
+    at::native::where_kernel(iter.device_type(), iter, b_cond.scalar_type());
+  };
+});
+
+// Only aten::to.dtype. Unlike aten::to, which returns self when no conversion
+// is needed, the out variant always copies so that the output can be managed
+// by the memory planner. So it is only used when the node is known to copy:
+// the dtype changes or copy=True. Otherwise the native aten::to is cheaper.
+REGISTER_OPERATOR_FUNCTOR(aten::to, aten_to, [](Node* n) -> SROperator {
+  if (n->inputs().size() != 5 || !n->input(1)->type()->cast<IntType>()) {
+    return nullptr;
+  }
+  auto self_type = n->input(0)->type()->cast<TensorType>();
+  auto dtype = toIValue(n->input(1));
+  auto copy = toIValue(n->input(3));
+  const bool converts = self_type && self_type->scalarType() && dtype &&
+      dtype->toScalarType() != *self_type->scalarType();
+  if (!converts && !(copy && copy->toBool())) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& in0_t = p_node->Input(0).toTensor();
+    auto in1_i = p_node->Input(1).toScalarType();
+    // non_blocking and copy make no difference for a copy on CPU
+    auto memory_format = p_node->Input(4).isNone()
+        ? c10::MemoryFormat::Preserve
+        : p_node->Input(4).toMemoryFormat();
+    if (memory_format == c10::MemoryFormat::Preserve) {
+      memory_format = in0_t.suggest_memory_format();
+    }
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(in0_t, in1_i);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    at::native::resize_(out_t, in0_t.sizes(), memory_format);
+    at::native::copy_(out_t, in0_t, false);
+  };
+});
+
+// Only for the output of transpose/permute, which is most likely not
+// contiguous, so that aten::contiguous would copy anyway. Otherwise
+// aten::contiguous returns self and should not be replaced by a copy.
+REGISTER_OPERATOR_FUNCTOR(
+    aten::contiguous,
+    aten_contiguous,
+    [](Node* n) -> SROperator {
+      auto producer = n->input(0)->node()->kind();
+      if (producer != aten::transpose && producer != aten::permute &&
+          producer != aten::t) {
+        return nullptr;
+      }
+      return [](ProcessedNode* p_node) {
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in1_m = p_node->Input(1).toMemoryFormat();
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = create_empty_from(in0_t);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        at::native::resize_(out_t, in0_t.sizes(), in1_m);
+        at::native::copy_(out_t, in0_t, false);
+      };
+    });
+
+namespace {
+// The memory planner keeps the StorageImpls of all the outputs of out
+// variants across iterations, so auxiliary outputs that an op computes as
+// new tensors are copied into the existing output instead of replacing it.
+// Undefined results are represented by empty tensors.
+void copyToOutput(
+    ProcessedNode* p_node,
+    size_t idx,
+    const at::Tensor& src,
+    const at::TensorOptions& options) {
+  if (p_node->Output(idx).isNone()) {
+    p_node->Output(idx) = at::empty({0}, src.defined() ? src.options() : options);
+  }
+  auto& out_t = p_node->Output(idx).toTensor();
+  if (!src.defined()) {
+    fastResizeToZero(out_t);
+    return;
+  }
+  at::native::resize_(out_t, src.sizes(), c10::nullopt);
+  at::native::copy_(out_t, src, false);
+}
+} // namespace
+
+// Only the 8-argument schema of aten::embedding_bag
+SROperator aten_embedding_bag(Node* n) {
+  if (n->inputs().size() != 8) {
+    return nullptr;
+  }
+  return [](ProcessedNode* p_node) {
+    auto& weight = p_node->Input(0).toTensor();
+    auto& indices = p_node->Input(1).toTensor();
+    auto& offsets = p_node->Input(2).toTensor();
+    // Input(3) scale_grad_by_freq and Input(5) sparse only affect backward
+    auto mode = p_node->Input(4).toInt();
+    auto per_sample_weights = p_node->Input(6).toOptional<at::Tensor>();
+    auto include_last_offset = p_node->Input(7).toBool();
+    if (p_node->Output(0).isNone()) {
+      p_node->Output(0) = create_empty_from(weight);
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    auto res = at::native::_embedding_bag_cpu_impl_out(
+        out_t,
+        weight,
+        indices.contiguous(),
+        offsets.contiguous(),
+        mode,
+        per_sample_weights ? *per_sample_weights : at::Tensor(),
+        include_last_offset,
+        /*requires_grad=*/false);
+    copyToOutput(p_node, 1, std::get<1>(res), offsets.options());
+    copyToOutput(p_node, 2, std::get<2>(res), offsets.options());
+    copyToOutput(p_node, 3, std::get<3>(res), offsets.options());
+  };
+}
+
+REGISTER_OPERATOR_FUNCTOR(
+    aten::embedding_bag,
+    aten_embedding_bag,
+    aten_embedding_bag);
+
+REGISTER_OPERATOR_FUNCTOR(
+    quantized::linear,
+    quantized_linear,
+    [](Node* n) -> SROperator {
+      // the packed weight is a constant in frozen graphs
+      c10::intrusive_ptr<LinearPackedParamsBase> packed_weight;
+      if (auto w = toIValue(n->inputs()[1])) {
+        packed_weight = w->toCustomClass<LinearPackedParamsBase>();
+      }
+      return [packed_weight](ProcessedNode* p_node) {
+        auto& in0_t = p_node->Input(0).toTensor();
+        auto in2_d = p_node->Input(2).toDouble();
+        auto in3_i = p_node->Input(3).toInt();
+        if (p_node->Output(0).isNone()) {
+          p_node->Output(0) = at::_empty_affine_quantized(
+              {0},
+              at::device(c10::kCPU).dtype(c10::kQUInt8),
+              in2_d,
+              in3_i);
+        }
+        auto& out_t = p_node->Output(0).toTensor();
+        if (out_t.q_scale() != in2_d || out_t.q_zero_point() != in3_i) {
+          at::set_quantizer_(
+              out_t,
+              at::make_per_tensor_affine_quantizer(in2_d, in3_i, c10::kQUInt8));
+        }
+        fastResizeToZero(out_t);
+        if (packed_weight) {
+          packed_weight->apply_out(in0_t, in2_d, in3_i, out_t);
+        } else {
+          p_node->Input(1).toCustomClass<LinearPackedParamsBase>()->apply_out(
+              in0_t, in2_d, in3_i, out_t);
+        }
+      };
+    });
+
 std::function<void(ProcessedNode*)> getOutOfPlaceOperation(Node* n) {
   auto op_name = n->kind().toQualString();
   if (SROperatorRegistry()->Has(op_name)) {
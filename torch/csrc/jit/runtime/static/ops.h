@@ -48,6 +48,12 @@ inline at::Tensor create_empty_from(const at::Tensor& t) {
   return at::empty({0}, t.options());
 }
 
+inline at::Tensor create_empty_from(
+    const at::Tensor& t,
+    c10::ScalarType dtype) {
+  return at::empty({0}, t.options().dtype(dtype));
+}
+
 inline bool checkResizedDataPtr(at::Tensor& t) {
   auto const prev_data_ptr = t.data_ptr();
   t.resize_({0});
@@ -0,0 +1,163 @@
+#include <torch/csrc/jit/runtime/unboxed_ops.h>
+
+#include <ATen/core/boxing/impl/make_boxed_from_unboxed_functor.h>
+#include <ATen/core/dispatch/DispatchKeyExtractor.h>
+#include <c10/core/DispatchKeySet.h>
+#include <c10/core/impl/LocalDispatchKeySet.h>
+
+#include <unordered_map>
+#include <utility>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using at::Scalar;
+using at::Tensor;
+
+// The key set of a dense CPU tensor.
+c10::DispatchKeySet cpuTensorKeySet() {
+  return c10::DispatchKeySet(c10::DispatchKey::CPU)
+      .add(c10::getAutogradKeyFromBackend(c10::DispatchKey::CPU));
+}
+
+// The combined key set of the tensor arguments of a call on the stack.
+c10::DispatchKeySet argumentsKeySet(Stack& stack, size_t num_args) {
+  c10::DispatchKeySet ks;
+  for (size_t i = 0; i < num_args; ++i) {
+    const IValue& v = peek(stack, i, num_args);
+    if (v.isTensor()) {
+      ks = ks | v.unsafeToTensorImpl()->key_set();
+    }
+  }
+  return ks;
+}
+
+// The dispatch key of calls on dense CPU tensors, resolved for the thread
+// local dispatch key state at creation time, which is the state calls are
+// most likely made in. Calls in another state resolve the key again, e.g. the
+// lite interpreter loads models outside of the AutoNonVariableTypeMode it
+// runs them in.
+struct CPUDispatchKey {
+  CPUDispatchKey(const c10::OperatorHandle& handle)
+      : local(c10::impl::tls_local_dispatch_key_set()),
+        key(handle.dispatchKeyForKeySet(cpuTensorKeySet())) {}
+
+  c10::DispatchKey get(const c10::OperatorHandle& handle) const {
+    c10::impl::LocalDispatchKeySet current =
+        c10::impl::tls_local_dispatch_key_set();
+    if (C10_LIKELY(
+            current.included_ == local.included_ &&
+            current.excluded_ == local.excluded_)) {
+      return key;
+    }
+    return handle.dispatchKeyForKeySet(cpuTensorKeySet());
+  }
+
+  c10::impl::LocalDispatchKeySet local;
+  c10::DispatchKey key;
+};
+
+template <class FuncType>
+struct UnboxedOperation;
+
+template <class Return, class... Args>
+struct UnboxedOperation<Return(Args...)> {
+  static Operation create(const c10::OperatorHandle& handle, Operation boxed) {
+    CPUDispatchKey key(handle);
+    auto op = handle.typed<Return(Args...)>();
+    return [op, key, boxed](Stack* stack) {
+      if (C10_UNLIKELY(
+              !(argumentsKeySet(*stack, sizeof...(Args)) ==
+                cpuTensorKeySet()))) {
+        boxed(stack);
+        return;
+      }
+      call(op, key.get(op), stack, std::index_sequence_for<Args...>());
+    };
+  }
+
+  template <size_t... Is>
+  static void call(
+      const c10::TypedOperatorHandle<Return(Args...)>& op,
+      c10::DispatchKey key,
+      Stack* stack,
+      std::index_sequence<Is...>) {
+    constexpr size_t num_args = sizeof...(Args);
+    // Arguments that are ArrayRefs are converted to vectors that live until
+    // the end of the call.
+    Return result = op.callWithDispatchKey(
+        key,
+        c10::impl::ivalue_to_arg<std::decay_t<Args>, false>::call(
+            std::move(peek(*stack, Is, num_args)))...);
+    drop(*stack, num_args);
+    c10::impl::push_outputs<Return, false>::call(std::move(result), stack);
+  }
+};
+
+using UnboxedOperationCreator =
+    Operation (*)(const c10::OperatorHandle&, Operation);
+
+// The signatures must match the ones the operators are registered with, see
+// ATen/Functions.cpp.
+const std::unordered_map<c10::OperatorName, UnboxedOperationCreator>&
+unboxedOperationCreators() {
+  static const std::unordered_map<c10::OperatorName, UnboxedOperationCreator>
+      creators = {
+          {{"aten::add", "Tensor"},
+           UnboxedOperation<Tensor(const Tensor&, const Tensor&, Scalar)>::
+               create},
+          {{"aten::sub", "Tensor"},
+           UnboxedOperation<Tensor(const Tensor&, const Tensor&, Scalar)>::
+               create},
+          {{"aten::mul", "Tensor"},
+           UnboxedOperation<Tensor(const Tensor&, const Tensor&)>::create},
+          {{"aten::div", "Tensor"},
+           UnboxedOperation<Tensor(const Tensor&, const Tensor&)>::create},
+          {{"aten::relu", ""}, UnboxedOperation<Tensor(const Tensor&)>::create},
+          {{"aten::sigmoid", ""},
+           UnboxedOperation<Tensor(const Tensor&)>::create},
+          {{"aten::tanh", ""}, UnboxedOperation<Tensor(const Tensor&)>::create},
+          {{"aten::t", ""}, UnboxedOperation<Tensor(const Tensor&)>::create},
+          {{"aten::matmul", ""},
+           UnboxedOperation<Tensor(const Tensor&, const Tensor&)>::create},
+          {{"aten::addmm", ""},
+           UnboxedOperation<Tensor(
+               const Tensor&, const Tensor&, const Tensor&, Scalar, Scalar)>::
+               create},
+          {{"aten::linear", ""},
+           UnboxedOperation<Tensor(
+               const Tensor&, const Tensor&, const c10::optional<Tensor>&)>::
+               create},
+          {{"aten::conv2d", ""},
+           UnboxedOperation<Tensor(
+               const Tensor&,
+               const Tensor&,
+               const c10::optional<Tensor>&,
+               at::IntArrayRef,
+               at::IntArrayRef,
+               at::IntArrayRef,
+               int64_t)>::create},
+          {{"aten::softmax", "int"},
+           UnboxedOperation<Tensor(
+               const Tensor&, int64_t, c10::optional<at::ScalarType>)>::create},
+      };
+  return creators;
+}
+
+} // namespace
+
+c10::optional<Operation> createUnboxedOperation(
+    const c10::OperatorHandle& op,
+    Operation boxed) {
+  const auto& creators = unboxedOperationCreators();
+  auto it = creators.find(op.operator_name());
+  if (it == creators.end()) {
+    return c10::nullopt;
+  }
+  return it->second(op, std::move(boxed));
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/stack.h>
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+namespace torch {
+namespace jit {
+
+// Boxed operations unpack their arguments from the stack, compute the
+// dispatch key from them and go through the boxed wrapper of the kernel. For a
+// small set of hot ATen operators with static schemas the interpreters instead
+// use an operation that calls the kernel through its typed handle, with the
+// dispatch key resolved when the operation is created.
+//
+// The key is resolved for calls whose tensor arguments are dense CPU tensors,
+// and again for calls made with a different thread local dispatch key state
+// than at creation time (e.g. under tracing or AutoNonVariableTypeMode). Calls
+// with any other tensors (e.g. CUDA or quantized ones) run `boxed` instead.
+//
+// Returns c10::nullopt if `op` has no unboxed fast path, in which case `boxed`
+// should be used as is.
+TORCH_API c10::optional<Operation> createUnboxedOperation(
+    const c10::OperatorHandle& op,
+    Operation boxed);
+
+} // namespace jit
+} // namespace torch
@@ -6,6 +6,7 @@
 #include <torch/csrc/jit/serialization/pickler.h>
 #include <torch/csrc/onnx/onnx.h>
 
+#include <atomic>
 #include <ostream>
 
 namespace ONNX_NAMESPACE {
@@ -111,6 +112,11 @@ TORCH_API void SetExportModuleMobileInfoConverter(
 // Returns a list of names of all operators in the module and its submodules.
 TORCH_API std::vector<std::string> export_opnames(const Module& m);
 
+// Whether bytecode for the lite interpreter is written with register operands
+// (bytecode version 5). When disabled, the stack based bytecode of version 4
+// is written, which older runtimes can load. Enabled by default.
+TORCH_API std::atomic<bool>& getMobileRegisterOperandsEnabled();
+
 namespace mobile {
 
 class Module;
@@ -23,6 +23,8 @@
 
 #include <ATen/core/jit_type.h>
 #include <ATen/core/qualified_name.h>
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -106,6 +108,70 @@ std::string getModuleTypeName(const Module& module, const std::string& prefix) {
   return prefix + "(" + moduleType + ")";
 }
 
+// Rewrites the operators of the stack based bytecode whose inputs are loaded
+// right before them, and whose output is stored right after them, into an OPR
+// with one REG operand per input and output:
+//
+//   LOAD 1, MOVE 2, OP 0, STORE 3  ->  OPR 0 3, REG 1 0, REG 2 1, REG 3 2
+//
+// The lite interpreter then runs each of these with a single dispatch. The
+// rewritten sequence is as long as the original one, so jump offsets stay
+// valid. Instructions that are jumped to are never turned into operands.
+void emitRegisterOperands(std::vector<Instruction>& instructions) {
+  const size_t n = instructions.size();
+  std::vector<bool> is_jump_target(n + 1, false);
+  for (size_t i = 0; i < n; ++i) {
+    const Instruction& ins = instructions[i];
+    if (ins.op == JF || ins.op == JMP || ins.op == LOOP) {
+      int64_t target = static_cast<int64_t>(i) + ins.X;
+      if (target >= 0 && target <= static_cast<int64_t>(n)) {
+        is_jump_target[target] = true;
+      }
+    }
+  }
+
+  size_t i = 0;
+  while (i < n) {
+    size_t end = i;
+    while (end < n &&
+           (instructions[end].op == LOAD || instructions[end].op == MOVE)) {
+      ++end;
+    }
+    if (end == n || instructions[end].op != OP) {
+      i = std::max(end, i + 1);
+      continue;
+    }
+    size_t start = i;
+    for (size_t j = i + 1; j <= end; ++j) {
+      if (is_jump_target[j]) {
+        start = j;
+      }
+    }
+    bool store = end + 1 < n && instructions[end + 1].op == STORE &&
+        !is_jump_target[end + 1];
+    size_t num_inputs = end - start;
+    size_t num_operands = num_inputs + (store ? 1 : 0);
+    if (num_operands > std::numeric_limits<uint16_t>::max()) {
+      i = end + 1;
+      continue;
+    }
+
+    Instruction op = instructions[end];
+    for (size_t k = num_inputs; k > 0; --k) {
+      const Instruction& load = instructions[start + k - 1];
+      instructions[start + k] = Instruction(
+          REG, load.X, load.op == MOVE ? REG_MOVE : REG_LOAD);
+    }
+    if (store) {
+      instructions[end + 1] =
+          Instruction(REG, instructions[end + 1].X, REG_STORE);
+    }
+    instructions[start] =
+        Instruction(OPR, op.X, static_cast<uint16_t>(num_operands));
+    i = end + (store ? 2 : 1);
+  }
+}
+
 std::pair<IValue, c10::optional<IValue>> getFunctionTuple(
     const Module& module,
     const Function& func,
@@ -193,6 +259,10 @@ std::pair<IValue, c10::optional<IValue>> getFunctionTuple(
     }
   }
 
+  if (getMobileRegisterOperandsEnabled()) {
+    emitRegisterOperands(instructions_copy);
+  }
+
   // instructions
   std::vector<IValue> instructions;
   instructions.reserve(instructions_copy.size());
@@ -471,14 +541,16 @@ class ScriptModuleSerializer {
   }
 
   void writeByteCode(const Module& module, bool save_mobile_debug_info) {
+    auto bytecode_version = static_cast<int64_t>(
+        getMobileRegisterOperandsEnabled()
+            ? caffe2::serialize::kProducedBytecodeVersion
+            : caffe2::serialize::kStackBytecodeVersion);
     std::vector<c10::IValue> elements;
-    elements.emplace_back(
-        static_cast<int64_t>(caffe2::serialize::kProducedBytecodeVersion));
+    elements.emplace_back(bytecode_version);
     c10::optional<std::vector<c10::IValue>> debug_info_elements;
     if (save_mobile_debug_info) {
       debug_info_elements = std::vector<c10::IValue>();
-      debug_info_elements->emplace_back(
-          static_cast<int64_t>(caffe2::serialize::kProducedBytecodeVersion));
+      debug_info_elements->emplace_back(bytecode_version);
     }
 
     moduleMethodsTuple(
@@ -596,6 +668,11 @@ void export_opnames(const script::Module& m, std::set<std::string>& opnames) {
 }
 } // namespace
 
+std::atomic<bool>& getMobileRegisterOperandsEnabled() {
+  static std::atomic<bool> enabled{true};
+  return enabled;
+}
+
 std::vector<std::string> export_opnames(const script::Module& m) {
   std::set<std::string> names;
   export_opnames(m, names);
@@ -18,10 +18,13 @@
 #include <caffe2/serialize/file_adapter.h>
 #include <caffe2/serialize/inline_container.h>
 #include <caffe2/serialize/istream_adapter.h>
+#include <caffe2/serialize/mmap_file_adapter.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <fmt/format.h>
 
+#include <atomic>
 #include <fstream>
 #include <string>
 #include <unordered_map>
@@ -32,6 +35,7 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -57,6 +61,83 @@ void postSetStateValidate(const IValue& v) {
   }
 }
 
+namespace {
+
+std::atomic<bool> mmap_tensor_data{false};
+std::atomic<bool> prefetch_tensor_data{false};
+std::atomic<bool> lazy_tensor_data{false};
+
+// Reads every page of the `size` bytes at `data`.
+void touchPages(const void* data, size_t size) {
+  constexpr size_t kPageSize = 4096;
+  auto bytes = static_cast<const volatile char*>(data);
+  for (size_t i = 0; i < size; i += kPageSize) {
+    (void)bytes[i];
+  }
+}
+
+// Reads the records in the directory `prefix` of the archive, which are the
+// storages of the tensors in its pickle, keyed by their name in the
+// directory, and reads their pages from disk concurrently.
+//
+// The records are extracted one at a time, under the lock of the reader.
+// What runs concurrently is the page faults of the records that alias a
+// memory mapped archive.
+std::unordered_map<std::string, at::DataPtr> prefetchTensorRecords(
+    PyTorchStreamReader& stream_reader,
+    const std::string& prefix) {
+  std::vector<std::string> names;
+  for (auto& name : stream_reader.getAllRecords()) {
+    if (name.compare(0, prefix.size(), prefix) == 0) {
+      names.push_back(std::move(name));
+    }
+  }
+
+  std::vector<at::DataPtr> records(names.size());
+  std::vector<size_t> sizes(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    std::tie(records[i], sizes[i]) = stream_reader.getRecord(names[i]);
+  }
+  at::parallel_for(0, names.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      touchPages(records[i].get(), sizes[i]);
+    }
+  });
+
+  std::unordered_map<std::string, at::DataPtr> result;
+  result.reserve(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    result.emplace(names[i].substr(prefix.size()), std::move(records[i]));
+  }
+  return result;
+}
+
+} // namespace
+
+void setMmapTensorData(bool mmap) {
+  mmap_tensor_data = mmap;
+}
+
+bool getMmapTensorData() {
+  return mmap_tensor_data;
+}
+
+void setPrefetchTensorData(bool prefetch) {
+  prefetch_tensor_data = prefetch;
+}
+
+bool getPrefetchTensorData() {
+  return prefetch_tensor_data;
+}
+
+void setLazyTensorData(bool lazy) {
+  lazy_tensor_data = lazy;
+}
+
+bool getLazyTensorData() {
+  return lazy_tensor_data;
+}
+
 IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
@@ -68,28 +149,28 @@ IValue readArchiveAndTensors(
   size_t pickle_size;
   std::tie(pickle_ptr, pickle_size) = stream_reader.getRecord(picklename);
 
-  size_t bytes_read = 0;
-  auto data = reinterpret_cast<const char*>(pickle_ptr.get());
-  auto reader = [&](char* buffer, size_t len) -> size_t {
-    if (bytes_read >= pickle_size) {
-      return 0;
-    }
-    len = std::min(pickle_size - bytes_read, len);
-    // Copy len bytes into buffer
-    const char* start = data + bytes_read;
-    std::memcpy(buffer, start, len);
-    bytes_read += len;
-    return len;
-  };
-
   std::string archive_name_plus_slash = archive_name + "/";
+  // Otherwise each record is read when the unpickler references it, which
+  // in lazy mode doesn't touch the data of records that alias the archive.
+  std::unordered_map<std::string, at::DataPtr> records;
+  if (getPrefetchTensorData() && !getLazyTensorData()) {
+    records = prefetchTensorRecords(stream_reader, archive_name_plus_slash);
+  }
   auto read_record = [&](const std::string& name) {
+    auto it = records.find(name);
+    if (it != records.end()) {
+      auto data = std::move(it->second);
+      records.erase(it);
+      return data;
+    }
+    // Records that are referenced more than once are read again.
     std::string ss = archive_name_plus_slash + name;
     return std::get<0>(stream_reader.getRecord(ss));
   };
 
   Unpickler unpickler(
-      reader,
+      reinterpret_cast<const char*>(pickle_ptr.get()),
+      pickle_size,
       type_resolver ? std::move(*type_resolver) : nullptr,
       obj_loader ? std::move(*obj_loader) : nullptr,
       std::move(read_record),
@@ -100,6 +181,17 @@ IValue readArchiveAndTensors(
 
 namespace {
 
+// Tensor storages loaded through the returned adapter alias a memory mapping
+// of the file if that was asked for, and are copied otherwise. Truncating a
+// mapped file breaks the tensors that alias it, so this can't be the default.
+std::shared_ptr<ReadAdapterInterface> openFile(const std::string& filename) {
+  const bool lazy = getLazyTensorData();
+  if (!lazy && !getMmapTensorData()) {
+    return std::make_shared<FileAdapter>(filename);
+  }
+  return std::make_shared<MmapFileAdapter>(filename, /*random_access=*/lazy);
+}
+
 // This is a deserializer class which loads script modules from pt files.
 // Content of the file is written using PyTorchStreamWriter, for details please
 // check caffe2/serialize/inline_container.h.
@@ -303,7 +395,7 @@ Module import_ir_module(
     const std::string& filename,
     c10::optional<at::Device> device,
     ExtraFilesMap& extra_files) {
-  auto reader = torch::make_unique<PyTorchStreamReader>(filename);
+  auto reader = torch::make_unique<PyTorchStreamReader>(openFile(filename));
   ScriptModuleDeserializer deserializer(std::move(cu), std::move(reader));
   return deserializer.deserialize(device, extra_files);
 }
@@ -349,8 +441,7 @@ Module load(
     const std::string& filename,
     c10::optional<at::Device> device,
     ExtraFilesMap& extra_files) {
-  std::unique_ptr<FileAdapter> rai = std::make_unique<FileAdapter>(filename);
-  auto module = load(std::move(rai), device, extra_files);
+  auto module = load(openFile(filename), device, extra_files);
   return module;
 }
 
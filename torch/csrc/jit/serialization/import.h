@@ -89,6 +89,38 @@ TORCH_API Module load(
     c10::optional<c10::Device> device,
     ExtraFilesMap& extra_files);
 
+/// If set, `load` and `import_ir_module` from a file map the file into memory
+/// and return tensors whose storages alias the mapping instead of copies (see
+/// `caffe2::serialize::MmapFileAdapter`). Off by default, because the file
+/// must then not be overwritten while the tensors are alive, which rules out
+/// e.g. saving the loaded module back to the same path.
+TORCH_API void setMmapTensorData(bool mmap);
+TORCH_API bool getMmapTensorData();
+
+/// If set, the data of tensors that alias a memory mapped archive (see
+/// `caffe2::serialize::MmapFileAdapter`) is read from disk concurrently on
+/// the intra-op thread pool while loading, instead of on first access. Only
+/// useful together with `setMmapTensorData`. Off by default.
+TORCH_API void setPrefetchTensorData(bool prefetch);
+TORCH_API bool getPrefetchTensorData();
+
+/// If set, `load` and `import_ir_module` from a file return tensors whose
+/// storages alias a memory mapping of the file without reading any of their
+/// data. Each page is read from disk when it is first accessed, without read
+/// ahead, so memory grows with the parameters that are actually used. Takes
+/// precedence over `setPrefetchTensorData` and implies
+/// `setMmapTensorData`, with the same restriction on overwriting the file.
+/// Off by default.
+///
+/// Tensors are still read while loading if they are loaded from a stream or
+/// another adapter, if they are compressed in the archive or if they are
+/// mapped to a CUDA device.
+TORCH_API void setLazyTensorData(bool lazy);
+TORCH_API bool getLazyTensorData();
+
+/// Unpickles `archive_name`.pkl, reading its tensor records as they are
+/// referenced. If `getPrefetchTensorData()` is set, and `getLazyTensorData()`
+/// is not, the records are read and their pages prefetched beforehand.
 TORCH_API IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
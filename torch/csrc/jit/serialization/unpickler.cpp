@@ -729,12 +729,13 @@ void Unpickler::readSlowWithBuffer(char* dest, size_t sz) {
   AT_ASSERT(sz > buffer_remaining_);
   const size_t from_old_buf = buffer_remaining_;
   if (from_old_buf != 0) {
-    memcpy(dest, buffer_.data() + buffer_pos_, from_old_buf);
+    memcpy(dest, buffer_data_ + buffer_pos_, from_old_buf);
   }
   const size_t needed = sz - from_old_buf;
   // Full read into the buffer. The calls here all explicitly
   // assume that one buffer will be enough for any sz.
   AT_ASSERT(sz <= buffer_.size());
+  buffer_data_ = buffer_.data();
   buffer_remaining_ = reader_(buffer_.data(), buffer_.size());
   if (buffer_remaining_ < needed) {
     AT_ERROR("Unexpected end of pickler archive.");
@@ -750,7 +751,7 @@ std::string Unpickler::readBytes(size_t length) {
   static const size_t kSmallString = 64;
   if (length <= buffer_remaining_) {
     // Fast-path: entirely in buffer.
-    data.assign(buffer_.data() + buffer_pos_, length);
+    data.assign(buffer_data_ + buffer_pos_, length);
     buffer_pos_ += length;
     buffer_remaining_ -= length;
   } else if (length <= kSmallString) {
@@ -764,7 +765,7 @@ std::string Unpickler::readBytes(size_t length) {
     const size_t from_old_buf = buffer_remaining_;
     if (from_old_buf != 0) {
       data.reserve(length);
-      data.append(buffer_.data() + buffer_pos_, from_old_buf);
+      data.append(buffer_data_ + buffer_pos_, from_old_buf);
     }
     data.resize(length);
     const size_t needed = length - from_old_buf;
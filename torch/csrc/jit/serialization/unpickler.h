@@ -55,6 +55,36 @@ class TORCH_API Unpickler {
         use_storage_device_(use_storage_device),
         version_(caffe2::serialize::kProducedFileFormatVersion) {}
 
+  // The pickle is decoded from the `size` bytes at `data`, which must stay
+  // alive until parse_ivalue returns. Unlike a reader, this doesn't copy the
+  // pickle through the internal buffer.
+  Unpickler(
+      const char* data,
+      size_t size,
+      TypeResolver type_resolver,
+      const std::vector<at::Tensor>* tensor_table)
+      : Unpickler(endOfInput, std::move(type_resolver), tensor_table) {
+    setInputBuffer(data, size);
+  }
+
+  Unpickler(
+      const char* data,
+      size_t size,
+      TypeResolver type_resolver,
+      ObjLoader obj_loader,
+      std::function<at::DataPtr(const std::string&)> read_record,
+      c10::optional<at::Device> device,
+      bool use_storage_device = false)
+      : Unpickler(
+            endOfInput,
+            std::move(type_resolver),
+            std::move(obj_loader),
+            std::move(read_record),
+            std::move(device),
+            use_storage_device) {
+    setInputBuffer(data, size);
+  }
+
   // consume the pickle stream, producing an IValue from the contents.
   // Type Tags: the pickler will restore the type tags on
   // List and Dict objects when possible IValue is an Object.
@@ -83,7 +113,7 @@ class TORCH_API Unpickler {
     T item;
     if (sizeof(T) <= buffer_remaining_) {
       // Fast path: entirely from buffer.
-      memcpy(&item, buffer_.data() + buffer_pos_, sizeof(T));
+      memcpy(&item, buffer_data_ + buffer_pos_, sizeof(T));
       buffer_remaining_ -= sizeof(T);
       buffer_pos_ += sizeof(T);
     } else {
@@ -93,6 +123,15 @@ class TORCH_API Unpickler {
     return item;
   }
   void readSlowWithBuffer(char* dest, size_t sz);
+  void setInputBuffer(const char* data, size_t size) {
+    buffer_data_ = data;
+    buffer_pos_ = 0;
+    buffer_remaining_ = size;
+  }
+  // Reader of an input that is entirely in the buffer.
+  static size_t endOfInput(char* /* buffer */, size_t /* size */) {
+    return 0;
+  }
   std::string readBytes(size_t num_bytes);
 
   double readFloat();
@@ -117,6 +156,9 @@ class TORCH_API Unpickler {
   std::function<size_t(char*, size_t)> reader_;
   // Small buffer to avoid calling reader_ on a per-byte basis.
   std::array<char, 256> buffer_;
+  // Data of the buffer, which is either buffer_ or the whole input if it is
+  // in memory.
+  const char* buffer_data_{buffer_.data()};
   size_t buffer_pos_{0};
   size_t buffer_remaining_{0};
 
@@ -108,6 +108,12 @@ class WritesToBuf : public IRVisitor {
     }
   }
 
+  void visit(const ExternalCall* v) override {
+    if (v->buf() == target_) {
+      writes_.push_back(v);
+    }
+  }
+
   const Buf* target_;
   std::vector<const Stmt*> writes_;
 };
@@ -0,0 +1,425 @@
+#include <torch/csrc/jit/tensorexpr/auto_schedule.h>
+
+#include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
+#include <torch/csrc/jit/tensorexpr/var_substitutor.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+namespace {
+
+// Tile sizes tried for each of the two innermost loops.
+constexpr int kTileSizes[] = {8, 16, 32, 64, 128};
+
+// Relative cost of bringing a cache line into L1 from L2, and into L2 from
+// memory, in units of one scalar loop iteration.
+constexpr double kL2LineCost = 4;
+constexpr double kMemoryLineCost = 20;
+
+// A candidate has to be predicted this much cheaper than the default schedule
+// to be preferred over it, since the model is only a rough estimate.
+constexpr double kMinImprovement = 0.05;
+
+constexpr int64_t kUnknownStride = std::numeric_limits<int64_t>::min();
+
+// Returns how much `index` changes when loop variable `vars[loop]` is
+// incremented and the other loop variables are held at zero, or
+// kUnknownStride if `index` is not an affine function of the loop variables.
+int64_t indexStride(
+    const Expr* index,
+    const std::vector<const Var*>& vars,
+    size_t loop) {
+  auto evaluateAt = [&](int value) -> const Expr* {
+    VarMapping mapping;
+    for (size_t i = 0; i < vars.size(); i++) {
+      mapping.emplace_back(vars[i], new IntImm(i == loop ? value : 0));
+    }
+    VarSubMutator subs(mapping);
+    return IRSimplifier::simplify(index->accept_mutator(&subs));
+  };
+  const Expr* e0 = evaluateAt(0);
+  const Expr* e1 = evaluateAt(1);
+  const Expr* e2 = evaluateAt(2);
+  if (!e0->isConstant() || !e1->isConstant() || !e2->isConstant()) {
+    return kUnknownStride;
+  }
+  int64_t stride = immediateAs<int64_t>(e1) - immediateAs<int64_t>(e0);
+  if (immediateAs<int64_t>(e2) - immediateAs<int64_t>(e1) != stride) {
+    return kUnknownStride;
+  }
+  return stride;
+}
+
+const ReduceOp* reduceOpFor(const LoopNest& l, Tensor* t) {
+  const Store* store = dynamic_cast<const Store*>(l.getLoopBodyFor(t));
+  return store ? dynamic_cast<const ReduceOp*>(store->value()) : nullptr;
+}
+
+} // namespace
+
+// A loop of a transformed nest, running `trips` iterations that each advance
+// loop `loop` of the original nest by `scale`.
+struct AutoScheduler::Level {
+  size_t loop;
+  int64_t trips;
+  int64_t scale;
+};
+
+// The loops computing a tensor, outermost first, and the byte strides of the
+// loads and stores of their body along each loop.
+struct AutoScheduler::Nest {
+  struct Access {
+    int64_t elementBytes;
+    std::vector<int64_t> strides;
+  };
+
+  std::vector<const Var*> vars;
+  std::vector<int64_t> trips;
+  std::vector<Access> accesses;
+  // Loops not iterating over a reduction axis, which come first.
+  size_t numOutputLoops{0};
+  bool reduction{false};
+  // Whether the two innermost loops are perfectly nested.
+  bool tileable{false};
+};
+
+AutoScheduler::AutoScheduler(CacheInfo cache, int vectorWidth)
+    : cache_(cache), vectorWidth_(vectorWidth) {}
+
+bool AutoScheduler::analyze(const LoopNest& l, Tensor* t, Nest* nest) const {
+  const Store* store = dynamic_cast<const Store*>(l.getLoopBodyFor(t));
+  if (!store) {
+    return false;
+  }
+  std::vector<For*> loops = l.getLoopStmtsFor(t);
+  if (loops.empty()) {
+    return false;
+  }
+
+  std::unordered_set<const Var*> reduceVars;
+  if (const ReduceOp* reduceOp = reduceOpFor(l, t)) {
+    nest->reduction = true;
+    reduceVars.insert(
+        reduceOp->reduce_args().begin(), reduceOp->reduce_args().end());
+  }
+  for (For* f : loops) {
+    const Expr* trips =
+        IRSimplifier::simplify(new Sub(f->stop(), f->start()));
+    if (!trips->isConstant() || immediateAs<int64_t>(trips) <= 0) {
+      return false;
+    }
+    if (!reduceVars.count(f->var())) {
+      if (nest->numOutputLoops != nest->vars.size()) {
+        return false;
+      }
+      nest->numOutputLoops++;
+    }
+    nest->vars.push_back(f->var());
+    nest->trips.push_back(immediateAs<int64_t>(trips));
+  }
+  if (nest->reduction && nest->numOutputLoops == loops.size()) {
+    return false;
+  }
+  size_t n = loops.size();
+  nest->tileable = !nest->reduction && n >= 2 &&
+      loops[n - 2]->body()->nstmts() == 1 &&
+      loops[n - 2]->body()->front() == loops[n - 1];
+
+  auto addAccess = [&](const Buf* buf, const std::vector<const Expr*>& idx) {
+    Nest::Access access;
+    access.elementBytes = buf->dtype().byte_size();
+    const Expr* index = flatten_index(buf->dims(), idx);
+    for (size_t i = 0; i < n; i++) {
+      int64_t stride = indexStride(index, nest->vars, i);
+      access.strides.push_back(
+          stride == kUnknownStride ? stride : stride * access.elementBytes);
+    }
+    nest->accesses.push_back(std::move(access));
+  };
+  addAccess(store->buf(), store->indices());
+  for (const Load* load : NodeFinder<Load>::find(store->value())) {
+    addAccess(load->buf(), load->indices());
+  }
+  for (const FunctionCall* call :
+       NodeFinder<FunctionCall>::find(store->value())) {
+    addAccess(call->tensor()->buf(), call->params());
+  }
+  return true;
+}
+
+// Estimates the number of distinct cache lines touched by an access during
+// one execution of levels [from, end). Strides up to a cache line extend a
+// contiguous range, larger ones multiply the number of disjoint ranges.
+double AutoScheduler::lines(
+    const Nest& nest,
+    size_t access,
+    const std::vector<Level>& levels,
+    size_t from) const {
+  const Nest::Access& a = nest.accesses[access];
+  std::vector<std::pair<int64_t, int64_t>> dims;
+  double ranges = 1;
+  for (size_t i = from; i < levels.size(); i++) {
+    const Level& level = levels[i];
+    int64_t stride = a.strides[level.loop];
+    if (stride == kUnknownStride) {
+      ranges *= level.trips;
+      continue;
+    }
+    stride = std::abs(stride) * level.scale;
+    if (stride != 0 && level.trips > 1) {
+      dims.emplace_back(stride, level.trips);
+    }
+  }
+  std::sort(dims.begin(), dims.end());
+  int64_t extent = a.elementBytes;
+  for (const auto& dim : dims) {
+    if (dim.first <= std::max(extent, cache_.lineBytes)) {
+      extent += dim.first * (dim.second - 1);
+    } else {
+      ranges *= dim.second;
+    }
+  }
+  return ranges * ((extent + cache_.lineBytes - 1) / cache_.lineBytes);
+}
+
+// Estimates the number of cache lines loaded into a cache of `capacity`
+// bytes. Data is assumed to stay cached across iterations of the outermost
+// level whose body fits in the cache, and to be reloaded by every iteration
+// of the levels outside of it.
+double AutoScheduler::traffic(
+    const Nest& nest,
+    const std::vector<Level>& levels,
+    int64_t capacity) const {
+  auto totalLines = [&](size_t from) {
+    double total = 0;
+    for (size_t a = 0; a < nest.accesses.size(); a++) {
+      total += lines(nest, a, levels, from);
+    }
+    return total;
+  };
+  size_t fits = levels.size();
+  for (size_t from = 0; from < levels.size(); from++) {
+    if (totalLines(from) * cache_.lineBytes <= capacity) {
+      fits = from;
+      break;
+    }
+  }
+  size_t from = fits == 0 ? 0 : fits - 1;
+  double reloads = 1;
+  for (size_t i = 0; i < from; i++) {
+    reloads *= levels[i].trips;
+  }
+  return reloads * totalLines(from);
+}
+
+double AutoScheduler::cost(
+    const Nest& nest,
+    const std::vector<Level>& levels,
+    bool vectorized,
+    double extraIterations) const {
+  double iterations = 1;
+  for (const Level& level : levels) {
+    iterations *= level.trips;
+  }
+  double compute = vectorized ? iterations / vectorWidth_ : iterations;
+  return kL2LineCost * traffic(nest, levels, cache_.l1Bytes) +
+      kMemoryLineCost * traffic(nest, levels, cache_.l2Bytes) + compute +
+      extraIterations;
+}
+
+// Whether every access is either invariant or contiguous along `loop`.
+bool AutoScheduler::vectorizable(const Nest& nest, size_t loop) const {
+  for (const Nest::Access& a : nest.accesses) {
+    if (a.strides[loop] != 0 && a.strides[loop] != a.elementBytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<ScheduleCandidate> AutoScheduler::candidates(
+    const LoopNest& l,
+    Tensor* t) const {
+  Nest nest;
+  if (!analyze(l, t, &nest)) {
+    return {};
+  }
+  const size_t n = nest.trips.size();
+  const int64_t width = vectorWidth_;
+  std::vector<Level> identity;
+  for (size_t i = 0; i < n; i++) {
+    identity.push_back({i, nest.trips[i], 1});
+  }
+
+  std::vector<ScheduleCandidate> result;
+  ScheduleCandidate def;
+  // Elementwise loops are vectorized by LoopNest::vectorizeInnerLoops.
+  def.cost = cost(
+      nest,
+      identity,
+      !nest.reduction && nest.trips[n - 1] >= width &&
+          vectorizable(nest, n - 1),
+      0);
+  result.push_back(def);
+
+  if (nest.tileable) {
+    const int64_t ni = nest.trips[n - 2];
+    const int64_t nj = nest.trips[n - 1];
+    for (int ti : kTileSizes) {
+      for (int tj : kTileSizes) {
+        if (ti >= ni || ni % ti != 0 || tj >= nj || nj % tj != 0) {
+          continue;
+        }
+        std::vector<Level> levels(identity.begin(), identity.end() - 2);
+        levels.push_back({n - 2, ni / ti, ti});
+        levels.push_back({n - 1, nj / tj, tj});
+        levels.push_back({n - 2, ti, 1});
+        levels.push_back({n - 1, tj, 1});
+        ScheduleCandidate c;
+        c.kind = ScheduleCandidate::kTile;
+        c.tileSizes = {ti, tj};
+        c.cost = cost(
+            nest, levels, tj >= width && vectorizable(nest, n - 1), 0);
+        result.push_back(c);
+      }
+    }
+  }
+
+  if (nest.reduction) {
+    double outputs = 1;
+    double reductions = 1;
+    for (size_t i = 0; i < n; i++) {
+      (i < nest.numOutputLoops ? outputs : reductions) *= nest.trips[i];
+    }
+    // The tail of a split reduction loop cannot be rfactored, so only loops
+    // that are a multiple of the vector width are considered.
+    const int64_t nr = nest.trips[n - 1];
+    if (nr > width && nr % width == 0 && vectorizable(nest, n - 1)) {
+      std::vector<Level> levels(identity.begin(), identity.end() - 1);
+      levels.push_back({n - 1, nr / width, width});
+      levels.push_back({n - 1, width, 1});
+      ScheduleCandidate c;
+      c.kind = ScheduleCandidate::kRfactorVectorize;
+      c.cost = cost(nest, levels, true, outputs * width);
+      result.push_back(c);
+    }
+
+    if (nest.numOutputLoops > 0) {
+      const size_t o = nest.numOutputLoops - 1;
+      const int64_t no = nest.trips[o];
+      if (no >= width && vectorizable(nest, o)) {
+        std::vector<Level> levels(identity.begin(), identity.begin() + o);
+        levels.push_back({o, no / width, width});
+        levels.insert(levels.end(), identity.begin() + o + 1, identity.end());
+        levels.push_back({o, width, 1});
+        ScheduleCandidate c;
+        c.kind = ScheduleCandidate::kVectorizeOutput;
+        // The tail of the output loop stays scalar.
+        c.cost = cost(
+            nest, levels, true, (no % width) * outputs / no * reductions);
+        result.push_back(c);
+      }
+    }
+  }
+
+  std::stable_sort(
+      result.begin(),
+      result.end(),
+      [](const ScheduleCandidate& a, const ScheduleCandidate& b) {
+        return a.cost < b.cost;
+      });
+  if (result[0].cost > def.cost * (1 - kMinImprovement)) {
+    auto it = std::find_if(
+        result.begin(), result.end(), [](const ScheduleCandidate& c) {
+          return c.kind == ScheduleCandidate::kDefault;
+        });
+    std::rotate(result.begin(), it, it + 1);
+  }
+  return result;
+}
+
+void AutoScheduler::apply(
+    LoopNest& l,
+    Tensor* t,
+    const ScheduleCandidate& c) const {
+  For* outer = nullptr;
+  For* inner = nullptr;
+  For* tail = nullptr;
+  switch (c.kind) {
+    case ScheduleCandidate::kDefault:
+      return;
+
+    case ScheduleCandidate::kTile: {
+      TORCH_INTERNAL_ASSERT(c.tileSizes.size() == 2);
+      std::vector<For*> loops = l.getLoopStmtsFor(t);
+      TORCH_INTERNAL_ASSERT(loops.size() >= 2);
+      LoopNest::splitWithTail(
+          loops[loops.size() - 2], c.tileSizes[0], &outer, &inner, &tail);
+      loops = l.getLoopStmtsFor(t);
+      LoopNest::splitWithTail(
+          loops.back(), c.tileSizes[1], &outer, &inner, &tail);
+      // i_outer, i_inner, j_outer, j_inner -> i_outer, j_outer, i_inner,
+      // j_inner
+      loops = l.getLoopStmtsFor(t);
+      size_t n = loops.size();
+      l.reorderAxis(loops[n - 3], loops[n - 2]);
+      return;
+    }
+
+    case ScheduleCandidate::kRfactorVectorize: {
+      std::vector<For*> loops = l.getLoopStmtsFor(t);
+      LoopNest::splitWithTail(
+          loops.back(), vectorWidth_, &outer, &inner, &tail);
+      std::vector<ReduceOp*> reduces = NodeFinder<ReduceOp>::find(inner);
+      TORCH_INTERNAL_ASSERT(reduces.size() == 1);
+      const Var* v = inner->var();
+      l.rfactor(reduces[0], v);
+      // The loops over `v` that no longer reduce over it compute the vector
+      // of partial sums.
+      for (For* f : NodeFinder<For>::find(l.root_stmt())) {
+        if (f->var() != v) {
+          continue;
+        }
+        bool reducesOverV = false;
+        for (ReduceOp* r : NodeFinder<ReduceOp>::find(f)) {
+          const auto& args = r->reduce_args();
+          if (std::find(args.begin(), args.end(), v) != args.end()) {
+            reducesOverV = true;
+          }
+        }
+        if (!reducesOverV) {
+          LoopNest::vectorize(f);
+        }
+      }
+      return;
+    }
+
+    case ScheduleCandidate::kVectorizeOutput: {
+      const ReduceOp* reduceOp = reduceOpFor(l, t);
+      TORCH_INTERNAL_ASSERT(reduceOp);
+      const auto& args = reduceOp->reduce_args();
+      std::vector<For*> loops = l.getLoopStmtsFor(t);
+      For* o = nullptr;
+      for (For* f : loops) {
+        if (std::find(args.begin(), args.end(), f->var()) == args.end()) {
+          o = f;
+        }
+      }
+      TORCH_INTERNAL_ASSERT(o);
+      LoopNest::splitWithTail(o, vectorWidth_, &outer, &inner, &tail);
+      LoopNest::vectorize(inner);
+      return;
+    }
+  }
+}
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
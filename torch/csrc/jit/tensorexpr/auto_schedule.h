@@ -0,0 +1,99 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/tensorexpr/loopnest.h>
+#include <torch/csrc/jit/tensorexpr/tensor.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+// Cache parameters used by the AutoScheduler cost model. The defaults match
+// common x86 CPUs.
+struct CacheInfo {
+  int64_t lineBytes = 64;
+  int64_t l1Bytes = 32 * 1024;
+  int64_t l2Bytes = 1024 * 1024;
+};
+
+// A transformation of the loop nest computing one tensor, along with the cost
+// the model predicts for it.
+struct ScheduleCandidate {
+  enum Kind {
+    // Leave the loops as they are.
+    kDefault,
+    // Tile the two innermost loops by tileSizes[0] x tileSizes[1].
+    kTile,
+    // Split the innermost reduction loop by the vector width and rfactor the
+    // inner loop, which then accumulates a vector of partial sums.
+    kRfactorVectorize,
+    // Split the innermost output loop of a reduction by the vector width and
+    // vectorize the inner loop, which reduces several outputs at once.
+    kVectorizeOutput,
+  };
+
+  Kind kind{kDefault};
+  std::vector<int> tileSizes;
+  double cost{0};
+};
+
+/* The AutoScheduler picks loop transformations for the nests of a LoopNest
+with static shapes. For every output tensor it enumerates candidate schedules,
+estimates the cache traffic of each one from the strides of the loads and
+stores in the loop body and orders them by the estimated cost:
+
+  - elementwise nests can have their two innermost loops tiled, which helps
+    when one of the operands is accessed with a large stride (e.g. a
+    transpose);
+  - reductions over a contiguous axis can be rfactored so the partial sums are
+    computed with vector instructions;
+  - reductions over a strided axis can be vectorized along the output axis.
+
+The default schedule is kept unless a candidate is predicted to be clearly
+cheaper. Vectorization of elementwise loops is left to
+LoopNest::vectorizeInnerLoops. */
+class TORCH_API AutoScheduler {
+ public:
+  explicit AutoScheduler(CacheInfo cache = CacheInfo(), int vectorWidth = 8);
+
+  // Returns the schedules for the loops computing `t` in `l`, cheapest first.
+  // The result always contains the kDefault schedule, unless the loops could
+  // not be analyzed (e.g. because their bounds are not constant), in which
+  // case it is empty.
+  std::vector<ScheduleCandidate> candidates(const LoopNest& l, Tensor* t) const;
+
+  // Transforms the loops computing `t` in `l` according to `c`, which must be
+  // one of the candidates returned for them.
+  void apply(LoopNest& l, Tensor* t, const ScheduleCandidate& c) const;
+
+ private:
+  struct Level;
+  struct Nest;
+
+  bool analyze(const LoopNest& l, Tensor* t, Nest* nest) const;
+  double lines(
+      const Nest& nest,
+      size_t access,
+      const std::vector<Level>& levels,
+      size_t from) const;
+  double traffic(
+      const Nest& nest,
+      const std::vector<Level>& levels,
+      int64_t capacity) const;
+  double cost(
+      const Nest& nest,
+      const std::vector<Level>& levels,
+      bool vectorized,
+      double extraIterations) const;
+  bool vectorizable(const Nest& nest, size_t loop) const;
+
+  CacheInfo cache_;
+  int vectorWidth_;
+};
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
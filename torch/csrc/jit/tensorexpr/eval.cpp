@@ -1,5 +1,7 @@
 #include <torch/csrc/jit/tensorexpr/eval.h>
 
+#include <torch/csrc/jit/tensorexpr/external_functions.h>
+
 namespace torch {
 namespace jit {
 namespace tensorexpr {
@@ -67,6 +69,14 @@ class SimpleIREvaluatorImpl : public IRVisitor {
     return value_;
   }
 
+  int64_t evaluateIntExpr(const Expr* e) {
+    Value val = evaluateExpr(e);
+    if (val.dtype() == kLong) {
+      return val.as<int64_t>();
+    }
+    return val.as<int>();
+  }
+
   Value value() const {
     return value_;
   }
@@ -770,6 +780,48 @@ class SimpleIREvaluatorImpl : public IRVisitor {
     buffer_mapping_.erase(buffer_var);
   }
 
+  void visit(const ExternalCall* v) override {
+    auto& func_registry = getNNCFunctionRegistry();
+    if (!func_registry.count(v->func_name())) {
+      throw unimplemented_lowering(v);
+    }
+
+    std::vector<const Buf*> bufs(v->buf_args());
+    bufs.insert(bufs.begin(), v->buf());
+
+    std::vector<void*> buf_ptrs;
+    std::vector<int64_t> buf_ranks;
+    std::vector<int64_t> buf_dims;
+    std::vector<int8_t> buf_dtypes;
+    std::vector<int64_t> extra_args;
+
+    for (const Buf* b : bufs) {
+      auto iter = buffer_mapping_.find(b->base_handle());
+      if (iter == buffer_mapping_.end()) {
+        throw malformed_input("could not find base node in ExternalCall");
+      }
+      buf_ptrs.push_back(iter->second);
+      buf_ranks.push_back(b->dims().size());
+      buf_dtypes.push_back((int8_t)b->dtype().scalar_type());
+      for (const Expr* dim_expr : b->dims()) {
+        buf_dims.push_back(evaluateIntExpr(dim_expr));
+      }
+    }
+    for (const Expr* a : v->args()) {
+      extra_args.push_back(evaluateIntExpr(a));
+    }
+
+    auto fn_ptr = func_registry.at(v->func_name());
+    (*fn_ptr)(
+        bufs.size(),
+        buf_ptrs.data(),
+        buf_ranks.data(),
+        buf_dims.data(),
+        buf_dtypes.data(),
+        extra_args.size(),
+        extra_args.data());
+  }
+
   void visit(const Let* v) override {
     var_by_scope_[scope_].push_back(v->var());
     bindVar(v->var(), evaluateExpr(v->value()));
@@ -0,0 +1,131 @@
+#include <torch/csrc/jit/tensorexpr/external_functions.h>
+
+#include <ATen/ATen.h>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+std::unordered_map<std::string, NNCExternalFunction>& getNNCFunctionRegistry() {
+  static std::unordered_map<std::string, NNCExternalFunction> func_registry;
+  return func_registry;
+}
+
+namespace {
+
+std::vector<at::Tensor> constructTensors(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes) {
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(bufs_num);
+  int64_t buf_dims_idx = 0;
+  for (int64_t i = 0; i < bufs_num; i++) {
+    std::vector<int64_t> sizes(
+        buf_dims + buf_dims_idx, buf_dims + buf_dims_idx + buf_ranks[i]);
+    buf_dims_idx += buf_ranks[i];
+    tensors.emplace_back(at::from_blob(
+        buf_data[i],
+        sizes,
+        at::TensorOptions(static_cast<c10::ScalarType>(buf_dtypes[i]))));
+  }
+  return tensors;
+}
+
+// The kernels below are called from generated code, which cannot propagate
+// exceptions. The fuser only hands over inputs whose shapes and dtypes were
+// checked when the kernel was compiled, so the ATen calls are not expected
+// to throw.
+
+void nnc_aten_matmul(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  auto tensors =
+      constructTensors(bufs_num, buf_data, buf_ranks, buf_dims, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  at::matmul_out(r, tensors[1], tensors[2]);
+}
+
+// Only beta == alpha == 1 is lowered.
+void nnc_aten_addmm(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  auto tensors =
+      constructTensors(bufs_num, buf_data, buf_ranks, buf_dims, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  at::addmm_out(r, tensors[1], tensors[2], tensors[3]);
+}
+
+// Buffers: output, input, weight and an optional bias.
+void nnc_aten_linear(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  auto tensors =
+      constructTensors(bufs_num, buf_data, buf_ranks, buf_dims, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  const at::Tensor& x = tensors[1];
+  const at::Tensor& w = tensors[2];
+  if (bufs_num > 3 && x.dim() == 2) {
+    at::addmm_out(r, tensors[3], x, w.t());
+    return;
+  }
+  at::matmul_out(r, x, w.t());
+  if (bufs_num > 3) {
+    r.add_(tensors[3]);
+  }
+}
+
+// Buffers: output, input, weight and an optional bias. extra_args are
+// stride, padding and dilation (two values each) followed by groups.
+void nnc_aten_conv2d(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  auto tensors =
+      constructTensors(bufs_num, buf_data, buf_ranks, buf_dims, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  at::Tensor bias = bufs_num > 3 ? tensors[3] : at::Tensor();
+  TORCH_INTERNAL_ASSERT(args_num == 7);
+  // There is no out variant of conv2d, so the result is copied into the
+  // output buffer.
+  r.copy_(at::conv2d(
+      tensors[1],
+      tensors[2],
+      bias,
+      {extra_args[0], extra_args[1]},
+      {extra_args[2], extra_args[3]},
+      {extra_args[4], extra_args[5]},
+      extra_args[6]));
+}
+
+RegisterNNCExternalFunction nnc_matmul("nnc_aten_matmul", nnc_aten_matmul);
+RegisterNNCExternalFunction nnc_addmm("nnc_aten_addmm", nnc_aten_addmm);
+RegisterNNCExternalFunction nnc_linear("nnc_aten_linear", nnc_aten_linear);
+RegisterNNCExternalFunction nnc_conv2d("nnc_aten_conv2d", nnc_aten_conv2d);
+
+} // namespace
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
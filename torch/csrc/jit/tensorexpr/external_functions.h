@@ -0,0 +1,41 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+// Functions that ExternalCall statements invoke by name, e.g. to run a GEMM
+// or a convolution with the ATen kernels inside a fused TE kernel.
+//
+// Buffer 0 is the output and buffers 1..bufs_num-1 are the inputs. The sizes
+// of all the buffers are concatenated in buf_dims, buf_ranks says how many of
+// them belong to each buffer, and buf_dtypes holds their c10::ScalarTypes.
+// All buffers are contiguous. extra_args are the integer arguments of the
+// ExternalCall.
+using NNCExternalFunction = void (*)(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args);
+
+TORCH_API std::unordered_map<std::string, NNCExternalFunction>&
+getNNCFunctionRegistry();
+
+struct RegisterNNCExternalFunction {
+  RegisterNNCExternalFunction(const std::string& name, NNCExternalFunction fn) {
+    getNNCFunctionRegistry()[name] = fn;
+  }
+};
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -144,6 +144,20 @@ Store* Store::make(
       ExprHandle(1).node());
 }
 
+ExternalCall* ExternalCall::make(
+    BufHandle buf,
+    const std::string& func_name,
+    const std::vector<BufHandle>& buf_args,
+    const std::vector<ExprHandle>& args) {
+  std::vector<const Buf*> buf_arg_nodes;
+  buf_arg_nodes.reserve(buf_args.size());
+  for (const BufHandle& buf_arg : buf_args) {
+    buf_arg_nodes.push_back(buf_arg.node());
+  }
+  return new ExternalCall(
+      buf.node(), func_name, buf_arg_nodes, ExprHandleVectorToExprVector(args));
+}
+
 const Expr* flatten_index(
     const std::vector<const Expr*>& dims,
     const std::vector<const Expr*>& indices) {
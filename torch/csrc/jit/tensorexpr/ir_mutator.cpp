@@ -450,6 +450,32 @@ Stmt* IRMutator::mutate(const Let* v) {
   return new Let(var_new, val_new);
 }
 
+Stmt* IRMutator::mutate(const ExternalCall* v) {
+  const Buf* buf = v->buf();
+  const Buf* buf_new = dynamic_cast<const Buf*>(buf->accept_mutator(this));
+  bool any_change = buf_new != buf;
+
+  std::vector<const Buf*> buf_args_new;
+  for (const Buf* buf_arg : v->buf_args()) {
+    const Buf* buf_arg_new =
+        dynamic_cast<const Buf*>(buf_arg->accept_mutator(this));
+    any_change |= buf_arg_new != buf_arg;
+    buf_args_new.push_back(buf_arg_new);
+  }
+
+  std::vector<const Expr*> args_new;
+  for (const Expr* arg : v->args()) {
+    const Expr* arg_new = arg->accept_mutator(this);
+    any_change |= arg_new != arg;
+    args_new.push_back(arg_new);
+  }
+
+  if (!any_change) {
+    return (Stmt*)v;
+  }
+  return new ExternalCall(buf_new, v->func_name(), buf_args_new, args_new);
+}
+
 Stmt* IRMutator::mutate(const Cond* v) {
   const Expr* cond_old = v->condition();
   Stmt* true_old = v->true_stmt();
@@ -489,6 +515,7 @@ class StmtClone : public IRMutator {
   Stmt* mutate(const Let* v) override;
   Stmt* mutate(const Cond* v) override;
   Stmt* mutate(const AtomicAdd* v) override;
+  Stmt* mutate(const ExternalCall* v) override;
 };
 
 Stmt* StmtClone::mutate(const For* v) {
@@ -526,6 +553,10 @@ Stmt* StmtClone::mutate(const Let* v) {
   return new Let(v->var(), v->value());
 }
 
+Stmt* StmtClone::mutate(const ExternalCall* v) {
+  return new ExternalCall(v->buf(), v->func_name(), v->buf_args(), v->args());
+}
+
 Stmt* StmtClone::mutate(const Cond* v) {
   Stmt* true_old = v->true_stmt();
   Stmt* false_old = v->false_stmt();
@@ -44,6 +44,7 @@ class FunctionCall;
 class Allocate;
 class Free;
 class Let;
+class ExternalCall;
 class Cond;
 class Stmt;
 class Term;
@@ -111,6 +112,7 @@ class TORCH_API IRMutator {
   virtual Stmt* mutate(const Allocate* v);
   virtual Stmt* mutate(const Free* v);
   virtual Stmt* mutate(const Let* v);
+  virtual Stmt* mutate(const ExternalCall* v);
   virtual Stmt* mutate(const Cond* v);
 
  protected:
@@ -464,6 +464,30 @@ void IRPrinter::visit(const Let* v) {
   os() << "; " << std::endl;
 }
 
+void IRPrinter::visit(const ExternalCall* v) {
+  emitIndent();
+  os() << *v->buf()->base_handle() << " = " << v->func_name() << "(";
+
+  os() << "buf_args={";
+  int i = 0;
+  for (const Buf* buf_arg : v->buf_args()) {
+    if (i++ > 0) {
+      os() << ", ";
+    }
+    os() << *buf_arg->base_handle();
+  }
+
+  os() << "}, args={";
+  i = 0;
+  for (const Expr* arg : v->args()) {
+    if (i++ > 0) {
+      os() << ", ";
+    }
+    os() << *arg;
+  }
+  os() << "});" << std::endl;
+}
+
 void IRPrinter::visit(const Cond* v) {
   const Expr* cond = v->condition();
   Stmt* true_stmt = v->true_stmt();
@@ -178,6 +178,16 @@ void IRVisitor::visit(const Let* v) {
   v->value()->accept(this);
 }
 
+void IRVisitor::visit(const ExternalCall* v) {
+  v->buf()->accept(this);
+  for (const Buf* buf_arg : v->buf_args()) {
+    buf_arg->accept(this);
+  }
+  for (const Expr* arg : v->args()) {
+    arg->accept(this);
+  }
+}
+
 void IRVisitor::visit(const Cond* v) {
   const Expr* condition = v->condition();
   Stmt* true_stmt = v->true_stmt();
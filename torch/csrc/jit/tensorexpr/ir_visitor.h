@@ -42,6 +42,7 @@ class FunctionCall;
 class Allocate;
 class Free;
 class Let;
+class ExternalCall;
 class Cond;
 class Term;
 class Polynomial;
@@ -98,6 +99,7 @@ class TORCH_API IRVisitor {
   virtual void visit(const Allocate* v);
   virtual void visit(const Free* v);
   virtual void visit(const Let* v);
+  virtual void visit(const ExternalCall* v);
   virtual void visit(const Cond* v);
   virtual void visit(const Term* v);
   virtual void visit(const Polynomial* v);
@@ -1,15 +1,20 @@
 #include <torch/csrc/jit/tensorexpr/kernel.h>
 
 #include <ATen/ExpandUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/TensorGeometry.h>
 #include <c10/util/string_utils.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/auto_schedule.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
 
+#include <chrono>
+#include <limits>
+
 using namespace torch::jit;
 using namespace torch::jit::tensorexpr;
 
@@ -23,6 +28,8 @@ static int te_cuda_pointwise_block_size = -1;
 static bool fallback_allowed = false;
 static bool te_generate_block_code = false;
 static bool te_must_use_llvm_on_cpu = false;
+static int64_t te_cpu_parallel_min_elements = at::internal::GRAIN_SIZE;
+static int te_auto_schedule_mode = 0;
 
 bool setFallbackAllowed(bool value) {
   bool old_value = fallback_allowed;
@@ -87,6 +94,14 @@ bool& getTEMustUseLLVMOnCPU() {
   return te_must_use_llvm_on_cpu;
 }
 
+int64_t& getTECPUParallelMinElements() {
+  return te_cpu_parallel_min_elements;
+}
+
+int& getTEAutoScheduleMode() {
+  return te_auto_schedule_mode;
+}
+
 c10::optional<at::Device> pickDeviceType(
     const at::ArrayRef<torch::jit::Value*>& inputs) {
   c10::optional<at::Device> device = c10::nullopt;
@@ -520,7 +535,7 @@ ExprHandle TensorExprKernel::demoteOutput(
     return e;
   }
 
-  if (!v->isCompleteTensor()) {
+  if (!v->type()->cast<TensorType>()->scalarType()) {
     return e;
   }
 
@@ -1511,13 +1526,81 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
       return computeSoftmax(v, true);
     }
 
+    case aten::matmul:
+    case aten::addmm:
+    case aten::linear:
+    case aten::conv2d: {
+      return computeExternalCall(v);
+    }
+
     default: {
       throw std::runtime_error("Unhandled node kind");
     }
   }
 }
 
-Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
+// Number of consecutive elements computed by one iteration of a parallel
+// loop when the outermost loop has to be split to get enough of them.
+static constexpr int kParallelChunkSize = 1024;
+
+static const Expr* constantTripCount(const For* f) {
+  const Expr* trips = IRSimplifier::simplify(new Sub(f->stop(), f->start()));
+  return trips->isConstant() ? trips : nullptr;
+}
+
+// Runs the outermost loop of the large outputs on the intra-op thread pool.
+// An outermost loop with too little work per iteration is first flattened
+// with the loops it contains and split into chunks of kParallelChunkSize,
+// unless the loops were transformed by the AutoScheduler.
+static void parallelizeOuterLoops(
+    LoopNest& l,
+    const std::vector<Tensor*>& tensors,
+    const std::unordered_set<Tensor*>& scheduled) {
+  const int64_t minElements = getTECPUParallelMinElements();
+  if (minElements <= 0) {
+    return;
+  }
+  for (auto tensor : tensors) {
+    int64_t numel = 1;
+    bool staticShape = true;
+    for (const Expr* dim : tensor->buf()->dims()) {
+      const Expr* d = IRSimplifier::simplify(dim);
+      if (!d->isConstant()) {
+        staticShape = false;
+        break;
+      }
+      numel *= immediateAs<int64_t>(d);
+    }
+    if (!staticShape || numel < minElements) {
+      continue;
+    }
+
+    std::vector<For*> loops = l.getLoopStmtsFor(tensor);
+    if (loops.empty()) {
+      continue;
+    }
+    const Expr* trips = constantTripCount(loops[0]);
+    if (!trips || immediateAs<int64_t>(trips) < 2) {
+      continue;
+    }
+    For* outer = loops[0];
+    if (numel / immediateAs<int64_t>(trips) < kParallelChunkSize &&
+        !scheduled.count(tensor)) {
+      For* flattened = nullptr;
+      if (LoopNest::flatten(loops, &flattened) || loops.size() == 1) {
+        For* inner = nullptr;
+        For* tail = nullptr;
+        LoopNest::splitWithTail(
+            flattened, kParallelChunkSize, &outer, &inner, &tail);
+      }
+    }
+    l.setParallel(outer);
+  }
+}
+
+Stmt* TensorExprKernel::generateStmt(
+    BackendType backendType,
+    size_t scheduleRank) {
   torch::jit::tensorexpr::LoopNest l(tensorOutputs_);
   GRAPH_DEBUG("Original Stmt:\n", std::to_string(l.root_stmt()), "\n");
 
@@ -1609,6 +1692,36 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
     }
   }
 
+  // Tile and vectorize the output loops on CPU before they are parallelized,
+  // keeping track of the outputs whose loops were transformed.
+  std::unordered_set<Tensor*> scheduled;
+  numScheduleCandidates_ = 0;
+  if (backendType == kLLVMCodeGen && getTEAutoScheduleMode() > 0) {
+    AutoScheduler scheduler;
+    for (auto tensor : tensorOutputs_) {
+      std::vector<ScheduleCandidate> candidates =
+          scheduler.candidates(l, tensor);
+      if (candidates.empty() || scheduled.count(tensor)) {
+        continue;
+      }
+      numScheduleCandidates_ =
+          std::max(numScheduleCandidates_, candidates.size());
+      const ScheduleCandidate& candidate = scheduleRank < candidates.size()
+          ? candidates[scheduleRank]
+          : candidates[0];
+      if (candidate.kind != ScheduleCandidate::kDefault) {
+        scheduler.apply(l, tensor, candidate);
+        scheduled.insert(tensor);
+      }
+    }
+  }
+
+  // The outermost loops of outputs without reductions write disjoint
+  // elements in every iteration, so they can run concurrently.
+  if (backendType == kLLVMCodeGen && !hasReduction && !hasRandom_) {
+    parallelizeOuterLoops(l, tensorOutputs_, scheduled);
+  }
+
   l.prepareForCodegen();
 
   if (backendType == kLLVMCodeGen && !hasReduction) {
@@ -1692,6 +1805,49 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
           "t" + input->debugName(),
           ToDtype(static_cast<ScalarType>(*tt->scalarType())),
           {0});
+      if (hasSymbolicShapes_) {
+        // Every dim is static or given by a shape symbol. The first input dim
+        // with a symbol passes its value to the kernel.
+        std::vector<ExprHandle> sizes;
+        std::vector<int64_t> dims;
+        std::vector<ShapeArg> sizeArgs;
+        auto const symbols = *tt->symbolic_sizes().sizes();
+        for (size_t i = 0; i < symbols.size(); i++) {
+          if (symbols[i].is_static()) {
+            sizes.push_back(IntImm::make(symbols[i].static_size()));
+            dims.push_back(symbols[i].static_size());
+            continue;
+          }
+          auto it = symbolIndices_.find(symbols[i]);
+          if (it == symbolIndices_.end()) {
+            it = symbolIndices_.emplace(symbols[i], symbolVars_.size()).first;
+            symbolVars_.emplace_back(
+                "ss" + c10::to_string(symbolVars_.size()), kInt);
+            sizeArgs.emplace_back(i, symbolVars_.back());
+          }
+          sizes.push_back(symbolVars_[it->second]);
+          dims.push_back(-1 - static_cast<int64_t>(it->second));
+        }
+        tensors_.emplace(
+            input->unique(),
+            Compute(
+                "input" + c10::to_string(tensors_.size() + 1),
+                dimsFromSizes(sizes),
+                [&](const std::vector<VarHandle>& axes) {
+                  ExprHandle idx = 0;
+                  ExprHandle stride = 1;
+                  for (size_t i = axes.size(); i > 0; i--) {
+                    idx = idx + axes[i - 1] * stride;
+                    stride = stride * sizes[i - 1];
+                  }
+                  return inBuffer.load(idx);
+                }));
+        known_sizes_[input] = sizes;
+        kernelArgs_.emplace_back(
+            inBuffer, std::move(sizeArgs), std::vector<ShapeArg>());
+        inputDims_[input->offset()] = std::move(dims);
+        break;
+      }
       std::vector<DimArg> inputTensorDims;
       for (size_t i = 0; i < *tt->sizes().size(); i++) {
         auto const size = *tt->sizes()[i];
@@ -1713,6 +1869,19 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
               }));
       kernelArgs_.emplace_back(
           inBuffer, std::vector<ShapeArg>(), std::vector<ShapeArg>());
+      if (*tt->strides().concrete_sizes() ==
+          TensorType::contiguousStridesOf(*tt->sizes().concrete_sizes())) {
+        std::vector<const Expr*> sizes;
+        for (size_t i = 0; i < *tt->sizes().size(); i++) {
+          sizes.push_back(new IntImm(*tt->sizes()[i]));
+        }
+        inputBufs_.emplace(
+            input->unique(),
+            new Buf(
+                inBuffer.data()->base_handle(),
+                sizes,
+                inBuffer.data()->dtype()));
+      }
       break;
     }
     case TypeKind::FloatType: {
@@ -1793,6 +1962,85 @@ Tensor* TensorExprKernel::computeSum(const torch::jit::Value* v) {
       reduction_info.reductionDims);
 }
 
+// Lowers ops that have no TE implementation to a call of the ATen kernel
+// (see external_functions.cpp). The result gets a buffer of its own, and the
+// elementwise ops that consume it are computed in the loops that read it.
+Tensor* TensorExprKernel::computeExternalCall(const torch::jit::Value* v) {
+  const Node* n = v->node();
+  std::string funcName;
+  std::vector<const torch::jit::Value*> bufInputs;
+  std::vector<ExprHandle> extraArgs;
+  switch (n->kind()) {
+    case aten::matmul:
+      funcName = "nnc_aten_matmul";
+      bufInputs = {n->input(0), n->input(1)};
+      break;
+    case aten::addmm:
+      funcName = "nnc_aten_addmm";
+      bufInputs = {n->input(0), n->input(1), n->input(2)};
+      break;
+    case aten::linear:
+      funcName = "nnc_aten_linear";
+      bufInputs = {n->input(0), n->input(1)};
+      if (!n->input(2)->type()->cast<NoneType>()) {
+        bufInputs.push_back(n->input(2));
+      }
+      break;
+    case aten::conv2d: {
+      funcName = "nnc_aten_conv2d";
+      bufInputs = {n->input(0), n->input(1)};
+      if (!n->input(2)->type()->cast<NoneType>()) {
+        bufInputs.push_back(n->input(2));
+      }
+      // stride, padding, dilation
+      for (size_t i = 3; i < 6; i++) {
+        auto param = toIValue(n->input(i));
+        if (!param) {
+          throw malformed_input("conv2d parameters must be constant");
+        }
+        std::vector<int64_t> vals = param->toIntVector();
+        if (vals.size() == 1) {
+          vals.push_back(vals[0]);
+        }
+        if (vals.size() != 2) {
+          throw malformed_input("conv2d parameters must have 2 elements");
+        }
+        for (int64_t val : vals) {
+          extraArgs.push_back(LongImm::make(val));
+        }
+      }
+      auto groups = toIValue(n->input(6));
+      if (!groups) {
+        throw malformed_input("conv2d groups must be constant");
+      }
+      extraArgs.push_back(LongImm::make(groups->toInt()));
+      break;
+    }
+    default:
+      throw std::runtime_error("Unhandled node kind");
+  }
+
+  std::vector<BufHandle> bufArgs;
+  for (auto input : bufInputs) {
+    auto it = inputBufs_.find(input->unique());
+    if (it == inputBufs_.end()) {
+      throw malformed_input(
+          "inputs of external calls must be contiguous kernel inputs");
+    }
+    bufArgs.emplace_back(it->second);
+  }
+
+  auto const& tt = v->type()->expect<TensorType>();
+  BufHandle result(
+      "aten_" + std::string(n->kind().toUnqualString()),
+      sizesForValue(v),
+      ToDtype(static_cast<ScalarType>(*tt->scalarType())));
+  return new CompoundTensor(
+      result.node(),
+      {},
+      ExternalCall::make(result, funcName, bufArgs, extraArgs));
+}
+
 Tensor* TensorExprKernel::computeSoftmax(
     const torch::jit::Value* v,
     bool log_softmax) {
@@ -2085,6 +2333,16 @@ void TensorExprKernel::compile() {
   GRAPH_DUMP("TensorExprKernel graph:", graph_);
   // Bind inputs to buffers.
   nInputs_ = graph_->inputs().size();
+  for (auto const& input : graph_->inputs()) {
+    auto tt = input->type()->cast<TensorType>();
+    if (tt && !tt->isComplete()) {
+      if (!tt->scalarType() || !tt->symbolic_sizes().rank()) {
+        throw malformed_input("input tensor of unknown dtype or rank");
+      }
+      hasSymbolicShapes_ = true;
+    }
+  }
+  inputDims_.resize(nInputs_);
   for (auto const& input : graph_->inputs()) {
     bindInput(input);
     inputTypes_.push_back(input->type());
@@ -2108,12 +2366,42 @@ void TensorExprKernel::compile() {
   }
 
   device_ = *pickDeviceType(graph_->inputs());
+  if (hasSymbolicShapes_ && device_.type() != at::kCPU) {
+    throw malformed_input("symbolic shapes are only supported on CPU");
+  }
 
   // Move output operands from `tensors_` to `tensorOutputs_`
   for (const auto& output : graph_->outputs()) {
     if (!tensors_.count(output->unique())) {
       throw malformed_input("cannot find output Tensor");
     }
+    if (hasSymbolicShapes_) {
+      std::vector<int64_t> dims;
+      for (const Expr* dim : tensors_.at(output->unique())->buf()->dims()) {
+        const Expr* d = IRSimplifier::simplify(dim);
+        if (d->isConstant()) {
+          dims.push_back(immediateAs<int64_t>(d));
+          continue;
+        }
+        auto it = std::find_if(
+            symbolVars_.begin(), symbolVars_.end(), [&](const VarHandle& v) {
+              return v.node() == d;
+            });
+        if (it == symbolVars_.end()) {
+          throw malformed_input("unsupported symbolic output size", d);
+        }
+        dims.push_back(-1 - (it - symbolVars_.begin()));
+      }
+      tensorOutputDims_.push_back(std::move(dims));
+      tensorOutputSizes_.emplace_back();
+      tensorOutputStrides_.emplace_back();
+      tensorOutputs_.emplace_back(tensors_.at(output->unique()));
+      tensorOutputTensorOptions_.emplace_back(
+          c10::TensorOptions(tensorType(tensors_[output->unique()]))
+              .device(device_));
+      tensors_.erase(output->unique());
+      continue;
+    }
     // The "strided" tensor will be incorrect if used in NNC,
     // since NNC views it as contiguous. Only convert it to the right
     // strides at the end of the kernel (if already contiguous it's a no-op)
@@ -2151,6 +2439,76 @@ void TensorExprKernel::compile() {
       params,
       device_,
       SubgraphUtils::generateNameForGraph(graph_));
+
+  if (getTEAutoScheduleMode() == 2 && numScheduleCandidates_ > 1) {
+    autotuneSchedule(backendType, params);
+  }
+}
+
+// Number of schedules compiled and timed by autotuneSchedule, and number of
+// timed runs of each.
+static constexpr size_t kAutotuneCandidates = 4;
+static constexpr int kAutotuneRuns = 3;
+
+void TensorExprKernel::autotuneSchedule(
+    BackendType backendType,
+    const std::vector<CodeGen::BufferArg>& params) {
+  std::vector<IValue> inputs;
+  for (auto const& input : graph_->inputs()) {
+    if (auto tt = input->type()->cast<TensorType>()) {
+      if (!tt->isComplete()) {
+        return;
+      }
+      inputs.emplace_back(at::empty_strided(
+                              *tt->sizes().concrete_sizes(),
+                              *tt->strides().concrete_sizes(),
+                              c10::TensorOptions(*tt->scalarType())
+                                  .device(device_))
+                              .fill_(1));
+    } else if (input->type()->cast<IntType>()) {
+      inputs.emplace_back(static_cast<int64_t>(1));
+    } else if (input->type()->cast<FloatType>()) {
+      inputs.emplace_back(1.0);
+    } else {
+      return;
+    }
+  }
+
+  auto timeKernel = [&]() {
+    std::vector<at::Tensor> outputs;
+    std::vector<CodeGen::CallArg> runArgs =
+        prepareRunArgs(inputs, outputs, {});
+    codegen_->call(runArgs);
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < kAutotuneRuns; i++) {
+      auto start = std::chrono::steady_clock::now();
+      codegen_->call(runArgs);
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      best = std::min(best, elapsed.count());
+    }
+    return best;
+  };
+
+  double bestTime = timeKernel();
+  std::unique_ptr<CodeGen> best = std::move(codegen_);
+  size_t numCandidates =
+      std::min(numScheduleCandidates_, kAutotuneCandidates);
+  for (size_t rank = 1; rank < numCandidates; rank++) {
+    codegen_ = CreateCodeGen(
+        getCodeGenName(backendType),
+        generateStmt(backendType, rank),
+        params,
+        device_,
+        SubgraphUtils::generateNameForGraph(graph_));
+    double time = timeKernel();
+    GRAPH_DEBUG("Schedule ", rank, " ran in ", time, "s");
+    if (time < bestTime) {
+      bestTime = time;
+      best = std::move(codegen_);
+    }
+  }
+  codegen_ = std::move(best);
 }
 
 TensorExprKernel::TensorExprKernel(const std::shared_ptr<Graph>& subgraph)
@@ -2187,9 +2545,46 @@ void TensorExprKernel::run(Stack& stack) {
   }
 }
 
+bool TensorExprKernel::bindSymbolicShapes(
+    const at::ArrayRef<IValue>& inputs,
+    std::vector<int64_t>& symbolValues) {
+  symbolValues.assign(symbolVars_.size(), -1);
+  for (size_t i = 0, e = inputs.size(); i < e; i++) {
+    if (!inputs[i].isTensor()) {
+      continue;
+    }
+    auto const& t = inputs[i].toTensor();
+    auto const& dims = inputDims_[i];
+    if (!t.defined() || t.dim() != static_cast<int64_t>(dims.size()) ||
+        !t.is_contiguous()) {
+      return false;
+    }
+    for (size_t d = 0; d < dims.size(); d++) {
+      int64_t size = t.size(d);
+      if (dims[d] >= 0) {
+        if (size != dims[d]) {
+          return false;
+        }
+        continue;
+      }
+      int64_t& value = symbolValues[-1 - dims[d]];
+      if (value == -1) {
+        if (size > std::numeric_limits<int>::max()) {
+          return false;
+        }
+        value = size;
+      } else if (value != size) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
     const at::ArrayRef<IValue>& inputs,
-    std::vector<at::Tensor>& outputs) {
+    std::vector<at::Tensor>& outputs,
+    const std::vector<int64_t>& symbolValues) {
   std::vector<CodeGen::CallArg> runArgs;
   runArgs.reserve(inputs.size() + tensorOutputs_.size());
 
@@ -2201,11 +2596,30 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
       runArgs.emplace_back(input.toDouble());
     } else if (input.isTensor()) {
       runArgs.emplace_back(input.toTensor().data_ptr());
+      for (auto const& size : kernelArgs_[i].sizes()) {
+        runArgs.emplace_back(
+            static_cast<int>(input.toTensor().size(size.idx)));
+      }
     }
   }
 
   for (size_t i = 0, e = tensorOutputs_.size(); i < e; ++i) {
     auto const& opts = tensorOutputTensorOptions_[i];
+    if (hasSymbolicShapes_) {
+      std::vector<int64_t> sizes;
+      for (int64_t dim : tensorOutputDims_[i]) {
+        sizes.push_back(dim >= 0 ? dim : symbolValues[-1 - dim]);
+      }
+      outputs.emplace_back(codegen_->empty_strided(
+          sizes,
+          TensorType::contiguousStridesOf(sizes),
+          opts.dtype,
+          opts.layout,
+          opts.device,
+          opts.pinned_memory));
+      runArgs.emplace_back(outputs.back().data_ptr());
+      continue;
+    }
     outputs.emplace_back(codegen_->empty_strided(
         tensorOutputSizes_[i],
         tensorOutputStrides_[i],
@@ -2229,7 +2643,14 @@ void TensorExprKernel::runKernel(Stack& stack) {
   auto inputs = last(stack, nInputs_);
   std::vector<at::Tensor> outputs;
 
-  std::vector<CodeGen::CallArg> runArgs = prepareRunArgs(inputs, outputs);
+  std::vector<int64_t> symbolValues;
+  if (hasSymbolicShapes_ && !bindSymbolicShapes(inputs, symbolValues)) {
+    fallback(stack);
+    return;
+  }
+
+  std::vector<CodeGen::CallArg> runArgs =
+      prepareRunArgs(inputs, outputs, symbolValues);
 
   // Call the kernel.
   codegen_->call(runArgs);
@@ -139,16 +139,34 @@ class TORCH_API TensorExprKernel {
 
   Tensor* computeSoftmax(const torch::jit::Value* v, bool log_softmax);
 
+  Tensor* computeExternalCall(const torch::jit::Value* v);
+
   Tensor* computeValue(const torch::jit::Value* v);
 
-  Stmt* generateStmt(BackendType backendType);
+  // Generates the kernel statement. With auto scheduling enabled, the output
+  // loops get the scheduleRank-th best schedule picked by the AutoScheduler,
+  // or the best one if there are fewer.
+  Stmt* generateStmt(BackendType backendType, size_t scheduleRank = 0);
   std::vector<CodeGen::BufferArg> prepareBufferArgs();
 
+  // Replaces codegen_ with the fastest of the kernels compiled for the best
+  // few schedules, timed on inputs of the profiled sizes.
+  void autotuneSchedule(
+      BackendType backendType,
+      const std::vector<CodeGen::BufferArg>& params);
+
   std::string getCodeGenName(BackendType backendType);
 
   std::vector<CodeGen::CallArg> prepareRunArgs(
       const at::ArrayRef<IValue>& inputs,
-      std::vector<at::Tensor>& outputs);
+      std::vector<at::Tensor>& outputs,
+      const std::vector<int64_t>& symbolValues);
+
+  // Checks that the inputs fit the shapes the kernel was compiled for and
+  // collects the sizes of the shape symbols into symbolValues.
+  bool bindSymbolicShapes(
+      const at::ArrayRef<IValue>& inputs,
+      std::vector<int64_t>& symbolValues);
   BackendType inferBackendTypeFromDevice(at::Device device);
 
   void bindInput(const torch::jit::Value* input);
@@ -226,6 +244,9 @@ class TORCH_API TensorExprKernel {
   std::vector<Tensor*> tensorOutputs_;
   std::unordered_map<int64_t, Tensor*> tensors_;
   std::unordered_map<int64_t, VarHandle> scalars_;
+  // Contiguous, statically shaped inputs as buffers of their actual sizes,
+  // for the ops that are lowered to external calls.
+  std::unordered_map<int64_t, const Buf*> inputBufs_;
   std::unique_ptr<CodeGen> codegen_;
   at::Device device_ = at::kCPU;
   KernelArena kernelArena_;
@@ -236,6 +257,18 @@ class TORCH_API TensorExprKernel {
   bool use_fallback_{false};
   bool hasRandom_{false};
   bool hasBroadcast_{false};
+  // Largest number of schedules found for an output by the last
+  // generateStmt call.
+  size_t numScheduleCandidates_{0};
+
+  // Kernels compiled for symbolic shapes take contiguous inputs and produce
+  // contiguous outputs. Their dims are described by a static size, or by
+  // -1 - k for the k-th entry of symbolVars_.
+  bool hasSymbolicShapes_{false};
+  std::vector<VarHandle> symbolVars_;
+  std::map<c10::ShapeSymbol, size_t> symbolIndices_;
+  std::vector<std::vector<int64_t>> inputDims_;
+  std::vector<std::vector<int64_t>> tensorOutputDims_;
   std::unordered_map<const torch::jit::Value*, std::vector<ExprHandle>>
       known_sizes_;
 };
@@ -245,6 +278,13 @@ TORCH_API int& getTECudaPointwiseBlockCount();
 TORCH_API int& getTECudaPointwiseBlockSize();
 TORCH_API bool& getTEGenerateBlockCode();
 TORCH_API bool& getTEMustUseLLVMOnCPU();
+// Outputs with at least this many elements get a parallel outermost loop in
+// LLVM kernels. A value of 0 or less disables it.
+TORCH_API int64_t& getTECPUParallelMinElements();
+// Picks loop schedules for LLVM kernels with static shapes: 0 keeps the
+// default schedule, 1 uses the best schedule by the AutoScheduler cost model,
+// 2 times the best few schedules when compiling and uses the fastest.
+TORCH_API int& getTEAutoScheduleMode();
 TORCH_API bool fallbackAllowed();
 TORCH_API bool setFallbackAllowed(bool value);
 
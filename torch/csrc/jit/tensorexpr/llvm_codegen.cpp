@@ -5,15 +5,23 @@
 #include <c10/util/Exception.h>
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <random>
+#include <sstream>
 
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/TargetSelect.h>
 
 #if LLVM_VERSION_MAJOR >= 10
@@ -30,9 +38,11 @@
 #include <llvm/Support/TypeSize.h>
 #endif
 
+#include <torch/csrc/jit/tensorexpr/analysis.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/expr.h>
 #include <torch/csrc/jit/tensorexpr/half_support.h>
+#include <torch/csrc/jit/tensorexpr/hash_provider.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
@@ -48,6 +58,7 @@ C10_DEFINE_bool(
     "Use fast (but slightly less accurate) implementations of tanh and sigmoid");
 
 DEFINE_TRIGGER(llvm_codegen_created);
+DEFINE_TRIGGER(llvm_codegen_cache_hit);
 DEFINE_TRIGGER(llvm_codegen_executed);
 
 namespace torch {
@@ -97,8 +108,99 @@ llvm::ElementCount ElementCount(int lanes) {
 }
 #endif
 
+// Bump when a change to the codegen makes previously cached kernels invalid
+// in a way the cache key doesn't capture.
+constexpr int kKernelCacheVersion = 1;
+
+// Describes everything the object code compiled from stmt depends on. It is
+// stored with the object code and compared when loading it, so a collision
+// of the file names can't load the wrong kernel.
+std::string kernelCacheKey(
+    Stmt* stmt,
+    const std::vector<CodeGen::BufferArg>& args,
+    Dtype dtype,
+    llvm::TargetMachine& TM) {
+  std::ostringstream key;
+  key << "version: " << kKernelCacheVersion << "\n"
+      << "llvm: " << LLVM_VERSION_STRING << "\n"
+      << "target: " << TM.getTargetTriple().str() << " "
+      << TM.getTargetCPU().str() << " " << TM.getTargetFeatureString().str()
+      << "\n"
+      << "fast intrinsics: " << FLAGS_torch_jit_llvm_use_fast_intrinsics
+      << "\n"
+      << "return: " << dtype << "\n";
+  IRPrinter printer(key);
+  for (auto const& arg : args) {
+    key << (arg.isVar() ? "var " : "buf ") << arg.dtype() << " ";
+    arg.var()->accept(&printer);
+    key << "\n";
+  }
+  stmt->accept(&printer);
+  return key.str();
+}
+
+std::string kernelCacheFileName(Stmt* stmt, const std::string& key) {
+  HashProvider hasher;
+  SimplifierHashType hash = hasher.hash_combine(hasher.hash(stmt), key);
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << hash._h << ".o";
+  return name.str();
+}
+
+// Cache files hold the size of the key on the first line, then the key and
+// the object code.
+std::unique_ptr<llvm::MemoryBuffer> loadCachedKernel(
+    const std::string& path,
+    const std::string& key) {
+  auto file = llvm::MemoryBuffer::getFile(path);
+  if (!file) {
+    return nullptr;
+  }
+  llvm::StringRef contents = (*file)->getBuffer();
+  size_t newline = contents.find('\n');
+  size_t keySize = 0;
+  if (newline == llvm::StringRef::npos ||
+      contents.substr(0, newline).getAsInteger(10, keySize) ||
+      contents.substr(newline + 1, keySize) != key) {
+    return nullptr;
+  }
+  return llvm::MemoryBuffer::getMemBufferCopy(
+      contents.substr(newline + 1 + keySize), path);
+}
+
+void storeCachedKernel(
+    const std::string& path,
+    const std::string& key,
+    llvm::StringRef object) {
+  // Write to a temporary file and move it into place, so that processes
+  // loading the same kernel never see a partial file.
+  std::string tmpPath = path + "." + std::to_string(std::random_device()());
+  {
+    std::ofstream file(tmpPath, std::ios::binary);
+    file << key.size() << "\n" << key;
+    file.write(object.data(), object.size());
+    if (!file) {
+      GRAPH_DEBUG("Failed to write cached kernel ", tmpPath);
+      file.close();
+      std::remove(tmpPath.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+  }
+}
+
 } // namespace
 
+std::string& getTELLVMKernelCacheDir() {
+  static std::string cache_dir = []() -> std::string {
+    const char* dir = std::getenv("PYTORCH_TENSOREXPR_LLVM_CACHE_DIR");
+    return dir ? dir : "";
+  }();
+  return cache_dir;
+}
+
 class LLVMCodeGenImpl : public IRVisitor {
  private:
   std::unique_ptr<llvm::LLVMContext> context_;
@@ -127,6 +229,7 @@ class LLVMCodeGenImpl : public IRVisitor {
   void emitWrapper(const std::vector<llvm::Type*>& params);
   void emitKernel(Stmt* stmt, const std::vector<llvm::Type*>& params);
   llvm::Value* toVec(llvm::Value* v, int lanes);
+  void processParallelFor(const For* v);
 
  public:
   LLVMCodeGenImpl(
@@ -173,6 +276,7 @@ class LLVMCodeGenImpl : public IRVisitor {
   void visit(const Allocate* v) override;
   void visit(const Free* v) override;
   void visit(const Let* v) override;
+  void visit(const ExternalCall* v) override;
   void visit(const Cond* v) override;
 
   void emitIsNan(const Intrinsics* v);
@@ -291,6 +395,23 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
   llvm::InitializeNativeTargetAsmPrinter();
 
   jit_ = std::make_unique<llvm::orc::PytorchLLVMJIT>();
+
+  std::string cacheKey;
+  std::string cachePath;
+  if (!getTELLVMKernelCacheDir().empty()) {
+    cacheKey = kernelCacheKey(stmt, args, dtype, jit_->getTargetMachine());
+    cachePath =
+        getTELLVMKernelCacheDir() + "/" + kernelCacheFileName(stmt, cacheKey);
+    if (auto object = loadCachedKernel(cachePath, cacheKey)) {
+      assertSuccess(jit_->addObjectFile(std::move(object)));
+      kernelAddress_ = assertSuccess(jit_->findSymbol("wrapper").getAddress());
+      argv_ = std::make_unique<void*[]>(args.size());
+      USE_TRIGGER(llvm_codegen_cache_hit);
+      USE_TRIGGER(llvm_codegen_created);
+      return;
+    }
+  }
+
   module_ = std::make_unique<llvm::Module>("pytorch", getContext());
   module_->setDataLayout(jit_->getDataLayout());
   module_->setTargetTriple(jit_->getTargetMachine().getTargetTriple().str());
@@ -327,7 +448,29 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
   emitWrapper(params);
   emitKernel(stmt, params);
 
-  assertSuccess(jit_->addModule(std::move(module_), std::move(context_)));
+  // With the cache enabled the module is compiled here rather than by the
+  // JIT, so that the object code can be written to disk.
+  llvm::SmallVector<char, 0> objectBuffer;
+  llvm::raw_svector_ostream objectStream(objectBuffer);
+  llvm::legacy::PassManager PM;
+  if (!cachePath.empty() &&
+      !jit_->getTargetMachine().addPassesToEmitFile(
+          PM,
+          objectStream,
+          nullptr,
+#if LLVM_VERSION_MAJOR >= 10
+          llvm::CodeGenFileType::CGFT_ObjectFile)) {
+#else
+          llvm::TargetMachine::CodeGenFileType::CGFT_ObjectFile)) {
+#endif
+    PM.run(*module_);
+    llvm::StringRef object(objectBuffer.data(), objectBuffer.size());
+    storeCachedKernel(cachePath, cacheKey, object);
+    assertSuccess(
+        jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(object)));
+  } else {
+    assertSuccess(jit_->addModule(std::move(module_), std::move(context_)));
+  }
   auto sym = jit_->findSymbol("wrapper");
   kernelAddress_ = assertSuccess(sym.getAddress());
   argv_ = std::make_unique<void*[]>(params.size());
@@ -1023,6 +1166,11 @@ void LLVMCodeGenImpl::visit(const Load* v) {
 }
 
 void LLVMCodeGenImpl::visit(const For* v) {
+  if (v->is_parallel()) {
+    processParallelFor(v);
+    return;
+  }
+
   // Create "start" and "stop" values.
   v->start()->accept(this);
   auto start = this->value_;
@@ -1722,6 +1870,91 @@ void LLVMCodeGenImpl::visit(const Free* v) {
   }
 }
 
+// The external function is looked up by name when the module is linked, see
+// registerIntrinsics in llvm_jit.cpp.
+void LLVMCodeGenImpl::visit(const ExternalCall* v) {
+  std::vector<const Buf*> bufs(v->buf_args());
+  bufs.insert(bufs.begin(), v->buf());
+
+  int64_t dims_num = 0;
+  for (const Buf* b : bufs) {
+    dims_num += b->dims().size();
+  }
+  int64_t args_num = v->args().size();
+
+  auto int8PtrTy = llvm::Type::getInt8PtrTy(getContext());
+  auto constLong = [&](int64_t val) {
+    return llvm::ConstantInt::getSigned(LongTy_, val);
+  };
+
+  // The argument arrays live in the entry block so that a call inside a loop
+  // does not grow the stack.
+  llvm::IRBuilder<> entryIrb(
+      &fn_->getEntryBlock(), fn_->getEntryBlock().begin());
+  auto buf_ptrs = entryIrb.CreateAlloca(int8PtrTy, constLong(bufs.size()));
+  auto buf_ranks = entryIrb.CreateAlloca(LongTy_, constLong(bufs.size()));
+  auto buf_dims = entryIrb.CreateAlloca(LongTy_, constLong(dims_num));
+  auto buf_dtypes = entryIrb.CreateAlloca(ByteTy_, constLong(bufs.size()));
+  auto extra_args = entryIrb.CreateAlloca(LongTy_, constLong(args_num));
+
+  int64_t i = 0;
+  int64_t dim_idx = 0;
+  for (const Buf* b : bufs) {
+    b->base_handle()->accept(this);
+    irb_.CreateStore(
+        irb_.CreatePointerCast(value_, int8PtrTy),
+        irb_.CreateGEP(buf_ptrs, constLong(i)));
+    irb_.CreateStore(
+        constLong(b->dims().size()), irb_.CreateGEP(buf_ranks, constLong(i)));
+    irb_.CreateStore(
+        llvm::ConstantInt::get(
+            ByteTy_, static_cast<int8_t>(b->dtype().scalar_type())),
+        irb_.CreateGEP(buf_dtypes, constLong(i)));
+    for (const Expr* dim : b->dims()) {
+      dim->accept(this);
+      irb_.CreateStore(
+          irb_.CreateSExtOrTrunc(value_, LongTy_),
+          irb_.CreateGEP(buf_dims, constLong(dim_idx++)));
+    }
+    i++;
+  }
+
+  i = 0;
+  for (const Expr* arg : v->args()) {
+    arg->accept(this);
+    irb_.CreateStore(
+        irb_.CreateSExtOrTrunc(value_, LongTy_),
+        irb_.CreateGEP(extra_args, constLong(i++)));
+  }
+
+  auto longPtrTy = LongTy_->getPointerTo();
+  FunctionCallee callee = module_->getOrInsertFunction(
+      v->func_name(),
+      llvm::FunctionType::get(
+          llvm::Type::getVoidTy(getContext()),
+          {LongTy_, // bufs_num
+           int8PtrTy->getPointerTo(), // buf_ptrs
+           longPtrTy, // buf_ranks
+           longPtrTy, // buf_dims
+           ByteTy_->getPointerTo(), // buf_dtypes
+           LongTy_, // args_num
+           longPtrTy}, // extra_args
+          false),
+      {});
+  irb_.CreateCall(
+      callee.getFunctionType(),
+      callee.getCallee(),
+      {constLong(bufs.size()),
+       buf_ptrs,
+       buf_ranks,
+       buf_dims,
+       buf_dtypes,
+       constLong(args_num),
+       extra_args});
+
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
+}
+
 void LLVMCodeGenImpl::visit(const Let* v) {
   v->value()->accept(this);
   if (!varToVal_.count(v->var())) {
@@ -1774,6 +2007,96 @@ void LLVMCodeGenImpl::visit(const Cond* v) {
   irb_.SetInsertPoint(end_block);
 }
 
+// A parallel loop is lowered to a call to DispatchParallel (see llvm_jit.cpp),
+// which runs the loop body on ATen's intra-op thread pool. The body is
+// outlined into a function of the loop index and a pointer to a struct
+// holding the values it uses from the enclosing function.
+void LLVMCodeGenImpl::processParallelFor(const For* v) {
+  // Create "start" and "stop" values.
+  v->start()->accept(this);
+  auto start = irb_.CreateSExtOrTrunc(value_, LongTy_);
+  v->stop()->accept(this);
+  auto stop = irb_.CreateSExtOrTrunc(value_, LongTy_);
+
+  // Collect the values the body needs from the enclosing function, in the
+  // order they are used so that the generated code is deterministic.
+  std::vector<const Var*> captured_vars;
+  std::vector<llvm::Value*> captured_vals;
+  std::vector<llvm::Type*> captured_types;
+  std::unordered_set<const Var*> seen;
+  for (const Var* var : NodeFinder<Var>::find(v->body())) {
+    if (var == v->var() || !seen.insert(var).second) {
+      continue;
+    }
+    if (!varToArg_.count(var) && !varToVal_.count(var)) {
+      // Defined in the body
+      continue;
+    }
+    var->accept(this);
+    captured_vars.push_back(var);
+    captured_vals.push_back(value_);
+    captured_types.push_back(value_->getType());
+  }
+
+  // Pack them in a struct allocated in the entry block.
+  auto packedTy = llvm::StructType::get(getContext(), captured_types);
+  llvm::IRBuilder<> entryIrb(
+      &fn_->getEntryBlock(), fn_->getEntryBlock().begin());
+  auto packed = entryIrb.CreateAlloca(packedTy);
+  for (size_t i = 0; i < captured_vals.size(); i++) {
+    irb_.CreateStore(
+        captured_vals[i], irb_.CreateStructGEP(packedTy, packed, i));
+  }
+
+  // Outline the body.
+  auto voidTy = llvm::Type::getVoidTy(getContext());
+  auto int8PtrTy = llvm::Type::getInt8PtrTy(getContext());
+  auto bodyFn = llvm::Function::Create(
+      llvm::FunctionType::get(voidTy, {LongTy_, int8PtrTy}, false),
+      llvm::Function::PrivateLinkage,
+      "parallel_body",
+      module_.get());
+
+  auto outerFn = fn_;
+  auto outerIP = irb_.saveIP();
+  std::unordered_map<const Var*, int> outerVarToArg;
+  std::unordered_map<const Var*, llvm::Value*> outerVarToVal;
+  std::swap(outerVarToArg, varToArg_);
+  std::swap(outerVarToVal, varToVal_);
+
+  fn_ = bodyFn;
+  irb_.SetInsertPoint(llvm::BasicBlock::Create(getContext(), "entry", fn_));
+  auto packedArg =
+      irb_.CreatePointerCast(fn_->arg_begin() + 1, packedTy->getPointerTo());
+  for (size_t i = 0; i < captured_vars.size(); i++) {
+    varToVal_[captured_vars[i]] =
+        irb_.CreateLoad(irb_.CreateStructGEP(packedTy, packedArg, i));
+  }
+  varToVal_[v->var()] = irb_.CreateTrunc(fn_->arg_begin(), IntTy_);
+  v->body()->accept(this);
+  irb_.CreateRetVoid();
+
+  fn_ = outerFn;
+  irb_.restoreIP(outerIP);
+  std::swap(outerVarToArg, varToArg_);
+  std::swap(outerVarToVal, varToVal_);
+
+  // Run it.
+  FunctionCallee dispatcher = module_->getOrInsertFunction(
+      "DispatchParallel",
+      llvm::FunctionType::get(
+          voidTy, {int8PtrTy, LongTy_, LongTy_, int8PtrTy}, false),
+      {});
+  irb_.CreateCall(
+      dispatcher.getFunctionType(),
+      dispatcher.getCallee(),
+      {irb_.CreatePointerCast(bodyFn, int8PtrTy),
+       start,
+       stop,
+       irb_.CreatePointerCast(packed, int8PtrTy)});
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
+}
+
 void LLVMCodeGenImpl::optimize(llvm::Module& M) {
   llvm::legacy::FunctionPassManager FPM(&M);
   llvm::legacy::PassManager PM;
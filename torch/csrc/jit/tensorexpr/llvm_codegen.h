@@ -7,6 +7,7 @@
 #include <torch/csrc/jit/tensorexpr/ir.h>
 #include <torch/csrc/jit/tensorexpr/ir_visitor.h>
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -62,6 +63,11 @@ class TORCH_API LLVMCodeGen : public CodeGen {
   std::unique_ptr<LLVMCodeGenImpl> impl_;
 };
 
+// Directory where compiled kernels are cached and reused by later processes.
+// The cache is disabled if it is empty, which is the default unless
+// PYTORCH_TENSOREXPR_LLVM_CACHE_DIR is set.
+TORCH_API std::string& getTELLVMKernelCacheDir();
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
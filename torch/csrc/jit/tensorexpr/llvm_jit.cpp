@@ -2,6 +2,8 @@
 
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
+#include <torch/csrc/jit/tensorexpr/external_functions.h>
+
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/JITSymbol.h>
 #include <llvm/ExecutionEngine/Orc/CompileUtils.h>
@@ -19,6 +21,7 @@
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include <ATen/Parallel.h>
 #include <c10/util/Half.h>
 
 #include <sleef.h>
@@ -62,6 +65,23 @@ static llvm::orc::JITTargetMachineBuilder makeTargetMachineBuilder() {
 #endif
 }
 
+// Runs the body of a parallel loop, outlined by the LLVM codegen into a
+// function taking the loop index and the values it captures, on the intra-op
+// thread pool.
+static void DispatchParallel(
+    int8_t* func,
+    int64_t start,
+    int64_t stop,
+    int8_t* packed_data) {
+  using ParallelCallee = void (*)(int64_t, int8_t*);
+  auto callee = reinterpret_cast<ParallelCallee>(func);
+  at::parallel_for(start, stop, 1, [&](int64_t f_begin, int64_t f_end) {
+    for (int64_t index = f_begin; index < f_end; index++) {
+      callee(index, packed_data);
+    }
+  });
+}
+
 static void registerIntrinsics(
     llvm::orc::JITDylib& JD,
     llvm::orc::MangleAndInterner& Mangle) {
@@ -84,6 +104,9 @@ static void registerIntrinsics(
         entry("atan2f", &atan2f), entry("fmodf", &fmodf),
         entry("remainderf", &remainderf),
 
+        // parallel loops
+        entry("DispatchParallel", &DispatchParallel),
+
         // float -> half & half -> float conversions
         entry("__gnu_h2f_ieee", &c10::detail::fp16_ieee_to_fp32_value),
         entry("__gnu_f2h_ieee", &c10::detail::fp16_ieee_from_fp32_value),
@@ -208,6 +231,13 @@ static void registerIntrinsics(
         entry("Sleef_fmodd4", &Sleef_fmodd4),
 #endif
   })));
+
+  // Functions called by ExternalCall statements
+  SymbolMap externalFunctions;
+  for (const auto& kv : getNNCFunctionRegistry()) {
+    externalFunctions.insert(entry(kv.first.c_str(), kv.second));
+  }
+  assertSuccess(JD.define(absoluteSymbols(externalFunctions)));
 }
 
 namespace llvm {
@@ -253,6 +283,10 @@ class TORCH_API PytorchLLVMJITImpl {
     return Error::success();
   }
 
+  Error addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+    return LLJ->addObjectFile(std::move(Obj));
+  }
+
   JITSymbol findSymbol(const std::string Name) {
     return assertSuccess(LLJ->lookup(Name));
   }
@@ -277,6 +311,10 @@ Error PytorchLLVMJIT::addModule(
   return impl_->addModule(std::move(M), std::move(C));
 }
 
+Error PytorchLLVMJIT::addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+  return impl_->addObjectFile(std::move(Obj));
+}
+
 JITSymbol PytorchLLVMJIT::findSymbol(const std::string Name) {
   return impl_->findSymbol(std::move(Name));
 }
@@ -349,6 +387,14 @@ class TORCH_API PytorchLLVMJITImpl {
     return K;
   }
 
+  VModuleKey addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+    auto K = ES.allocateVModule();
+    assertSuccess(
+        ObjectLayer.addObject(K, std::move(Obj)),
+        "Failed to add object to object layer");
+    return K;
+  }
+
   JITSymbol findSymbol(const std::string Name) {
     std::string MangledName;
     raw_string_ostream MangledNameStream(MangledName);
@@ -381,6 +427,11 @@ Error PytorchLLVMJIT::addModule(
   return Error::success();
 }
 
+Error PytorchLLVMJIT::addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+  impl_->addObjectFile(std::move(Obj));
+  return Error::success();
+}
+
 JITSymbol PytorchLLVMJIT::findSymbol(const std::string Name) {
   return impl_->findSymbol(std::move(Name));
 }
@@ -536,8 +536,10 @@ Stmt* LoopNest::lowerToStmt(Tensor* t) {
   Stmt* body = t->ElementStmt();
 
   // If this Tensor has no functional body, it already has its axes expanded.
+  // The statement is owned by the Tensor, so clone it: several LoopNests may be
+  // built from the same Tensors.
   if (nullptr == t->body()) {
-    return body;
+    return Stmt::clone(body);
   }
 
   if (t->ndim() == 0 && t->reduce_ndim() == 0) {
@@ -747,6 +749,18 @@ bool LoopNest::computeInline(Stmt* s) {
 }
 
 bool LoopNest::computeInline(const Buf* b) {
+  // Buffers produced or consumed by external calls have to be materialized.
+  for (auto* c : NodeFinder<ExternalCall>::find(root_stmt_)) {
+    if (c->buf() == b) {
+      return false;
+    }
+    for (const Buf* buf_arg : c->buf_args()) {
+      if (buf_arg == b) {
+        return false;
+      }
+    }
+  }
+
   // Find producers.
   Store* relevant_store{nullptr};
   auto stores = NodeFinder<Store>::find(root_stmt_);
@@ -803,6 +817,10 @@ void LoopNest::inlineIntermediateBufs(bool allow_duplicated_work) {
       // and avoiding an intermediary buffer
       if (stores.size() == 1) {
         auto store = dynamic_cast<Store*>(stores[0].s);
+        if (!store) {
+          // Written by an external call
+          continue;
+        }
         auto input_as_load = dynamic_cast<const Load*>(store->value());
         if (input_as_load && input_bufs.count(input_as_load->buf())) {
           bufs_to_inline.insert(buf);
@@ -855,6 +873,21 @@ class LoadOrStoreUseFinder : public IRVisitor {
     IRVisitor::visit(v);
   }
 
+  void visit(const ExternalCall* v) override {
+    if (stores_[v->buf()].insert((Stmt*)v).second) {
+      uses_[v->buf()].push_back({(Stmt*)v, true});
+    }
+    last_stmt_ = (Stmt*)v;
+
+    for (const Buf* input_buf : v->buf_args()) {
+      if (loads_[input_buf].insert(last_stmt_).second) {
+        uses_[input_buf].push_back({last_stmt_, false});
+      }
+    }
+
+    IRVisitor::visit(v);
+  }
+
   Stmt* last_stmt_ = nullptr;
   std::unordered_map<const Buf*, std::vector<BufLoadOrStoreUse>> uses_;
 
@@ -871,7 +904,8 @@ findLoadOrStoreUses(Stmt* s) {
 
 class ContainedStmtsFinder : public IRVisitor {
  public:
-  // Simply list all Stores and Block that are children of the given stmt
+  // Simply list all Stores, ExternalCalls and Blocks that are children of the
+  // given stmt
   const std::unordered_set<Stmt*>& findContainedStmts(Stmt* s) {
     contained_.clear();
     s->accept(this);
@@ -883,6 +917,10 @@ class ContainedStmtsFinder : public IRVisitor {
     contained_.insert((Stmt*)v);
     IRVisitor::visit(v);
   }
+  void visit(const ExternalCall* v) override {
+    contained_.insert((Stmt*)v);
+    IRVisitor::visit(v);
+  }
   void visit(const Block* v) override {
     contained_.insert((Stmt*)v);
     IRVisitor::visit(v);
@@ -1617,6 +1655,10 @@ void LoopNest::setGPUThreadIndex(For* f, int thread_index) {
   f->set_gpu_thread_index(thread_index);
 }
 
+void LoopNest::setParallel(For* f) {
+  f->set_parallel();
+}
+
 void LoopNest::setBufferMap(
     For* f,
     const std::unordered_map<std::string, const Buf*>& map) {
@@ -84,6 +84,10 @@ class TORCH_API LoopNest {
   void setGPUBlockIndex(For* f, int idx);
   void setGPUThreadIndex(For* f, int idx);
 
+  // Runs the iterations of f concurrently on CPU. Only the LLVM backend
+  // supports it, and the iterations must not depend on each other.
+  void setParallel(For* f);
+
   using AccessResult = std::pair<const Buf*, Stmt*>;
   // Insert a cache for the consumer's usages of the buffer produced in
   // consumer, and redirect reads and writes in the consumer to that cache.
@@ -841,7 +841,8 @@ void MemDependencyChecker::visit(const For* v) {
 
   // TODO this isn't a scalable way to determine parallelism.
   bool parallelized = v->loop_options().is_gpu_block_index() ||
-      v->loop_options().is_gpu_thread_index();
+      v->loop_options().is_gpu_thread_index() ||
+      v->loop_options().is_parallel();
 
   // Store buffers allocated at this scope.
   std::unordered_set<const Var*> local_intermediates;
@@ -496,6 +496,9 @@ class TORCH_API LoopOptions {
     if (is_gpu_thread_index()) {
       throw std::runtime_error("Cannot set both gpu block and thread index");
     }
+    if (is_parallel()) {
+      throw std::runtime_error("Cannot set both gpu block index and parallel");
+    }
     if (is_gpu_block_index() && gpu_block_index() != index) {
       throw std::runtime_error("Cannot set a previously set block index");
     }
@@ -534,23 +537,41 @@ class TORCH_API LoopOptions {
     if (is_gpu_block_index()) {
       throw std::runtime_error("Cannot set both gpu thread and block index");
     }
+    if (is_parallel()) {
+      throw std::runtime_error("Cannot set both gpu thread index and parallel");
+    }
     if (is_gpu_thread_index() && gpu_thread_index() != index) {
       throw std::runtime_error("Cannot set a previously set thread index");
     }
     gpu_thread_index_ = index;
   }
 
+  // CPU parallel loop, its iterations are run on ATen's intra-op thread pool
+  bool is_parallel() const {
+    return is_parallel_;
+  }
+
+  void set_parallel() {
+    if (is_gpu_block_index() || is_gpu_thread_index()) {
+      throw std::runtime_error("Cannot set both gpu index and parallel");
+    }
+    is_parallel_ = true;
+  }
+
   std::string ToString() const {
     if (is_gpu_block_index()) {
       return gpu_block_index_str();
     } else if (is_gpu_thread_index()) {
       return gpu_thread_index_str();
+    } else if (is_parallel()) {
+      return "parallel";
     }
     return "";
   }
 
   bool isDefault() const {
-    return gpu_block_index_ == IDX_UNSET && gpu_thread_index_ == IDX_UNSET;
+    return gpu_block_index_ == IDX_UNSET && gpu_thread_index_ == IDX_UNSET &&
+        !is_parallel_;
   }
 
   void set_buffer_mapping(
@@ -565,6 +586,7 @@ class TORCH_API LoopOptions {
  private:
   int gpu_block_index_{IDX_UNSET};
   int gpu_thread_index_{IDX_UNSET};
+  bool is_parallel_{false};
   std::unordered_map<std::string, const Buf*> map_input_to_tensor_bufs_;
 };
 
@@ -659,6 +681,14 @@ class TORCH_API For : public StmtNode<For> {
     loop_options_.set_gpu_thread_index(thread_index);
   }
 
+  void set_parallel() {
+    loop_options_.set_parallel();
+  }
+
+  bool is_parallel() const {
+    return loop_options_.is_parallel();
+  }
+
   void set_buffer_map(const std::unordered_map<std::string, const Buf*>& map) {
     loop_options_.set_buffer_mapping(map);
   }
@@ -719,6 +749,49 @@ class TORCH_API SyncThreads : public StmtNode<SyncThreads> {
   SyncThreads() {}
 };
 
+// Calls a function from the NNC external function registry (see
+// external_functions.h) that writes buf from buf_args and the integer args.
+class TORCH_API ExternalCall : public StmtNode<ExternalCall> {
+ public:
+  static ExternalCall* make(
+      BufHandle buf,
+      const std::string& func_name,
+      const std::vector<BufHandle>& buf_args,
+      const std::vector<ExprHandle>& args);
+
+  const Buf* buf() const {
+    return buf_;
+  }
+
+  std::string func_name() const {
+    return func_name_;
+  }
+
+  std::vector<const Buf*> buf_args() const {
+    return buf_args_;
+  }
+
+  std::vector<const Expr*> args() const {
+    return args_;
+  }
+
+  ExternalCall(
+      const Buf* buf,
+      std::string func_name,
+      std::vector<const Buf*> buf_args,
+      std::vector<const Expr*> args)
+      : buf_(buf),
+        func_name_(std::move(func_name)),
+        buf_args_(std::move(buf_args)),
+        args_(std::move(args)) {}
+
+ private:
+  const Buf* buf_;
+  std::string func_name_;
+  std::vector<const Buf*> buf_args_;
+  std::vector<const Expr*> args_;
+};
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
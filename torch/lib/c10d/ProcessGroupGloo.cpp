@@ -13,6 +13,8 @@
 #endif
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -443,7 +445,9 @@ void ProcessGroupGloo::RecvWork::abort() {
 }
 
 ProcessGroupGloo::Options::Options()
-    : timeout(std::chrono::milliseconds(10 * 1000)), threads(2) {}
+    : timeout(std::chrono::milliseconds(10 * 1000)),
+      threads(2),
+      hierarchicalAllreduce(false) {}
 
 namespace {
 
@@ -568,6 +572,7 @@ ProcessGroupGloo::ProcessGroupGloo(
     Options options)
     : ProcessGroup(rank, size),
       store_(new GlooStore(store)),
+      numHosts_(0),
       stop_(false),
       collectiveCounter_(0) {
   auto& devices = options.devices;
@@ -596,6 +601,10 @@ ProcessGroupGloo::ProcessGroupGloo(
     contexts_.push_back(std::move(context));
   }
 
+  if (options.hierarchicalAllreduce) {
+    connectHierarchicalAllreduce(options);
+  }
+
   // Every worker thread stores the AsyncWork object it's currently
   // working on in the workInProgress_ vector. It must have size equal
   // to the number of workers such that they can simply index into it
@@ -608,6 +617,86 @@ ProcessGroupGloo::ProcessGroupGloo(
   }
 }
 
+void ProcessGroupGloo::connectHierarchicalAllreduce(const Options& options) {
+#ifdef _WIN32
+  throw std::invalid_argument(
+      "Hierarchical allreduce is not supported on Windows");
+#else
+  auto store = ::gloo::rendezvous::PrefixStore("hierarchical", *store_);
+
+  std::string hostname = options.hostname;
+  if (hostname.empty()) {
+    const auto hostNameMax = sysconf(_SC_HOST_NAME_MAX);
+    auto buffer = std::unique_ptr<char[]>(new char[hostNameMax + 1]());
+    auto rv = gethostname(buffer.get(), hostNameMax);
+    if (rv != 0) {
+      throw std::system_error(errno, std::system_category());
+    }
+    hostname = buffer.get();
+  }
+  store.set(
+      std::to_string(rank_),
+      std::vector<char>(hostname.begin(), hostname.end()));
+
+  // The ranks on this host and the hosts in the order of their first rank.
+  std::vector<int> localRanks;
+  std::vector<std::string> hosts;
+  for (int rank = 0; rank < size_; rank++) {
+    std::string host = hostname;
+    if (rank != rank_) {
+      auto value = store.get(std::to_string(rank));
+      host = std::string(value.begin(), value.end());
+    }
+    if (std::find(hosts.begin(), hosts.end(), host) == hosts.end()) {
+      hosts.push_back(host);
+    }
+    if (host == hostname) {
+      localRanks.push_back(rank);
+    }
+  }
+
+  // Every rank has a host of its own, so there is nothing to share.
+  numHosts_ = hosts.size();
+  if (numHosts_ == static_cast<size_t>(size_)) {
+    return;
+  }
+
+  // The lowest rank on a host creates the shared memory segment and is the
+  // leader of the host.
+  const int localRank =
+      std::find(localRanks.begin(), localRanks.end(), rank_) -
+      localRanks.begin();
+  const int localSize = localRanks.size();
+  const auto segmentKey = "segment/" + std::to_string(localRanks[0]);
+  if (localRank == 0) {
+    static std::atomic<int> segmentCounter(0);
+    auto name = c10::str("/c10d_gloo_", getpid(), "_", segmentCounter++);
+    localReducer_ = std::make_shared<SharedMemoryReducer>(
+        name, localRank, localSize, options.timeout);
+    store.set(segmentKey, std::vector<char>(name.begin(), name.end()));
+  } else {
+    auto value = store.get(segmentKey);
+    localReducer_ = std::make_shared<SharedMemoryReducer>(
+        std::string(value.begin(), value.end()),
+        localRank,
+        localSize,
+        options.timeout);
+  }
+  localReducer_->connect();
+
+  if (localRank == 0 && numHosts_ > 1) {
+    const int hostIndex =
+        std::find(hosts.begin(), hosts.end(), hostname) - hosts.begin();
+    auto context =
+        std::make_shared<::gloo::rendezvous::Context>(hostIndex, numHosts_);
+    auto leaderStore = ::gloo::rendezvous::PrefixStore("leaders", store);
+    context->setTimeout(options.timeout);
+    context->connectFullMesh(leaderStore, options.devices[0]);
+    leaderContext_ = std::move(context);
+  }
+#endif
+}
+
 ProcessGroupGloo::~ProcessGroupGloo() {
   std::unique_lock<std::mutex> lock(workMutex_);
   workConsumeCV_.wait(lock, [&] { return workQueue_.empty(); });
@@ -634,6 +723,14 @@ std::shared_ptr<::gloo::Context> ProcessGroupGloo::getContext(uint32_t tag) {
   return contexts_[tag % contexts_.size()];
 }
 
+void ProcessGroupGloo::AsyncWork::finishFuture(std::exception_ptr eptr) {
+  if (eptr) {
+    future_->setError(eptr);
+  } else {
+    future_->markCompleted(c10::IValue(futureValue()));
+  }
+}
+
 void ProcessGroupGloo::runLoop(int workerIndex) {
   std::unique_lock<std::mutex> lock(workMutex_);
 
@@ -870,9 +967,59 @@ class AsyncAllreduceWork : public ProcessGroupGloo::AsyncWork {
   }
 
  protected:
+  std::vector<at::Tensor> futureValue() override {
+    return outputs_;
+  }
+
   std::vector<at::Tensor> outputs_;
 };
 
+// Runs the allreduce of the ranks on this host through `reducer`. If there
+// is more than one host, the leaders of the hosts allreduce the locally
+// reduced chunks over `context`, which is only set on the leaders.
+class AsyncHierarchicalAllreduceWork : public AsyncAllreduceWork {
+ public:
+  AsyncHierarchicalAllreduceWork(
+      const std::shared_ptr<SharedMemoryReducer>& reducer,
+      const std::shared_ptr<gloo::Context>& context,
+      bool multipleHosts,
+      std::vector<at::Tensor>& inputs,
+      uint32_t tag)
+      : AsyncAllreduceWork(context, inputs, ReduceOp::SUM, tag),
+        reducer(reducer),
+        multipleHosts(multipleHosts),
+        sequence(reducer->nextSequence()) {}
+
+  std::shared_ptr<SharedMemoryReducer> reducer;
+  const bool multipleHosts;
+  const uint64_t sequence;
+
+  void run() override {
+    auto tensor = inputs[0].contiguous();
+    for (size_t i = 1; i < inputs.size(); i++) {
+      tensor = tensor + inputs[i];
+    }
+
+    // The reducer only calls the function on the leader, but it has to be
+    // set on all local ranks for them to wait for the leader.
+    SharedMemoryReducer::LeaderFunc leaderFunc;
+    if (multipleHosts) {
+      leaderFunc = [this](at::Tensor& chunk) {
+        std::vector<at::Tensor> chunks = {chunk};
+        allreduce(chunks);
+      };
+    }
+    reducer->allreduce(sequence, tensor, leaderFunc);
+
+    for (auto& input : inputs) {
+      if (!input.is_same(tensor)) {
+        input.copy_(tensor);
+      }
+    }
+    outputs_ = inputs;
+  }
+};
+
 class AsyncAllreduceCoalescedWork : public AsyncAllreduceWork {
  public:
   AsyncAllreduceCoalescedWork(
@@ -1065,6 +1212,11 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     return outputs;
   }
 
+ protected:
+  std::vector<at::Tensor> futureValue() override {
+    return outputs;
+  }
+
  private:
   std::vector<SparseTensorMetadata> allgather_metadata(
       const at::Tensor& tensor) {
@@ -1334,7 +1486,14 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   auto tag = nextTag();
   auto context = getContext(tag);
   if (device.type() == at::kCPU) {
-    if (layout == c10::kStrided) {
+    // Half isn't summed in shared memory. The choice only depends on
+    // arguments that have to match across ranks.
+    if (layout == c10::kStrided && localReducer_ &&
+        opts.reduceOp == ReduceOp::SUM &&
+        inputs[0].scalar_type() != at::kHalf) {
+      work = c10::make_intrusive<AsyncHierarchicalAllreduceWork>(
+          localReducer_, leaderContext_, numHosts_ > 1, inputs, tag);
+    } else if (layout == c10::kStrided) {
       work = c10::make_intrusive<AsyncAllreduceWork>(
           std::move(context), inputs, opts.reduceOp, tag);
     } else if (layout == c10::kSparse) {
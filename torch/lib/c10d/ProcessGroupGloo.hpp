@@ -21,6 +21,7 @@
 #endif
 
 #include <c10d/ProcessGroup.hpp>
+#include <c10d/SharedMemoryReducer.hpp>
 #include <c10d/Store.hpp>
 #include <c10d/Types.hpp>
 #include <c10d/Utils.hpp>
@@ -78,12 +79,31 @@ class ProcessGroupGloo : public ProcessGroup {
         eptr = std::current_exception();
       }
       work->finish(eptr);
+      work->finishFuture(eptr);
     }
 
     virtual void run() = 0;
 
+    // The future is completed on the worker thread that ran the work, with
+    // the value of futureValue(), so callbacks added to it should not block.
+    c10::intrusive_ptr<c10::ivalue::Future> getFuture() override {
+      return future_;
+    }
+
    protected:
     friend class ProcessGroupGloo;
+
+    // Tensors the future of the work completes with, empty by default.
+    virtual std::vector<at::Tensor> futureValue() {
+      return {};
+    }
+
+   private:
+    void finishFuture(std::exception_ptr eptr);
+
+    c10::intrusive_ptr<c10::ivalue::Future> future_ =
+        c10::make_intrusive<c10::ivalue::Future>(
+            c10::ListType::create(c10::TensorType::get()));
   };
 
   // For send and recv operations there is no need to pass them to the
@@ -131,6 +151,18 @@ class ProcessGroupGloo : public ProcessGroup {
     std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
     std::chrono::milliseconds timeout;
     int threads;
+
+    // If set, SUM allreduce of dense CPU tensors is done hierarchically:
+    // ranks on the same host reduce through shared memory, one leader per
+    // host allreduces the result with the other leaders on the first device
+    // and the leaders share it with their local ranks through shared memory.
+    // Not supported on Windows.
+    bool hierarchicalAllreduce;
+
+    // Name used to group ranks by host for hierarchical allreduce. Ranks
+    // with the same name must be able to share memory. Defaults to the
+    // hostname of this machine.
+    std::string hostname;
   };
 
   // Helper functions to create a new device object.
@@ -237,6 +269,15 @@ class ProcessGroupGloo : public ProcessGroup {
   // In order to use more than one device (or allow for parallelism on
   // a single device), you need multiple contexts.
   std::vector<std::shared_ptr<::gloo::Context>> contexts_;
+
+  // State of the hierarchical allreduce, see Options::hierarchicalAllreduce.
+  // The reducer is only set if at least two ranks share a host. The context
+  // of the host leaders is only set on the leaders and if there is more than
+  // one host.
+  std::shared_ptr<SharedMemoryReducer> localReducer_;
+  std::shared_ptr<::gloo::Context> leaderContext_;
+  size_t numHosts_;
+
   std::vector<std::thread> threads_;
   bool stop_;
 
@@ -254,6 +295,10 @@ class ProcessGroupGloo : public ProcessGroup {
   // to contexts being used in a round-robin fashion.
   std::shared_ptr<::gloo::Context> getContext(uint32_t tag);
 
+  // Groups ranks by host and connects the state of the hierarchical
+  // allreduce.
+  void connectHierarchicalAllreduce(const Options& options);
+
   // Entrypoint for worker threads.
   void runLoop(int workerIndex);
 
@@ -0,0 +1,213 @@
+#include <c10d/SharedMemoryReducer.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <system_error>
+#include <thread>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Utils.hpp>
+
+namespace c10d {
+
+namespace {
+
+// Barrier state at the start of the segment. The segment is zero filled when
+// it is created, which is the initial state of the barrier.
+struct SegmentHeader {
+  // Number of local ranks that have reached the barrier.
+  std::atomic<uint32_t> count;
+  // Incremented by the last local rank to reach the barrier.
+  std::atomic<uint32_t> generation;
+};
+
+// Keep the slots cache line aligned.
+constexpr size_t kHeaderBytes = 64;
+
+static_assert(
+    sizeof(SegmentHeader) <= kHeaderBytes,
+    "SegmentHeader doesn't fit the segment header");
+
+// Number of spins in the barrier before the waiting thread yields.
+constexpr int kSpinsBeforeYield = 1000;
+
+} // namespace
+
+constexpr size_t SharedMemoryReducer::kSlotBytes;
+
+SharedMemoryReducer::SharedMemoryReducer(
+    const std::string& name,
+    int localRank,
+    int localSize,
+    std::chrono::milliseconds timeout)
+    : name_(name),
+      localRank_(localRank),
+      localSize_(localSize),
+      timeout_(timeout),
+      size_(kHeaderBytes + (localSize + 1) * kSlotBytes),
+      data_(nullptr),
+      unlinked_(false),
+      sequenceCounter_(0),
+      nextToRun_(0) {
+  TORCH_CHECK(
+      localRank >= 0 && localRank < localSize,
+      "Invalid local rank ",
+      localRank,
+      " for ",
+      localSize,
+      " local ranks");
+
+  int fd = -1;
+  if (localRank_ == 0) {
+    SYSCHECK_ERR_RETURN_NEG1(
+        fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600));
+  } else {
+    SYSCHECK_ERR_RETURN_NEG1(fd = shm_open(name_.c_str(), O_RDWR, 0));
+  }
+
+  try {
+    if (localRank_ == 0) {
+      SYSCHECK_ERR_RETURN_NEG1(ftruncate(fd, size_));
+    }
+    data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      throw std::system_error(errno, std::system_category());
+    }
+  } catch (...) {
+    ::close(fd);
+    if (localRank_ == 0) {
+      shm_unlink(name_.c_str());
+    }
+    throw;
+  }
+  ::close(fd);
+}
+
+SharedMemoryReducer::~SharedMemoryReducer() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+  if (localRank_ == 0 && !unlinked_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+void SharedMemoryReducer::connect() {
+  barrier();
+  if (localRank_ == 0) {
+    SYSCHECK_ERR_RETURN_NEG1(shm_unlink(name_.c_str()));
+  }
+  unlinked_ = true;
+}
+
+uint64_t SharedMemoryReducer::nextSequence() {
+  return sequenceCounter_++;
+}
+
+void SharedMemoryReducer::barrier() {
+  auto header = static_cast<SegmentHeader*>(data_);
+  // The generation can't change before this rank has reached the barrier.
+  const auto generation = header->generation.load(std::memory_order_acquire);
+  if (header->count.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+      static_cast<uint32_t>(localSize_)) {
+    header->count.store(0, std::memory_order_relaxed);
+    header->generation.fetch_add(1, std::memory_order_release);
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  int spins = 0;
+  while (header->generation.load(std::memory_order_acquire) == generation) {
+    if (++spins < kSpinsBeforeYield) {
+      continue;
+    }
+    spins = 0;
+    std::this_thread::yield();
+    if (timeout_ != kNoTimeout &&
+        std::chrono::steady_clock::now() - start > timeout_) {
+      throw std::runtime_error(
+          "Timed out waiting for local ranks in shared memory segment " +
+          name_);
+    }
+  }
+}
+
+at::Tensor SharedMemoryReducer::slot(int localRank, const at::Tensor& chunk) {
+  auto ptr = static_cast<char*>(data_) + kHeaderBytes + localRank * kSlotBytes;
+  return at::from_blob(ptr, {chunk.numel()}, chunk.options());
+}
+
+void SharedMemoryReducer::allreduce(
+    uint64_t sequence,
+    at::Tensor& tensor,
+    const LeaderFunc& leaderFunc) {
+  TORCH_CHECK(
+      tensor.device().is_cpu() && tensor.is_contiguous(),
+      "SharedMemoryReducer only supports contiguous CPU tensors");
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return nextToRun_ == sequence; });
+  lock.unlock();
+
+  // Let the next call run even if this one failed, so that it fails
+  // instead of waiting forever.
+  auto done = [&] {
+    lock.lock();
+    nextToRun_++;
+    lock.unlock();
+    cv_.notify_all();
+  };
+
+  try {
+    auto flat = tensor.view(-1);
+    const int64_t chunkElements = kSlotBytes / tensor.element_size();
+    for (int64_t offset = 0; offset < flat.numel(); offset += chunkElements) {
+      const auto length = std::min(chunkElements, flat.numel() - offset);
+      auto chunk = flat.narrow(0, offset, length);
+      allreduceChunk(chunk, leaderFunc);
+    }
+  } catch (...) {
+    done();
+    throw;
+  }
+  done();
+}
+
+void SharedMemoryReducer::allreduceChunk(
+    at::Tensor& chunk,
+    const LeaderFunc& leaderFunc) {
+  slot(localRank_, chunk).copy_(chunk);
+  barrier();
+
+  // Every local rank sums a contiguous share of the elements over all slots.
+  auto result = slot(localSize_, chunk);
+  const int64_t numel = chunk.numel();
+  const int64_t share = (numel + localSize_ - 1) / localSize_;
+  const int64_t begin = std::min(numel, localRank_ * share);
+  const int64_t length = std::min(share, numel - begin);
+  if (length > 0) {
+    auto out = result.narrow(0, begin, length);
+    out.copy_(slot(0, chunk).narrow(0, begin, length));
+    for (int i = 1; i < localSize_; i++) {
+      out.add_(slot(i, chunk).narrow(0, begin, length));
+    }
+  }
+  barrier();
+
+  if (leaderFunc) {
+    if (localRank_ == 0) {
+      leaderFunc(result);
+    }
+    barrier();
+  }
+
+  // The next chunk only overwrites the result after its first barrier, which
+  // all local ranks reach after they have copied this one.
+  chunk.copy_(result);
+}
+
+} // namespace c10d
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <ATen/ATen.h>
+
+namespace c10d {
+
+// SharedMemoryReducer sums tensors across the processes of a group that run
+// on the same host through a POSIX shared memory segment, instead of sending
+// them through the network stack.
+//
+// The segment holds a barrier shared by all local processes, one slot per
+// local rank and a result region. Tensors larger than a slot are processed in
+// chunks. For every chunk, each local rank copies its data into its slot and
+// then sums its share of the elements over all slots into the result region.
+// The local leader (local rank 0) can then run an inter-host allreduce on the
+// result region, after which every local rank copies it back.
+//
+// The segment is created by the local leader and unlinked as soon as all
+// local ranks have mapped it, so it doesn't outlive the processes, even if
+// they are killed.
+//
+// All local ranks must call `allreduce` for the same tensors in the same
+// order. Calls within a process may come from different threads; they are
+// executed in the order of the sequence numbers returned by `nextSequence`.
+class SharedMemoryReducer {
+ public:
+  // Bytes per slot and therefore per chunk.
+  static constexpr size_t kSlotBytes = 4 * 1024 * 1024;
+
+  // Function run by the local leader on the locally reduced chunk.
+  using LeaderFunc = std::function<void(at::Tensor&)>;
+
+  // Creates the segment `name` if `localRank` is 0 and maps it otherwise.
+  // The caller must make sure the segment exists before it is mapped by the
+  // other local ranks.
+  SharedMemoryReducer(
+      const std::string& name,
+      int localRank,
+      int localSize,
+      std::chrono::milliseconds timeout);
+
+  ~SharedMemoryReducer();
+
+  SharedMemoryReducer(const SharedMemoryReducer&) = delete;
+  SharedMemoryReducer& operator=(const SharedMemoryReducer&) = delete;
+
+  // Waits until all local ranks have mapped the segment and unlinks it.
+  void connect();
+
+  // Returns the sequence number of the next call to `allreduce` in this
+  // process. Must be called in the same order on all local ranks.
+  uint64_t nextSequence();
+
+  // Sums the contiguous CPU tensor `tensor` in place over all local ranks.
+  // On the local leader, `leaderFunc` is called on every reduced chunk
+  // before it is copied back to the local ranks. It may be empty if there is
+  // nothing to do across hosts, but must be set on either all or none of the
+  // local ranks.
+  void allreduce(
+      uint64_t sequence,
+      at::Tensor& tensor,
+      const LeaderFunc& leaderFunc);
+
+  int getLocalRank() const {
+    return localRank_;
+  }
+
+  int getLocalSize() const {
+    return localSize_;
+  }
+
+ protected:
+  // Blocks until all local ranks have reached the barrier.
+  void barrier();
+
+  void allreduceChunk(at::Tensor& chunk, const LeaderFunc& leaderFunc);
+
+  at::Tensor slot(int localRank, const at::Tensor& chunk);
+
+  const std::string name_;
+  const int localRank_;
+  const int localSize_;
+  const std::chrono::milliseconds timeout_;
+
+  size_t size_;
+  void* data_;
+  bool unlinked_;
+
+  std::atomic<uint64_t> sequenceCounter_;
+  uint64_t nextToRun_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} // namespace c10d
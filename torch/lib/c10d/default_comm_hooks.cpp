@@ -1,11 +1,67 @@
 #include <c10d/default_comm_hooks.hpp>
 
+#include <cmath>
+
+#include <ATen/CPUGeneratorImpl.h>
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 #include <torch/torch.h>
 
 namespace c10d {
 
+namespace {
+
+// Runs `next` once `fut` has completed and returns a future that completes
+// with the result of the future returned by `next`. Errors of either future
+// are propagated. Unlike waiting on the second collective inside a `then`
+// callback, this does not block the thread that completes `fut`.
+c10::intrusive_ptr<c10::ivalue::Future> chainCollective(
+    const c10::intrusive_ptr<c10::ivalue::Future>& fut,
+    std::function<c10::intrusive_ptr<c10::ivalue::Future>()> next) {
+  auto result = c10::make_intrusive<c10::ivalue::Future>(fut->elementType());
+  fut->addCallback([fut, next = std::move(next), result]() {
+    if (fut->hasError()) {
+      result->setError(fut->exception_ptr());
+      return;
+    }
+    c10::intrusive_ptr<c10::ivalue::Future> nextFut;
+    try {
+      nextFut = next();
+    } catch (std::exception&) {
+      result->setError(std::current_exception());
+      return;
+    }
+    nextFut->addCallback([nextFut, result]() {
+      if (nextFut->hasError()) {
+        result->setError(nextFut->exception_ptr());
+      } else {
+        result->markCompleted(nextFut->value());
+      }
+    });
+  });
+  return result;
+}
+
+// Gram-Schmidt orthonormalization of the columns of `matrix`, in place.
+void orthogonalize(const at::Tensor& matrix, double epsilon = 1e-8) {
+  const int64_t numCols = matrix.size(1);
+  for (int64_t i = 0; i < numCols; ++i) {
+    auto col = matrix.narrow(1, i, 1);
+    // The epsilon avoids a division by zero for all-zero gradients.
+    col.div_(col.norm().add_(epsilon));
+    if (i + 1 < numCols) {
+      auto rest = matrix.narrow(1, i + 1, numCols - i - 1);
+      rest.sub_((col * rest).sum(0, /*keepdim=*/true) * col);
+    }
+  }
+}
+
+size_t numBytes(const at::Tensor& tensor) {
+  return tensor.numel() * tensor.element_size();
+}
+
+} // namespace
+
 c10::intrusive_ptr<c10::ivalue::Future> AllReduceCommHook::runHook(
     GradBucket& bucket) {
   auto allreduce_work = state_->allreduce(bucket.getTensorsRef());
@@ -38,4 +94,209 @@ c10::intrusive_ptr<c10::ivalue::Future> FP16CompressCommHook::runHook(
       decompress_and_div_by_process_group_size, fut->elementType());
 }
 
+PowerSGDCommHook::PowerSGDCommHook(
+    ProcessGroup* state,
+    int64_t matrixApproximationRank,
+    uint64_t seed)
+    : CppCommHookInterface<ProcessGroup*>(state),
+      matrixApproximationRank_(matrixApproximationRank),
+      generator_(at::make_generator<at::CPUGeneratorImpl>(seed)) {
+  TORCH_CHECK(
+      matrixApproximationRank_ > 0,
+      "PowerSGD matrix approximation rank must be positive, got ",
+      matrixApproximationRank_);
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> PowerSGDCommHook::runHook(
+    GradBucket& bucket) {
+  auto& tensors = bucket.getTensorsRef();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "PowerSGD communication hook expects a single tensor per bucket.");
+  auto input = tensors[0];
+  const auto worldSize = state_->getSize();
+  auto& bucketState = buckets_[bucket.getIndex()];
+
+  // Error feedback. The state is reset when the bucket is rebuilt.
+  if (bucketState.error.defined() &&
+      bucketState.error.numel() == input.numel()) {
+    input.add_(bucketState.error);
+  } else {
+    bucketState.error = at::zeros_like(input);
+  }
+  auto inputCopy = input.clone();
+
+  // Split the bucket into the gradients that are sent as is and the ones that
+  // are compressed. Without per-variable information the whole bucket is sent
+  // uncompressed.
+  std::vector<at::Tensor> vectors;
+  std::vector<at::Tensor> matrices;
+  std::vector<int64_t> ranks;
+  int64_t vectorLength = 0;
+  int64_t pLength = 0;
+  int64_t qLength = 0;
+  const auto& offsets = bucket.getOffsets();
+  const auto& lengths = bucket.getLengths();
+  const auto& sizes = bucket.getSizesVec();
+  if (offsets.empty()) {
+    vectors.push_back(input);
+    vectorLength = input.numel();
+  }
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    auto tensor = input.narrow(0, offsets[i], lengths[i]).view(sizes[i]);
+    if (tensor.dim() <= 1) {
+      vectors.push_back(tensor);
+      vectorLength += tensor.numel();
+      continue;
+    }
+    auto matrix = tensor.view({tensor.size(0), -1});
+    const int64_t n = matrix.size(0);
+    const int64_t m = matrix.size(1);
+    const int64_t r = std::min({n, m, matrixApproximationRank_});
+    matrices.push_back(matrix);
+    ranks.push_back(r);
+    pLength += n * r;
+    qLength += m * r;
+  }
+
+  // Warm start: Q of the previous iteration is reused unless the shapes have
+  // changed. The same generator state on every rank yields the same initial Q.
+  const bool initializeQ = !bucketState.q.defined() ||
+      bucketState.p.numel() != pLength || bucketState.q.numel() != qLength;
+  if (initializeQ) {
+    bucketState.p = at::empty({pLength}, input.options());
+    bucketState.q =
+        at::randn({qLength}, generator_, input.options().device(at::kCPU))
+            .to(input.device());
+  }
+  std::vector<at::Tensor> ps;
+  std::vector<at::Tensor> qs;
+  int64_t pOffset = 0;
+  int64_t qOffset = 0;
+  for (size_t i = 0; i < matrices.size(); ++i) {
+    const int64_t n = matrices[i].size(0);
+    const int64_t m = matrices[i].size(1);
+    ps.push_back(
+        bucketState.p.narrow(0, pOffset, n * ranks[i]).view({n, ranks[i]}));
+    qs.push_back(
+        bucketState.q.narrow(0, qOffset, m * ranks[i]).view({m, ranks[i]}));
+    pOffset += n * ranks[i];
+    qOffset += m * ranks[i];
+  }
+
+  // P = M Q, allreduced together with the uncompressed gradients.
+  for (size_t i = 0; i < matrices.size(); ++i) {
+    if (initializeQ) {
+      orthogonalize(qs[i]);
+    }
+    at::matmul_out(ps[i], matrices[i], qs[i]);
+  }
+  std::vector<at::Tensor> flat;
+  for (const auto& vector : vectors) {
+    flat.push_back(vector.reshape({-1}));
+  }
+  flat.push_back(bucketState.p);
+  std::vector<at::Tensor> first = {at::cat(flat)};
+  bytesCommunicated_ += numBytes(first[0]);
+
+  auto* bs = &bucketState;
+  auto qFut = chainCollective(
+      state_->allreduce(first)->getFuture(),
+      [this, first, vectors, vectorLength, pLength, matrices, ps, qs, bs,
+       worldSize]() mutable {
+        auto reduced = first[0];
+        int64_t offset = 0;
+        auto vectorsReduced = reduced.narrow(0, 0, vectorLength);
+        vectorsReduced.div_(worldSize);
+        for (auto& vector : vectors) {
+          vector.copy_(
+              vectorsReduced.narrow(0, offset, vector.numel()).view_as(vector));
+          offset += vector.numel();
+        }
+        bs->p.copy_(reduced.narrow(0, vectorLength, pLength));
+
+        // Q = M^T P with the orthonormalized P.
+        for (size_t i = 0; i < matrices.size(); ++i) {
+          orthogonalize(ps[i]);
+          at::matmul_out(qs[i], matrices[i].t(), ps[i]);
+        }
+        std::vector<at::Tensor> second = {bs->q};
+        if (bs->q.numel() == 0) {
+          auto done = c10::make_intrusive<c10::ivalue::Future>(
+              c10::ListType::ofTensors());
+          done->markCompleted(c10::IValue(second));
+          return done;
+        }
+        bytesCommunicated_ += numBytes(bs->q);
+        return state_->allreduce(second)->getFuture();
+      });
+
+  auto decompress = [input, inputCopy, matrices, ps, qs, bs, worldSize]() {
+    bs->q.div_(worldSize);
+    for (size_t i = 0; i < matrices.size(); ++i) {
+      matrices[i].copy_(at::matmul(ps[i], qs[i].t()));
+    }
+    at::sub_out(bs->error, inputCopy, input);
+    return c10::IValue(input);
+  };
+  return qFut->then(decompress, qFut->elementType());
+}
+
+TopKCommHook::TopKCommHook(ProcessGroup* state, double compressRatio)
+    : CppCommHookInterface<ProcessGroup*>(state),
+      compressRatio_(compressRatio) {
+  TORCH_CHECK(
+      compressRatio_ > 0 && compressRatio_ <= 1,
+      "Top-k compress ratio must be in (0, 1], got ",
+      compressRatio_);
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> TopKCommHook::runHook(
+    GradBucket& bucket) {
+  auto& tensors = bucket.getTensorsRef();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "Top-k communication hook expects a single tensor per bucket.");
+  auto input = tensors[0];
+  const auto worldSize = state_->getSize();
+  auto& error = errors_[bucket.getIndex()];
+  if (error.defined() && error.numel() == input.numel()) {
+    input.add_(error);
+  }
+
+  const int64_t numel = input.numel();
+  const int64_t k = std::min(
+      numel,
+      std::max<int64_t>(
+          1, static_cast<int64_t>(std::ceil(compressRatio_ * numel))));
+  auto indices = std::get<1>(input.abs().topk(k, 0, true, false));
+  std::vector<at::Tensor> values = {input.index_select(0, indices)};
+  std::vector<at::Tensor> localIndices = {indices};
+  error = input.index_fill(0, indices, 0);
+
+  std::vector<std::vector<at::Tensor>> gatheredValues(1);
+  std::vector<std::vector<at::Tensor>> gatheredIndices(1);
+  for (int i = 0; i < worldSize; ++i) {
+    gatheredValues[0].push_back(at::empty_like(values[0]));
+    gatheredIndices[0].push_back(at::empty_like(indices));
+  }
+  bytesCommunicated_ += numBytes(values[0]) + numBytes(indices);
+
+  // Both allgathers are in flight at the same time.
+  auto valuesFut = state_->allgather(gatheredValues, values)->getFuture();
+  auto indicesFut =
+      state_->allgather(gatheredIndices, localIndices)->getFuture();
+  auto fut = chainCollective(valuesFut, [indicesFut]() { return indicesFut; });
+
+  auto decompress = [input, gatheredValues, gatheredIndices, worldSize]() {
+    input.zero_();
+    for (int i = 0; i < worldSize; ++i) {
+      input.index_add_(0, gatheredIndices[0][i], gatheredValues[0][i]);
+    }
+    input.div_(worldSize);
+    return c10::IValue(input);
+  };
+  return fut->then(decompress, fut->elementType());
+}
+
 } // namespace c10d
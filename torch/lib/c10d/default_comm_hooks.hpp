@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <unordered_map>
+
+#include <ATen/core/Generator.h>
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 
@@ -8,6 +12,8 @@ namespace c10d {
 enum class BuiltinCommHookType {
   ALLREDUCE = 1,
   FP16_COMPRESS = 2,
+  POWER_SGD = 3,
+  TOP_K = 4,
 };
 
 class AllReduceCommHook : public CppCommHookInterface<ProcessGroup*> {
@@ -30,4 +36,75 @@ class FP16CompressCommHook : public CppCommHookInterface<ProcessGroup*> {
   c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
 };
 
+// Low-rank gradient compression with error feedback and warm start, see
+// PowerSGD (https://arxiv.org/abs/1905.13727) and powerSGD_hook in
+// torch/distributed/algorithms/ddp_comm_hooks.
+//
+// Every gradient M of a bucket that has more than one dimension is viewed as
+// an n x m matrix and approximated by P Q^T, where P is n x r and Q is m x r
+// with r = min(n, m, matrixApproximationRank). Only P and Q are allreduced,
+// the remaining 1-D gradients are allreduced uncompressed together with P.
+// The part of the gradient that is lost by the approximation is added back to
+// the gradient of the same bucket in the next iteration, and Q is reused as
+// the starting point of the next power iteration.
+//
+// Q is initialized from a generator seeded with `seed`, which has to be the
+// same on all ranks.
+class PowerSGDCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  explicit PowerSGDCommHook(
+      ProcessGroup* state,
+      int64_t matrixApproximationRank = 1,
+      uint64_t seed = 0);
+
+  ~PowerSGDCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+  // Returns the number of bytes this rank has passed to collectives so far.
+  size_t getBytesCommunicated() const {
+    return bytesCommunicated_;
+  }
+
+ private:
+  struct BucketState {
+    at::Tensor error;
+    at::Tensor p;
+    at::Tensor q;
+  };
+
+  const int64_t matrixApproximationRank_;
+  at::Generator generator_;
+  // Keyed by bucket index. Entries are only added by runHook, which the
+  // reducer calls from a single thread, and callbacks only touch the entry of
+  // their own bucket.
+  std::unordered_map<size_t, BucketState> buckets_;
+  std::atomic<size_t> bytesCommunicated_{0};
+};
+
+// Top-k gradient sparsification with error feedback. Every rank adds the
+// residual of the previous iteration to the bucket, then allgathers the
+// values and indices of its ceil(compressRatio * numel) largest entries by
+// magnitude. The bucket is replaced by the average of the sparse gradients of
+// all ranks, and the entries a rank did not send become its new residual.
+class TopKCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  explicit TopKCommHook(ProcessGroup* state, double compressRatio = 0.01);
+
+  ~TopKCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+  // Returns the number of bytes this rank has passed to collectives so far.
+  size_t getBytesCommunicated() const {
+    return bytesCommunicated_;
+  }
+
+ private:
+  const double compressRatio_;
+  // Residuals keyed by bucket index, see PowerSGDCommHook::buckets_.
+  std::unordered_map<size_t, at::Tensor> errors_;
+  std::atomic<size_t> bytesCommunicated_{0};
+};
+
 } // namespace c10d
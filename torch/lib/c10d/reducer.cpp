@@ -1,6 +1,8 @@
 #include <c10d/reducer.hpp>
 
 #include <functional>
+#include <limits>
+#include <numeric>
 
 #include <c10/core/DeviceGuard.h>
 #include <c10/core/StreamGuard.h>
@@ -24,6 +26,9 @@ inline int64_t current_time_in_nanos() {
 
 constexpr int kUnsetDivFactor = -1;
 
+// Smallest bucket size cap that dynamic bucketing considers.
+constexpr size_t kMinDynamicBucketBytes = 64 * 1024;
+
 } // namespace
 
 Reducer::Reducer(
@@ -47,6 +52,8 @@ Reducer::Reducer(
       backward_stats_base_(0),
       has_rebuilt_bucket_(false),
       bucket_bytes_cap_(bucket_bytes_cap),
+      dynamic_bucketing_interval_(0),
+      iterations_since_rebuild_(0),
       divFactor_(kUnsetDivFactor),
       comm_hook_(nullptr) {
   C10_LOG_API_USAGE_ONCE("torch.distributed.ddp.reducer");
@@ -722,6 +729,15 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
           bucket.replicas[0].sizes_vec);
       bucket.future_work = comm_hook_->runHook(grad_bucket);
     }
+    if (dynamic_bucketing_interval_ > 0 && has_rebuilt_bucket_ &&
+        !bucket.expect_sparse_gradient) {
+      bucket.comm_start_time = current_time_in_nanos();
+      auto fut = comm_hook_ == nullptr ? bucket.work->getFuture()
+                                       : bucket.future_work;
+      bucket.comm_end_time = fut->then(
+          []() { return c10::IValue(current_time_in_nanos()); },
+          c10::IntType::get());
+    }
   }
 }
 
@@ -996,6 +1012,37 @@ void Reducer::prepare_for_backward(
   has_marked_unused_parameters_ = false;
   unused_parameters_.clear();
 
+  // With gradient_as_bucket_view_, let undefined grads point to their zeroed
+  // bucket views before the backward pass. AccumulateGrad then accumulates
+  // into the bucket directly and mark_variable_ready_dense has nothing to
+  // copy, also in the first iteration and after the grads were set to None.
+  // The grads of globally unused parameters have to stay undefined, so this is
+  // skipped if there may be unused parameters. Under distributed autograd the
+  // grads live in the autograd context instead.
+  bool in_dist_autograd_context = false;
+#ifndef _WIN32
+  using torch::distributed::autograd::ThreadLocalDistAutogradContext;
+  in_dist_autograd_context =
+      ThreadLocalDistAutogradContext::getContextPtr() != nullptr;
+#endif
+  if (gradient_as_bucket_view_ && !find_unused_parameters_ &&
+      !in_dist_autograd_context) {
+    for (auto& bucket : buckets_) {
+      if (bucket.expect_sparse_gradient) {
+        continue;
+      }
+      for (auto& replica : bucket.replicas) {
+        for (size_t i = 0; i < replica.variables.size(); i++) {
+          auto& grad = replica.variables[i].mutable_grad();
+          if (!grad.defined()) {
+            grad = replica.bucket_views_in[i];
+            grad.zero_();
+          }
+        }
+      }
+    }
+  }
+
   // If find_unused_parameters_ is false, we assume that autograd hooks for ALL
   // variables will be called, and we don't have to search the autograd graph
   // for presence of these hooks.
@@ -1230,6 +1277,10 @@ void Reducer::finalize_backward() {
     }
   }
 
+  if (dynamic_bucketing_interval_ > 0 && has_rebuilt_bucket_) {
+    record_bucketing_stats();
+  }
+
   // See Note [Skip allreducing local_used_maps_dev]
   if (find_unused_parameters_) {
     // Reset unused parameter accounting.
@@ -1355,6 +1406,22 @@ bool Reducer::rebuild_buckets() {
   // exception below.
   ensure_prior_reduction_finished();
   std::lock_guard<std::mutex> lock(mutex_);
+  if (should_rebuild_buckets_dynamically()) {
+    auto rebuilt_bucket_indices = compute_bucket_assignment_from_stats();
+    // As below, every rank uses the assignment of rank 0.
+    sync_bucket_indices(rebuilt_bucket_indices);
+    reset_bucketing_stats();
+
+    bool changed = rebuilt_bucket_indices.size() != buckets_.size();
+    for (size_t i = 0; !changed && i < buckets_.size(); i++) {
+      changed = rebuilt_bucket_indices[i] != buckets_[i].variable_indices;
+    }
+    if (!changed) {
+      return false;
+    }
+    initialize_buckets(std::move(rebuilt_bucket_indices));
+    return true;
+  }
   if (!should_rebuild_buckets() || rebuilt_params_.empty()) {
     return false;
   }
@@ -1392,11 +1459,171 @@ bool Reducer::rebuild_buckets() {
   has_rebuilt_bucket_ = true;
   rebuilt_params_.clear();
   rebuilt_param_indices_.clear();
+  reset_bucketing_stats();
 
   initialize_buckets(std::move(rebuilt_bucket_indices));
   return true;
 }
 
+void Reducer::set_dynamic_bucketing_interval(int64_t interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      interval >= 0,
+      "Dynamic bucketing interval must be non-negative, got ",
+      interval);
+  TORCH_CHECK(
+      interval == 0 || !find_unused_parameters_,
+      "Dynamic bucketing does not support find_unused_parameters=True.");
+  TORCH_CHECK(
+      interval == 0 || replicas_.size() == 1,
+      "Dynamic bucketing does not support single-process multiple-device mode.");
+  dynamic_bucketing_interval_ = interval;
+  reset_bucketing_stats();
+}
+
+bool Reducer::should_rebuild_buckets_dynamically() const {
+  return dynamic_bucketing_interval_ > 0 && has_rebuilt_bucket_ &&
+      iterations_since_rebuild_ >= dynamic_bucketing_interval_;
+}
+
+void Reducer::record_bucketing_stats() {
+  for (size_t i = 0; i < ready_time_sums_.size(); i++) {
+    ready_time_sums_[i] += backward_stats_[0][i];
+  }
+  // Reductions are processed in bucket order, so a reduction that is kicked off
+  // before the previous one finished is only measured from then on.
+  int64_t previous_end = 0;
+  for (auto& bucket : buckets_) {
+    if (!bucket.comm_end_time) {
+      continue;
+    }
+    bucket.comm_end_time->wait();
+    const int64_t end = bucket.comm_end_time->value().toInt();
+    const int64_t start = std::max(bucket.comm_start_time, previous_end);
+    const auto& contents = bucket.replicas[0].contents;
+    comm_samples_.push_back(
+        {static_cast<size_t>(contents.numel() * contents.element_size()),
+         std::max<int64_t>(end - start, 0)});
+    previous_end = end;
+    bucket.comm_end_time.reset();
+  }
+  iterations_since_rebuild_++;
+}
+
+std::vector<std::vector<size_t>> Reducer::compute_bucket_assignment_from_stats() {
+  const auto& variables = replicas_[0];
+  const size_t variable_count = variables.size();
+  const int64_t iterations = std::max<int64_t>(iterations_since_rebuild_, 1);
+  std::vector<int64_t> ready_times(variable_count);
+  for (size_t i = 0; i < variable_count; i++) {
+    ready_times[i] = ready_time_sums_[i] / iterations;
+  }
+
+  // Variables in the order their gradients became ready on average.
+  std::vector<int64_t> order(variable_count);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return ready_times[a] < ready_times[b];
+  });
+  std::vector<at::Tensor> ordered_variables;
+  ordered_variables.reserve(variable_count);
+  for (const auto index : order) {
+    ordered_variables.push_back(variables[index]);
+  }
+
+  // Buckets of different dtypes or devices are not interleaved by
+  // compute_bucket_assignment_by_size, and reductions are kicked off in bucket
+  // order, so order the buckets by the time their last gradient is ready.
+  auto bucket_ready_time = [&](const std::vector<size_t>& bucket) {
+    int64_t ready = 0;
+    for (const auto index : bucket) {
+      ready = std::max(ready, ready_times[index]);
+    }
+    return ready;
+  };
+  auto assign = [&](size_t cap) {
+    auto bucket_indices = compute_bucket_assignment_by_size(
+        ordered_variables,
+        {std::min<size_t>(kDefaultFirstBucketBytes, cap), cap},
+        expect_sparse_gradients_[0],
+        order);
+    std::stable_sort(
+        bucket_indices.begin(),
+        bucket_indices.end(),
+        [&](const std::vector<size_t>& a, const std::vector<size_t>& b) {
+          return bucket_ready_time(a) < bucket_ready_time(b);
+        });
+    return bucket_indices;
+  };
+
+  // Fit duration = latency + bytes * nanos_per_byte to the measured
+  // reductions. Without at least two distinct bucket sizes the model is
+  // undetermined and only the order of the variables is updated.
+  double mean_bytes = 0;
+  double mean_nanos = 0;
+  for (const auto& sample : comm_samples_) {
+    mean_bytes += sample.bytes;
+    mean_nanos += sample.nanos;
+  }
+  double covariance = 0;
+  double variance = 0;
+  if (!comm_samples_.empty()) {
+    mean_bytes /= comm_samples_.size();
+    mean_nanos /= comm_samples_.size();
+    for (const auto& sample : comm_samples_) {
+      covariance += (sample.bytes - mean_bytes) * (sample.nanos - mean_nanos);
+      variance += (sample.bytes - mean_bytes) * (sample.bytes - mean_bytes);
+    }
+  }
+  if (variance <= 0 || covariance <= 0) {
+    return assign(bucket_bytes_cap_);
+  }
+  const double nanos_per_byte = covariance / variance;
+  const double latency =
+      std::max(0.0, mean_nanos - nanos_per_byte * mean_bytes);
+
+  // Simulates the reductions of an assignment, which start once their bucket
+  // is ready and the previous reduction has finished, and returns the time the
+  // last one finishes.
+  auto finish_time = [&](const std::vector<std::vector<size_t>>& buckets) {
+    double end = 0;
+    for (const auto& bucket : buckets) {
+      size_t bytes = 0;
+      for (const auto index : bucket) {
+        bytes += variables[index].numel() * variables[index].element_size();
+      }
+      end = std::max<double>(end, bucket_ready_time(bucket)) + latency +
+          nanos_per_byte * bytes;
+    }
+    return end;
+  };
+
+  // Try caps from 4x larger to 16x smaller than the configured one. Larger
+  // caps come first so that ties are broken in favor of fewer buckets.
+  std::vector<std::vector<size_t>> best_bucket_indices;
+  double best_finish_time = std::numeric_limits<double>::infinity();
+  for (int shift = 2; shift >= -4; shift--) {
+    const size_t cap = shift >= 0 ? bucket_bytes_cap_ << shift
+                                  : bucket_bytes_cap_ >> -shift;
+    if (shift != 0 && cap < kMinDynamicBucketBytes) {
+      continue;
+    }
+    auto bucket_indices = assign(cap);
+    const double time = finish_time(bucket_indices);
+    if (time < best_finish_time) {
+      best_finish_time = time;
+      best_bucket_indices = std::move(bucket_indices);
+    }
+  }
+  return best_bucket_indices;
+}
+
+void Reducer::reset_bucketing_stats() {
+  iterations_since_rebuild_ = 0;
+  ready_time_sums_.assign(replicas_[0].size(), 0);
+  comm_samples_.clear();
+}
+
 // See Note [DDP Communication Hook]
 void Reducer::register_comm_hook(std::unique_ptr<CommHookInterface> iface) {
   TORCH_CHECK(
@@ -1432,6 +1659,15 @@ void Reducer::register_builtin_comm_hook(
           std::make_unique<c10d::FP16CompressCommHook>(process_group_.get());
       LOG(INFO) << "Built-in communication hook FP16_COMPRESS is registered.";
       break;
+    case c10d::BuiltinCommHookType::POWER_SGD:
+      comm_hook_ =
+          std::make_unique<c10d::PowerSGDCommHook>(process_group_.get());
+      LOG(INFO) << "Built-in communication hook POWER_SGD is registered.";
+      break;
+    case c10d::BuiltinCommHookType::TOP_K:
+      comm_hook_ = std::make_unique<c10d::TopKCommHook>(process_group_.get());
+      LOG(INFO) << "Built-in communication hook TOP_K is registered.";
+      break;
     default:
       TORCH_WARN_ONCE(
           "Unknown built-in DDP comm hook type is provided. No comm hook will be used.");
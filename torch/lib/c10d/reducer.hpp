@@ -72,7 +72,9 @@ class Reducer {
   std::vector<std::vector<at::Tensor>> get_bucket_tensors() const;
 
   // Rebuild buckets based on rebuilt_params_ and rebuilt_param_indices_
-  // according to when tensors received grads in the backward pass.
+  // according to when tensors received grads in the backward pass, or based
+  // on the measurements described in set_dynamic_bucketing_interval when
+  // dynamic bucketing is enabled.
   // TODO this function makes broadcast communication call and
   // could be overlapped with next forward() call, thus
   // it could be async. Will make it async when rebuilding buckets for
@@ -94,6 +96,13 @@ class Reducer {
   // Pushes all parameters to be rebuilt.
   void push_rebuilt_params_for_all_indices();
 
+  // Enables re-assigning buckets every `interval` iterations after the first
+  // rebuild, based on the gradient ready times and allreduce durations
+  // measured since the previous assignment (0 disables it). Every rank must
+  // run the same number of synchronized backward passes, which rules out
+  // uneven inputs, and the process group must support Work::getFuture.
+  void set_dynamic_bucketing_interval(int64_t interval);
+
   // Creates and sets ForwardPassWorkHandle given a ProcessGroup::Work and the
   // corresponding tensor being reduced.
   void set_forward_pass_work_handle(
@@ -179,6 +188,23 @@ class Reducer {
 
   void finalize_backward();
 
+  // Returns true if dynamic bucketing is enabled and enough iterations have
+  // been measured since buckets were last assigned.
+  bool should_rebuild_buckets_dynamically() const;
+
+  // Accumulates the gradient ready times and allreduce durations of the
+  // backward pass that just finished, see set_dynamic_bucketing_interval.
+  void record_bucketing_stats();
+
+  // Computes a bucket assignment from the accumulated measurements. Variables
+  // are bucketed in their average ready order, with the bucket size cap for
+  // which a simple latency/bandwidth model of the measured allreduces
+  // predicts the earliest completion of the last bucket.
+  std::vector<std::vector<size_t>> compute_bucket_assignment_from_stats();
+
+  // Clears the measurements accumulated for dynamic bucketing.
+  void reset_bucketing_stats();
+
   // Asserts that the reduction for the previous iteration has finished before
   // rebuilding buckets or kicking off the next one.
   void ensure_prior_reduction_finished();
@@ -291,6 +317,11 @@ class Reducer {
     // If this bucket should expect a single sparse gradient.
     // Implies: replicas[i].variables.size() == 1.
     bool expect_sparse_gradient = false;
+
+    // When dynamic bucketing is enabled, the time the reduction was kicked off
+    // and a future that completes with the time it finished.
+    int64_t comm_start_time = 0;
+    c10::intrusive_ptr<torch::jit::Future> comm_end_time;
   };
 
   std::vector<Bucket> buckets_;
@@ -328,6 +359,22 @@ class Reducer {
   std::vector<int64_t> rebuilt_param_indices_;
   const int64_t bucket_bytes_cap_;
 
+  // Following variables are to help re-assign buckets dynamically, see
+  // set_dynamic_bucketing_interval.
+  int64_t dynamic_bucketing_interval_;
+  int64_t iterations_since_rebuild_;
+  // Sum of the ready times of every variable of replica 0 over the measured
+  // iterations.
+  std::vector<int64_t> ready_time_sums_;
+  // Size and duration of every measured allreduce of a dense bucket. The
+  // duration starts when the bucket was kicked off or the previous reduction
+  // finished, whichever is later.
+  struct CommSample {
+    size_t bytes;
+    int64_t nanos;
+  };
+  std::vector<CommSample> comm_samples_;
+
   struct RpcContext {
     using ContextPtr = torch::distributed::autograd::ContextPtr;
     // The shared_ptr is to hold the context instance.
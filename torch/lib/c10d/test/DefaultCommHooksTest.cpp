@@ -0,0 +1,212 @@
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+#include <ATen/CPUGeneratorImpl.h>
+#include <gtest/gtest.h>
+
+#include <c10d/FileStore.hpp>
+#include <c10d/ProcessGroupGloo.hpp>
+#include <c10d/default_comm_hooks.hpp>
+#include <c10d/test/TestUtils.hpp>
+
+using namespace c10d::test;
+
+constexpr int kWorldSize = 2;
+
+// Gradients of a bucket with two matrices and a bias, flattened into one
+// contents tensor the way the reducer lays them out.
+struct TestBucket {
+  at::Tensor contents;
+  std::vector<size_t> offsets;
+  std::vector<size_t> lengths;
+  std::vector<std::vector<int64_t>> sizes;
+
+  explicit TestBucket(std::vector<std::vector<int64_t>> variableSizes)
+      : sizes(std::move(variableSizes)) {
+    size_t offset = 0;
+    for (const auto& size : sizes) {
+      int64_t length = 1;
+      for (auto dim : size) {
+        length *= dim;
+      }
+      offsets.push_back(offset);
+      lengths.push_back(length);
+      offset += length;
+    }
+    contents = at::zeros({static_cast<int64_t>(offset)});
+  }
+
+  at::Tensor variable(size_t i) {
+    return contents.narrow(0, offsets[i], lengths[i]).view(sizes[i]);
+  }
+
+  c10d::GradBucket gradBucket() {
+    std::vector<c10::IntArrayRef> sizesVec(sizes.begin(), sizes.end());
+    return c10d::GradBucket(0, {contents}, offsets, lengths, sizesVec);
+  }
+};
+
+std::vector<std::vector<int64_t>> testSizes() {
+  return {{256, 512}, {512}, {32, 16, 3, 3}};
+}
+
+// Fills the gradients of `rank`. All matrices of all ranks share their column
+// space, so their average has rank one and PowerSGD with rank one recovers it
+// exactly.
+void fillGradients(TestBucket& bucket, int rank) {
+  auto shared = at::make_generator<at::CPUGeneratorImpl>(1);
+  auto local = at::make_generator<at::CPUGeneratorImpl>(100 + rank);
+  for (size_t i = 0; i < bucket.sizes.size(); ++i) {
+    auto variable = bucket.variable(i);
+    if (variable.dim() == 1) {
+      variable.copy_(at::randn(variable.sizes(), local));
+      continue;
+    }
+    auto matrix = variable.view({variable.size(0), -1});
+    auto u = at::randn({matrix.size(0), 1}, shared);
+    auto v = at::randn({1, matrix.size(1)}, local);
+    matrix.copy_(at::matmul(u, v));
+  }
+}
+
+at::Tensor expectedAverage() {
+  TestBucket bucket(testSizes());
+  auto sum = at::zeros_like(bucket.contents);
+  for (int rank = 0; rank < kWorldSize; ++rank) {
+    fillGradients(bucket, rank);
+    sum.add_(bucket.contents);
+  }
+  return sum / kWorldSize;
+}
+
+// Runs `fn` on kWorldSize processes on this host that are connected by a
+// Gloo process group. Rank 0 runs in the test process.
+void runMultiProcess(
+    const std::string& path,
+    const std::function<void(c10d::ProcessGroup&)>& fn) {
+  runInForkedProcesses(kWorldSize, [&](int rank) {
+    auto store = c10::make_intrusive<::c10d::FileStore>(path, kWorldSize);
+    ::c10d::ProcessGroupGloo::Options options;
+    options.timeout = std::chrono::milliseconds(10000);
+    options.devices.push_back(
+        ::c10d::ProcessGroupGloo::createDeviceForHostname("127.0.0.1"));
+    ::c10d::ProcessGroupGloo pg(store, rank, kWorldSize, options);
+    fn(pg);
+  });
+}
+
+TEST(DefaultCommHooksTest, testPowerSGDLowRank) {
+  if (isTSANEnabled()) {
+    LOG(INFO) << "Skipping test since Fork() + TSAN is broken";
+    return;
+  }
+  TemporaryFile file;
+  runMultiProcess(file.path, [&](c10d::ProcessGroup& pg) {
+    auto expected = expectedAverage();
+    c10d::PowerSGDCommHook hook(&pg);
+    TestBucket bucket(testSizes());
+    // The error feedback of one iteration only moves the local gradients
+    // within the shared column space, so every iteration is exact.
+    for (int iter = 0; iter < 3; ++iter) {
+      fillGradients(bucket, pg.getRank());
+      auto gradBucket = bucket.gradBucket();
+      auto fut = hook.runHook(gradBucket);
+      fut->wait();
+      ASSERT_FALSE(fut->hasError());
+      EXPECT_TRUE(at::allclose(bucket.contents, expected, 1e-3, 1e-4));
+    }
+    EXPECT_LT(
+        hook.getBytesCommunicated(),
+        3 * bucket.contents.numel() * bucket.contents.element_size());
+  });
+}
+
+TEST(DefaultCommHooksTest, testTopK) {
+  if (isTSANEnabled()) {
+    LOG(INFO) << "Skipping test since Fork() + TSAN is broken";
+    return;
+  }
+  TemporaryFile file;
+  runMultiProcess(file.path, [&](c10d::ProcessGroup& pg) {
+    auto expected = expectedAverage();
+    // Sending everything is an allreduce.
+    {
+      c10d::TopKCommHook hook(&pg, 1.0);
+      TestBucket bucket(testSizes());
+      fillGradients(bucket, pg.getRank());
+      auto gradBucket = bucket.gradBucket();
+      auto fut = hook.runHook(gradBucket);
+      fut->wait();
+      ASSERT_FALSE(fut->hasError());
+      EXPECT_TRUE(at::allclose(bucket.contents, expected, 1e-5, 1e-6));
+    }
+
+    // Each rank contributes at most k nonzero entries.
+    {
+      c10d::TopKCommHook hook(&pg, 0.01);
+      TestBucket bucket(testSizes());
+      const int64_t k = (bucket.contents.numel() + 99) / 100;
+      fillGradients(bucket, pg.getRank());
+      auto gradBucket = bucket.gradBucket();
+      auto fut = hook.runHook(gradBucket);
+      fut->wait();
+      ASSERT_FALSE(fut->hasError());
+      EXPECT_LE(bucket.contents.ne(0).sum().item<int64_t>(), kWorldSize * k);
+      EXPECT_GT(bucket.contents.ne(0).sum().item<int64_t>(), 0);
+    }
+  });
+}
+
+// Reports bytes passed to collectives and time per iteration of the
+// compression hooks against the uncompressed allreduce.
+TEST(DefaultCommHooksTest, testCompressionCost) {
+  if (isTSANEnabled()) {
+    LOG(INFO) << "Skipping test since Fork() + TSAN is broken";
+    return;
+  }
+  constexpr int kIterations = 20;
+  TemporaryFile file;
+  runMultiProcess(file.path, [&](c10d::ProcessGroup& pg) {
+    TestBucket bucket(testSizes());
+    const size_t allreduceBytes =
+        bucket.contents.numel() * bucket.contents.element_size();
+
+    auto timeHook = [&](c10d::CommHookInterface& hook) {
+      auto start = std::chrono::steady_clock::now();
+      for (int iter = 0; iter < kIterations; ++iter) {
+        fillGradients(bucket, pg.getRank());
+        auto gradBucket = bucket.gradBucket();
+        auto fut = hook.runHook(gradBucket);
+        fut->wait();
+        EXPECT_FALSE(fut->hasError());
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      return std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                 .count() /
+          kIterations;
+    };
+
+    c10d::AllReduceCommHook allreduce(&pg);
+    c10d::PowerSGDCommHook powerSGD(&pg);
+    c10d::TopKCommHook topK(&pg);
+    auto allreduceUs = timeHook(allreduce);
+    auto powerSGDUs = timeHook(powerSGD);
+    auto topKUs = timeHook(topK);
+    const size_t powerSGDBytes = powerSGD.getBytesCommunicated() / kIterations;
+    const size_t topKBytes = topK.getBytesCommunicated() / kIterations;
+
+    if (pg.getRank() == 0) {
+      std::cout << "allreduce: " << allreduceBytes << " bytes, " << allreduceUs
+                << " us/iter" << std::endl
+                << "powerSGD:  " << powerSGDBytes << " bytes, " << powerSGDUs
+                << " us/iter" << std::endl
+                << "topK:      " << topKBytes << " bytes, " << topKUs
+                << " us/iter" << std::endl;
+    }
+    EXPECT_LT(powerSGDBytes, allreduceBytes);
+    EXPECT_LT(topKBytes, allreduceBytes);
+  });
+}
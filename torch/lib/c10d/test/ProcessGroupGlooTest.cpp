@@ -96,6 +96,50 @@ c10::intrusive_ptr<::c10d::ProcessGroup::Work> testSignal(
   test.arm(fork.pid, signal);
   return test.run(0, 2);
 }
+
+// Runs allreduce with hierarchical allreduce enabled in one process per entry
+// of `hostnames`, where rank i claims to run on host `hostnames[i]`. Rank 0
+// runs in the test process.
+void testHierarchicalAllreduce(
+    const std::string& path,
+    const std::vector<std::string>& hostnames) {
+  const int size = hostnames.size();
+  runInForkedProcesses(size, [&](int rank) {
+    auto store = c10::make_intrusive<::c10d::FileStore>(path, size);
+    ::c10d::ProcessGroupGloo::Options options;
+    options.timeout = std::chrono::milliseconds(10000);
+    options.devices.push_back(
+        ::c10d::ProcessGroupGloo::createDeviceForHostname("127.0.0.1"));
+    options.hierarchicalAllreduce = true;
+    options.hostname = hostnames[rank];
+    ::c10d::ProcessGroupGloo pg(store, rank, size, options);
+
+    // Larger than a slot of the shared memory segment, so that it is reduced
+    // in several chunks.
+    const int64_t numel =
+        3 * ::c10d::SharedMemoryReducer::kSlotBytes / sizeof(float) + 7;
+    auto base = at::arange(numel, at::kFloat).fmod_(251);
+    std::vector<at::Tensor> large = {base + rank};
+    std::vector<at::Tensor> small = {at::full({5}, rank + 1, at::kDouble)};
+    std::vector<at::Tensor> max = {at::full({5}, rank, at::kFloat)};
+    ::c10d::AllreduceOptions maxOptions;
+    maxOptions.reduceOp = ::c10d::ReduceOp::MAX;
+
+    // Kick off work before waiting for any of it, so that the worker threads
+    // run it concurrently.
+    auto largeWork = pg.allreduce(large);
+    auto smallWork = pg.allreduce(small);
+    auto maxWork = pg.allreduce(max, maxOptions);
+    largeWork->wait();
+    smallWork->wait();
+    maxWork->wait();
+
+    EXPECT_TRUE(at::equal(large[0], base * size + size * (size - 1) / 2));
+    EXPECT_TRUE(
+        at::equal(small[0], at::full({5}, size * (size + 1) / 2, at::kDouble)));
+    EXPECT_TRUE(at::equal(max[0], at::full({5}, size - 1, at::kFloat)));
+  });
+}
 #endif
 
 class ProcessGroupGlooDelayed : public ::c10d::ProcessGroupGloo {
@@ -491,6 +535,26 @@ TEST(ProcessGroupGlooTest, testSIGKILLException) {
   EXPECT_FALSE(work->isSuccess());
   EXPECT_THROW(std::rethrow_exception(work->exception()), std::exception);
 }
+
+TEST(ProcessGroupGlooTest, testHierarchicalAllreduceSingleHost) {
+  if (isTSANEnabled()) {
+    LOG(INFO) << "Skipping test since Fork() + TSAN is broken";
+    return;
+  }
+  TemporaryFile file;
+  // An empty name uses the hostname of this machine.
+  testHierarchicalAllreduce(file.path, {"", "", ""});
+}
+
+TEST(ProcessGroupGlooTest, testHierarchicalAllreduceMultipleHosts) {
+  if (isTSANEnabled()) {
+    LOG(INFO) << "Skipping test since Fork() + TSAN is broken";
+    return;
+  }
+  TemporaryFile file;
+  testHierarchicalAllreduce(
+      file.path, {"host0", "host1", "host0", "host1", "host1", "host2"});
+}
 #endif
 
 TEST(ProcessGroupGlooTest, testAllReduceCPU) {
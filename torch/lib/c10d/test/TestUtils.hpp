@@ -10,11 +10,16 @@
 #include <cstring>
 
 #include <condition_variable>
+#include <exception>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <system_error>
 #include <vector>
 
+#include <ATen/Parallel.h>
+#include <gtest/gtest.h>
+
 namespace c10d {
 namespace test {
 
@@ -128,6 +133,46 @@ struct Fork {
     return pid == 0;
   }
 };
+
+// Runs `fn(rank)` for every rank in [0, size), each in a process forked from
+// this one. Rank 0 runs in the calling process. Failures of the other ranks
+// are reported through their exit code.
+//
+// With GNU OpenMP, a child forked after its parent ran a parallel region
+// can hang in its own parallel regions, so ATen ops run on a single thread.
+void runInForkedProcesses(int size, const std::function<void(int)>& fn) {
+  at::set_num_threads(1);
+  std::vector<pid_t> children;
+  int rank = 0;
+  for (int i = 1; i < size; i++) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      rank = i;
+      break;
+    }
+    children.push_back(pid);
+  }
+
+  bool failed = true;
+  try {
+    fn(rank);
+    failed = ::testing::Test::HasFailure();
+  } catch (const std::exception& e) {
+    ADD_FAILURE() << "Rank " << rank << ": " << e.what();
+  }
+
+  if (rank != 0) {
+    // Failures of EXPECT_* in a child are reported through its exit code.
+    _exit(failed ? 1 : 0);
+  }
+  for (auto pid : children) {
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        << "Child process failed";
+  }
+}
 #endif
 
 } // namespace test
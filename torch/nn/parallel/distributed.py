@@ -1096,7 +1096,11 @@ class DistributedDataParallel(Module):
 
         Args:
             comm_hook_type (dist.BuiltinCommHookType): type of communication hook, such as
-            ALLREDUCE, FP16_COMPRESS, etc.
+            ALLREDUCE, FP16_COMPRESS, etc. POWER_SGD compresses every gradient
+            with more than one dimension into a rank-1 approximation (PowerSGD),
+            and TOP_K only exchanges the 1% largest entries of each bucket by
+            magnitude. Both keep the compression error of a rank and add it to
+            its gradients in the next iteration.
 
         .. warning ::
             DDP communication hook can only be registered once and should be registered
@@ -1119,6 +1123,32 @@ class DistributedDataParallel(Module):
         """
         dist._register_builtin_comm_hook(self.reducer, comm_hook_type)
 
+    def _set_dynamic_bucketing(self, interval):
+        r"""
+        Re-assigns gradients to buckets every ``interval`` iterations, after
+        buckets were rebuilt in gradient ready order at the end of the first
+        iteration. The new assignment follows the average order in which
+        gradients became ready since the previous one, and uses the bucket size
+        for which the measured allreduce latency and bandwidth predict the most
+        overlap of communication with the backward pass. Rank 0 decides the
+        assignment for all ranks.
+
+        Args:
+            interval (int): number of iterations between re-assignments, 0
+            disables dynamic bucketing.
+
+        .. warning ::
+            Dynamic bucketing is experimental and subject to change. It does
+            not support ``find_unused_parameters=True``, single-process
+            multiple-device mode or uneven inputs, and requires a process group
+            that supports ``Work.get_future``, such as Gloo or NCCL.
+
+        Example::
+
+            >>> ddp._set_dynamic_bucketing(100)
+        """
+        self.reducer._set_dynamic_bucketing_interval(interval)
+
     def _distributed_broadcast_coalesced(
         self, tensors, buffer_size, authoritative_rank=0
     ):
@@ -27,6 +27,10 @@ class LLVMCodeGenCreated(ExecutionCounter):
     def __init__(self):
         super(LLVMCodeGenCreated, self).__init__("llvm_codegen_created")
 
+class LLVMCodeGenCacheHit(ExecutionCounter):
+    def __init__(self):
+        super(LLVMCodeGenCacheHit, self).__init__("llvm_codegen_cache_hit")
+
 class LLVMCodeGenExecuted(ExecutionCounter):
     def __init__(self):
         super(LLVMCodeGenExecuted, self).__init__("llvm_codegen_executed")